@@ -11,6 +11,7 @@ class fixed_search_strategy_template_processing_moduleRecipe(ConanFile):
     
     def requirements(self):
         self.requires("sc-machine/0.10.5")
+        self.requires("ps-common-lib/0.1.1")
 
     def build_requirements(self):
         self.test_requires("gtest/1.14.0")
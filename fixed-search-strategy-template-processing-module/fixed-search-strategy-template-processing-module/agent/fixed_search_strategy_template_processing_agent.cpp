@@ -1,5 +1,7 @@
 #include "fixed_search_strategy_template_processing_agent.hpp"
 
+#include <ps-common-lib/utils/macros.hpp>
+
 #include "keynodes/keynodes.hpp"
 
 #include "data/parameterized_template_builder.hpp"
@@ -20,6 +22,8 @@ ScAddr FixedSearchStrategyTemplateProcessingAgent::GetActionClass() const
 
 ScResult FixedSearchStrategyTemplateProcessingAgent::DoProgram(ScActionInitiatedEvent const & event, ScAction & action)
 {
+  TRACE_SPAN("FixedSearchStrategyTemplateProcessingAgent::DoProgram", "template_processing");
+
   auto [templateAddr, argumentsAddr] = action.GetArguments<2>();
   if (!templateAddr.IsValid())
   {
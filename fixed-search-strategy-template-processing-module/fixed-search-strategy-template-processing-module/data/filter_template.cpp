@@ -2,6 +2,8 @@
 
 #include <sc-memory/sc_agent_context.hpp>
 
+#include <ps-common-lib/utils/macros.hpp>
+
 FilterTemplate::FilterTemplate(ScAgentContext & context, utils::ScLogger & logger, ScAddr const & templateAddr)
   : SearchTemplate(context, logger, templateAddr)
 {
@@ -15,6 +17,8 @@ bool FilterTemplate::ApplyImpl(
     TemplateResults & results,
     std::list<FilterCallback> const & callbacks) const
 {
+  TRACE_SPAN("FilterTemplate::ApplyImpl", "template_processing");
+
   if (SearchTemplate::ApplyImpl(params, arguments, results, callbacks))
   {
     m_logger.Debug("Searching by filter template ", *this, " failed");
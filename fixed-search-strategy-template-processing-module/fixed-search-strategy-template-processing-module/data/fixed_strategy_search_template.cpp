@@ -3,6 +3,8 @@
 #include <sc-memory/sc_oriented_set.hpp>
 #include <sc-memory/sc_agent_context.hpp>
 
+#include <ps-common-lib/utils/macros.hpp>
+
 #include "keynodes/keynodes.hpp"
 
 #include "parameterized_template_builder.hpp"
@@ -46,6 +48,8 @@ bool FixedStrategySearchTemplate::ApplyImpl(
     TemplateResults & results,
     std::list<FilterCallback> const & callbacks) const
 {
+  TRACE_SPAN("FixedStrategySearchTemplate::ApplyImpl", "template_processing");
+
   results = TemplateResults{m_replyContext, m_logger, m_templateAddr, ScAddr::Empty, ScAddr::Empty, m_resultParamsAddr};
   bool status = true;
 
@@ -79,6 +83,8 @@ bool FixedStrategySearchTemplate::ProcessNextTemplates(
     TemplateResults & initTemplateResults,
     TemplateResults & results) const
 {
+  TRACE_SPAN("FixedStrategySearchTemplate::ProcessNextTemplates", "template_processing");
+
   m_logger.Debug("Process next template for init template ", m_initTemplateAddr);
 
   bool const isInitSearchSetTemplate =
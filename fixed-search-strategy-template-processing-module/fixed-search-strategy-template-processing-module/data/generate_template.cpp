@@ -2,6 +2,8 @@
 
 #include <sc-memory/sc_agent_context.hpp>
 
+#include <ps-common-lib/utils/macros.hpp>
+
 GenerateTemplate::GenerateTemplate(ScAgentContext & context, utils::ScLogger & logger, ScAddr const & templateAddr)
   : ParameterizedTemplate(context, logger, templateAddr)
 {
@@ -15,6 +17,8 @@ bool GenerateTemplate::ApplyImpl(
     TemplateResults & results,
     std::list<FilterCallback> const & callbacks) const
 {
+  TRACE_SPAN("GenerateTemplate::ApplyImpl", "template_processing");
+
   ScTemplateGenResult genResult;
   if (TryGenerateByTemplate(params, genResult))
   {
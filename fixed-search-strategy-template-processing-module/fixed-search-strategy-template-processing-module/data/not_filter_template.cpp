@@ -2,6 +2,8 @@
 
 #include <sc-memory/sc_agent_context.hpp>
 
+#include <ps-common-lib/utils/macros.hpp>
+
 NotFilterTemplate::NotFilterTemplate(ScAgentContext & context, utils::ScLogger & logger, ScAddr const & templateAddr)
   : NotSearchTemplate(context, logger, templateAddr)
 {
@@ -15,6 +17,8 @@ bool NotFilterTemplate::ApplyImpl(
     TemplateResults & results,
     std::list<FilterCallback> const & callbacks) const
 {
+  TRACE_SPAN("NotFilterTemplate::ApplyImpl", "template_processing");
+
   if (NotSearchTemplate::ApplyImpl(params, arguments, results, callbacks))
   {
     m_logger.Debug("Searching by not filter template ", m_templateAddr, " succeeded");
@@ -2,6 +2,8 @@
 
 #include <sc-memory/sc_agent_context.hpp>
 
+#include <ps-common-lib/utils/macros.hpp>
+
 NotSearchTemplate::NotSearchTemplate(ScAgentContext & context, utils::ScLogger & logger, ScAddr const & templateAddr)
   : SearchTemplate(context, logger, templateAddr)
 {
@@ -15,6 +17,8 @@ bool NotSearchTemplate::ApplyImpl(
     TemplateResults & results,
     std::list<FilterCallback> const & callbacks) const
 {
+  TRACE_SPAN("NotSearchTemplate::ApplyImpl", "template_processing");
+
   if (SearchTemplate::ApplyImpl(params, arguments, results, callbacks))
   {
     m_logger.Debug("Searching by not search template ", *this, " failed");
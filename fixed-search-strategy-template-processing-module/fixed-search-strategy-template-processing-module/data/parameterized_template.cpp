@@ -2,6 +2,8 @@
 
 #include <sc-memory/sc_agent_context.hpp>
 
+#include <ps-common-lib/utils/macros.hpp>
+
 #include "keynodes/keynodes.hpp"
 
 #include "template_arguments.hpp"
@@ -22,6 +24,8 @@ ParameterizedTemplate::~ParameterizedTemplate() = default;
 
 void ParameterizedTemplate::Load()
 {
+  TRACE_SPAN("ParameterizedTemplate::Load", "template_processing");
+
   ForEach(
       [&](ScAddr const &, ScAddr const & elementAddr, ScAddr const &, ScAddr const & roleAddr)
       {
@@ -88,6 +92,8 @@ void ParameterizedTemplate::Load()
 
 bool ParameterizedTemplate::Apply(TemplateArguments const & arguments, TemplateResults & results) const
 {
+  TRACE_SPAN("ParameterizedTemplate::Apply", "template_processing");
+
   std::list<FilterCallback> filterCallbacks;
   if (!m_filterTemplateAddrs.empty())
   {
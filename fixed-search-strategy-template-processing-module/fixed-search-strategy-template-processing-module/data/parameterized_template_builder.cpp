@@ -2,6 +2,8 @@
 
 #include <sc-memory/sc_agent_context.hpp>
 
+#include <ps-common-lib/utils/macros.hpp>
+
 #include "keynodes/keynodes.hpp"
 
 #include "search_template.hpp"
@@ -15,6 +17,8 @@ std::unique_ptr<ParameterizedTemplate> ParameterizedTemplateBuilder::BuildTempla
     utils::ScLogger & logger,
     ScAddr const & templateAddr)
 {
+  TRACE_SPAN("ParameterizedTemplateBuilder::BuildTemplate", "template_processing");
+
   if (!templateAddr.IsValid())
   {
     logger.Error("Template not found in parameterized template ", templateAddr);
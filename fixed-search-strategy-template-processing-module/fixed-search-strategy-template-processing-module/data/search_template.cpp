@@ -2,6 +2,8 @@
 
 #include <sc-memory/sc_agent_context.hpp>
 
+#include <ps-common-lib/utils/macros.hpp>
+
 SearchTemplate::SearchTemplate(ScAgentContext & context, utils::ScLogger & logger, ScAddr const & templateAddr)
   : ParameterizedTemplate(context, logger, templateAddr)
 {
@@ -15,6 +17,8 @@ bool SearchTemplate::ApplyImpl(
     TemplateResults & results,
     std::list<FilterCallback> const & callbacks) const
 {
+  TRACE_SPAN("SearchTemplate::ApplyImpl", "template_processing");
+
   if (results.IsValid())
   {
     results.m_templateAddr = m_templateAddr;
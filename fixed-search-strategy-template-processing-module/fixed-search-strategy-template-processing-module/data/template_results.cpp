@@ -5,6 +5,8 @@
 #include <sc-memory/sc_oriented_set.hpp>
 #include <sc-memory/sc_agent_context.hpp>
 
+#include <ps-common-lib/utils/macros.hpp>
+
 TemplateResult::TemplateResult() = default;
 
 TemplateResult::TemplateResult(
@@ -490,6 +492,8 @@ void TemplateResults::SortResultIndices(
     ScTemplateSearchResult const & searchResult,
     std::vector<size_t> & sortedResultItemIndices) const
 {
+  TRACE_SPAN("TemplateResults::SortResultIndices", "template_processing");
+
   static auto const IsNumber = [](std::string const & s) -> bool
   {
     if (s.empty())
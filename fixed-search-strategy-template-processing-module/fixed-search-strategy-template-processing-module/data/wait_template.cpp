@@ -5,6 +5,8 @@
 
 #include <sc-memory/sc_agent_context.hpp>
 
+#include <ps-common-lib/utils/macros.hpp>
+
 WaitTemplate::WaitTemplate(ScAgentContext & context, utils::ScLogger & logger, ScAddr const & templateAddr)
   : SearchTemplate(context, logger, templateAddr)
 {
@@ -18,6 +20,8 @@ bool WaitTemplate::ApplyImpl(
     TemplateResults & results,
     std::list<FilterCallback> const & callbacks) const
 {
+  TRACE_SPAN("WaitTemplate::ApplyImpl", "template_processing");
+
   size_t waitTimeMs = 0;
   if (m_replyContext.GetLinkContent(m_waitTimeMsAddr, waitTimeMs))
     m_logger.Debug("Wait time is ", waitTimeMs, " milliseconds");
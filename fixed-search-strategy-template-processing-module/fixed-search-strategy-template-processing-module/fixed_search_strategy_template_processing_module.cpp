@@ -1,5 +1,17 @@
 #include "fixed_search_strategy_template_processing_module.hpp"
 
+#include <ps-common-lib/utils/tracer.hpp>
+
 #include "agent/fixed_search_strategy_template_processing_agent.hpp"
 
 SC_MODULE_REGISTER(FixedSearchStrategyTemplateProcessingModule)->Agent<FixedSearchStrategyTemplateProcessingAgent>();
+
+void FixedSearchStrategyTemplateProcessingModule::Initialize(ScMemoryContext *)
+{
+  common::Tracer::Initialize();
+}
+
+void FixedSearchStrategyTemplateProcessingModule::Shutdown(ScMemoryContext *)
+{
+  common::Tracer::Shutdown();
+}
@@ -14,4 +14,15 @@
 class FixedSearchStrategyTemplateProcessingModule : public ScModule
 {
 public:
+  /*!
+   * @brief Enables tracing of template processing if the trace file is requested.
+   * @param context Memory context of the module.
+   */
+  void Initialize(ScMemoryContext * context) override;
+
+  /*!
+   * @brief Writes spans of template processing to the requested trace file.
+   * @param context Memory context of the module.
+   */
+  void Shutdown(ScMemoryContext * context) override;
 };
@@ -15,6 +15,7 @@ class non_atomic_action_interpreter_moduleRecipe(ConanFile):
 
     def build_requirements(self):
         self.test_requires("gtest/1.14.0")
+        self.test_requires("benchmark/1.9.1")
 
     def layout(self):
         cmake_layout(self)
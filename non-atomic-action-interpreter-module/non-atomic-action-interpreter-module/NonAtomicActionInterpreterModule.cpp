@@ -1,7 +1,44 @@
 #include "NonAtomicActionInterpreterModule.hpp"
 
+#include <ps-common-lib/utils/compiled_template_cache.hpp>
+#include <ps-common-lib/utils/logic_utils.hpp>
+#include <ps-common-lib/utils/template_params_utils.hpp>
+#include <ps-common-lib/utils/tracer.hpp>
+
 #include "agent/NonAtomicActionInterpreterAgent.hpp"
+#include "collector/InstanceCollector.hpp"
+#include "graph/TransitionGraphCache.hpp"
+#include "interpreter/ArgumentBindingPlanCache.hpp"
+#include "interpreter/AsyncNonAtomicActionInterpreter.hpp"
+#include "interpreter/InterpretationCheckpoint.hpp"
+#include "metrics/InterpretationMetrics.hpp"
+#include "scheduler/InterpretationScheduler.hpp"
 
 using namespace nonAtomicActionInterpreterModule;
 
 SC_MODULE_REGISTER(NonAtomicActionInterpreterModule)->Agent<NonAtomicActionInterpreterAgent>();
+
+// Interpretation of non-atomic actions with checkpoints is resumed after the restart of the machine.
+void NonAtomicActionInterpreterModule::Initialize(ScMemoryContext *)
+{
+  common::Tracer::Initialize();
+  InterpretationScheduler::initialize();
+  ScAgentContext context;
+  InterpretationCheckpoint::resumeInterrupted(&context);
+}
+
+void NonAtomicActionInterpreterModule::Shutdown(ScMemoryContext *)
+{
+  AsyncNonAtomicActionInterpreter::clear();
+  InstanceCollector::clear();
+  TransitionGraphCache::clear();
+  ArgumentBindingPlanCache::clear();
+  ScAgentContext context;
+  InterpretationScheduler::shutdown(&context);
+  InterpretationMetrics::exportToFiles();
+  InterpretationMetrics::clear();
+  common::LogicUtils::ClearFormulaPlans();
+  common::CompiledTemplateCache::Clear();
+  common::TemplateParamsUtils::ClearStructureVariables();
+  common::Tracer::Shutdown();
+}
@@ -6,6 +6,10 @@ namespace nonAtomicActionInterpreterModule
 {
 class NonAtomicActionInterpreterModule : public ScModule
 {
+public:
+  void Initialize(ScMemoryContext * context) override;
+
+  void Shutdown(ScMemoryContext * context) override;
 };
 
 }  // namespace nonAtomicActionInterpreterModule
@@ -1,143 +1,164 @@
 #include "NonAtomicActionInterpreterAgent.hpp"
 
-#include <sc-agents-common/utils/IteratorUtils.hpp>
 #include <ps-common-lib/action_cancelled_exception.hpp>
-#include <ps-common-lib/utils/template_params_utils.hpp>
 #include <ps-common-lib/utils/macros.hpp>
 
+#include "collector/InstanceCollector.hpp"
+#include "interpreter/AsyncNonAtomicActionInterpreter.hpp"
+#include "interpreter/InterpretationCheckpoint.hpp"
+#include "interpreter/NonAtomicActionInstantiator.hpp"
 #include "keynodes/NonAtomicKeynodes.hpp"
+#include "scheduler/InterpretationScheduler.hpp"
 
 using namespace nonAtomicActionInterpreterModule;
 
+// Agent interprets only admitted synchronous actions, because it has to return with its action finished. Queued action
+// stays initiated until the scheduler admits it, and asynchronous action is left to AsyncNonAtomicActionInterpreter,
+// which finishes it when its sub-actions finish.
+bool NonAtomicActionInterpreterAgent::CheckInitiationCondition(ScActionInitiatedEvent const & event)
+{
+  ScAction action = m_context.ConvertToAction(event.GetArcTargetElement());
+  if (!m_context.CheckConnector(GetActionClass(), action, ScType::ConstPermPosArc))
+    return false;
+
+  Admission const admission = InterpretationScheduler::admit(&m_context, action);
+  if (admission == Admission::Queued)
+    return false;
+  else if (admission == Admission::Rejected)
+  {
+    action.FinishUnsuccessfully();
+    return false;
+  }
+
+  if (m_context.CheckConnector(Keynodes::batch_interpreted_action, action, ScType::ConstPermPosArc))
+    return true;
+
+  if (m_context.CheckConnector(Keynodes::asynchronously_interpreted_action, action, ScType::ConstPermPosArc))
+  {
+    AsyncNonAtomicActionInterpreter::interpretAdmitted(&m_context, action);
+    return false;
+  }
+
+  return true;
+}
+
 ScResult NonAtomicActionInterpreterAgent::DoProgram(ScActionInitiatedEvent const & event, ScAction & action)
 {
-  START_TIMER();
+  TRACE_SPAN("NonAtomicActionInterpreterAgent::DoProgram", "interpreter");
+
+  if (m_context.CheckConnector(Keynodes::batch_interpreted_action, action, ScType::ConstPermPosArc))
+    return interpretBatch(action);
 
   ScAddr nonAtomicActionAddr;
   std::map<ScAddr, ScAddr, ScAddrLessFunc> replacements;
   ScAddr generalAction;
+  std::shared_ptr<LazyInstantiation> lazyInstantiation;
   try
   {
-    ScAddr const & nonAtomicActionTemplateAddr = action.GetArgument(1);
-
-    SC_CHECK_PARAM(nonAtomicActionTemplateAddr, "action params are not formed correctly.");
-
-    ScAddr const & argumentsSet = action.GetArgument(2);
-    replacements = createReplacements(nonAtomicActionTemplateAddr, argumentsSet);
-    validateVariableIdentifiers(replacements);
-
-    ScTemplateParams programTemplateParams =
-        common::TemplateParamsUtils::CreateTemplateParamsFromReplacements(replacements);
-    nonAtomicActionAddr = replaceNonAtomicAction(nonAtomicActionTemplateAddr, programTemplateParams);
-    generateNonAtomicActionTemplate(nonAtomicActionTemplateAddr, programTemplateParams);
-
-    generalAction = utils::IteratorUtils::getAnyByInRelation(&m_context, action, Keynodes::nrel_subaction);
+    NonAtomicActionInstantiator instantiator(&m_context);
+    nonAtomicActionAddr = instantiator.instantiate(action, replacements, lazyInstantiation);
+    generalAction = instantiator.getGeneralAction(action);
+    auto const deadline = instantiator.getDeadline(action, nonAtomicActionAddr);
+    ScAddr const & checkpoint = InterpretationCheckpoint::generate(&m_context, action, nonAtomicActionAddr, replacements);
 
     initFields();
-    nonAtomicActionInterpreter->interpret(nonAtomicActionAddr, replacements, generalAction);
+    nonAtomicActionInterpreter->interpret(
+        nonAtomicActionAddr, replacements, generalAction, deadline, lazyInstantiation, checkpoint);
   }
   catch (common::ActionCancelledException const & exception)
   {
     m_logger.Error(exception.Description());
     m_context.GenerateConnector(ScType::ConstPermPosArc, Keynodes::action_cancelled, action);
-    STOP_TIMER("NonAtomicActionInterpreterAgent");
-    return action.FinishUnsuccessfully();
+    return finish(action, false);
   }
   catch (utils::ScException & ex)
   {
     m_logger.Error(ex.Message());
-    STOP_TIMER("NonAtomicActionInterpreterAgent");
-    return action.FinishUnsuccessfully();
+    return finish(action, false);
   }
 
-  STOP_TIMER("NonAtomicActionInterpreterAgent");
-  return action.FinishSuccessfully();
+  return finish(action, true);
 }
 
-ScAddr NonAtomicActionInterpreterAgent::GetActionClass() const
+// Instances of a batch are interpreted synchronously by one interpreter. Each instance is marked as finished
+// successfully or unsuccessfully, and the batch action is successful only if all its instances are.
+ScResult NonAtomicActionInterpreterAgent::interpretBatch(ScAction & action)
 {
-  return Keynodes::action_interpret_non_atomic_action;
-}
-
-void NonAtomicActionInterpreterAgent::generateNonAtomicActionTemplate(
-    ScAddr const & nonAtomicActionTemplateAddr,
-    ScTemplateParams const & templateParams)
-{
-  ScTemplate nonAtomicActionTemplate;
-  m_context.BuildTemplate(nonAtomicActionTemplate, nonAtomicActionTemplateAddr);
-  ScTemplateGenResult templateGenResult;
-  m_context.GenerateByTemplate(nonAtomicActionTemplate, templateGenResult, templateParams);
-}
+  TRACE_SPAN("NonAtomicActionInterpreterAgent::interpretBatch", "interpreter");
 
-ScAddr NonAtomicActionInterpreterAgent::getTemplateKeyElement(ScAddr const & templateAddr)
-{
-  ScAddr templateKeyElement =
-      utils::IteratorUtils::getAnyByOutRelation(&m_context, templateAddr, ScKeynodes::rrel_key_sc_element);
-
-  if (!templateKeyElement.IsValid())
+  bool isSuccessful = true;
+  try
   {
-    SC_THROW_EXCEPTION(utils::ExceptionInvalidParams, "template key element not found.");
-  }
+    NonAtomicActionInstantiator instantiator(&m_context);
+    auto const & instances = instantiator.instantiateBatch(action);
+    ScAddr const & generalAction = instantiator.getGeneralAction(action);
 
-  return templateKeyElement;
-}
+    std::vector<std::unique_ptr<InterpretationFlow>> flows;
+    for (auto const & instance : instances)
+    {
+      ScAddr const & nonAtomicActionAddr = instance.instantiation->getNonAtomicAction();
+      flows.push_back(std::make_unique<InterpretationFlow>(
+          &m_context,
+          nonAtomicActionAddr,
+          instance.replacements,
+          generalAction,
+          instantiator.getDeadline(action, nonAtomicActionAddr),
+          instance.instantiation));
+    }
 
-std::map<ScAddr, ScAddr, ScAddrLessFunc> NonAtomicActionInterpreterAgent::createReplacements(
-    ScAddr const & nonAtomicActionTemplate,
-    ScAddr const & argumentsSet)
-{
-  std::map<ScAddr, ScAddr, ScAddrLessFunc> replacements;
-  if (argumentsSet.IsValid())
-  {
-    ScAddr templateKeyElement;
-    templateKeyElement = getTemplateKeyElement(nonAtomicActionTemplate);
-    for (int index = 1;; index++)
+    initFields();
+    auto const & errors = nonAtomicActionInterpreter->interpret(flows, generalAction);
+    for (size_t index = 0; index < instances.size(); index++)
     {
-      ScAddr role = utils::IteratorUtils::getRoleRelation(&m_context, index);
-      if (!role.IsValid())
-      {
-        break;
-      }
-      ScAddr argument = utils::IteratorUtils::getAnyByOutRelation(&m_context, argumentsSet, role);
-      if (!argument.IsValid())
+      bool isInstanceSuccessful = !errors[index];
+      if (!isInstanceSuccessful)
       {
-        break;
-      }
-      ScIterator5Ptr variablesIterator5 = m_context.CreateIterator5(
-          templateKeyElement, ScType::VarPermPosArc, ScType::VarNode, ScType::VarPermPosArc, role);
-      if (variablesIterator5->Next())
-      {
-        replacements[variablesIterator5->Get(2)] = argument;
+        try
+        {
+          std::rethrow_exception(errors[index]);
+        }
+        catch (utils::ScException const & exception)
+        {
+          m_logger.Error(exception.Message());
+        }
       }
+
+      ScAddr const & nonAtomicActionAddr = instances[index].instantiation->getNonAtomicAction();
+      m_context.GenerateConnector(
+          ScType::ConstPermPosArc,
+          isInstanceSuccessful ? ScKeynodes::action_finished_successfully : ScKeynodes::action_finished_unsuccessfully,
+          nonAtomicActionAddr);
+      m_context.GenerateConnector(ScType::ConstPermPosArc, ScKeynodes::action_finished, nonAtomicActionAddr);
+      isSuccessful = isSuccessful && isInstanceSuccessful;
     }
   }
+  catch (common::ActionCancelledException const & exception)
+  {
+    m_logger.Error(exception.Description());
+    m_context.GenerateConnector(ScType::ConstPermPosArc, Keynodes::action_cancelled, action);
+    return finish(action, false);
+  }
+  catch (utils::ScException & ex)
+  {
+    m_logger.Error(ex.Message());
+    return finish(action, false);
+  }
 
-  return replacements;
+  return finish(action, isSuccessful);
 }
 
-void NonAtomicActionInterpreterAgent::validateVariableIdentifiers(
-    std::map<ScAddr, ScAddr, ScAddrLessFunc> const & replacements)
+ScResult NonAtomicActionInterpreterAgent::finish(ScAction & action, bool isSuccessful)
 {
-  for (auto const & [varAddr, value] : replacements)
-  {
-    std::string identifier = m_context.GetElementSystemIdentifier(varAddr);
-    if (identifier.empty())
-    {
-      SC_THROW_EXCEPTION(utils::ExceptionInvalidParams, "all argument variables should have identifiers.");
-    }
-  }
+  ScResult result = isSuccessful ? action.FinishSuccessfully() : action.FinishUnsuccessfully();
+  InstanceCollector::release(action);
+  InterpretationCheckpoint::erase(&m_context, action);
+  InterpretationScheduler::release(&m_context, action);
+  return result;
 }
 
-ScAddr NonAtomicActionInterpreterAgent::replaceNonAtomicAction(
-    ScAddr const & templateAddr,
-    ScTemplateParams & templateParams)
+ScAddr NonAtomicActionInterpreterAgent::GetActionClass() const
 {
-  ScAddr keyElementReplacement = m_context.GenerateNode(ScType::ConstNode);
-  ScAddr templateKeyElement;
-  templateKeyElement = getTemplateKeyElement(templateAddr);
-  templateParams.Add(m_context.GetElementSystemIdentifier(templateKeyElement), keyElementReplacement);
-
-  return keyElementReplacement;
+  return Keynodes::action_interpret_non_atomic_action;
 }
 
 void NonAtomicActionInterpreterAgent::initFields()
@@ -11,24 +11,16 @@ class NonAtomicActionInterpreterAgent : public ScActionInitiatedAgent
 public:
   ScAddr GetActionClass() const override;
 
+  bool CheckInitiationCondition(ScActionInitiatedEvent const & event) override;
+
   ScResult DoProgram(ScActionInitiatedEvent const & event, ScAction & action) override;
 
 private:
   std::unique_ptr<NonAtomicActionInterpreter> nonAtomicActionInterpreter;
 
-  void generateNonAtomicActionTemplate(
-      ScAddr const & nonAtomicActionTemplateAddr,
-      ScTemplateParams const & templateParams);
-
-  std::map<ScAddr, ScAddr, ScAddrLessFunc> createReplacements(
-      ScAddr const & nonAtomicActionTemplate,
-      ScAddr const & argumentsSet);
-
-  void validateVariableIdentifiers(std::map<ScAddr, ScAddr, ScAddrLessFunc> const & replacements);
-
-  ScAddr getTemplateKeyElement(ScAddr const & templateAddr);
+  ScResult interpretBatch(ScAction & action);
 
-  ScAddr replaceNonAtomicAction(ScAddr const & templateAddr, ScTemplateParams & templateParams);
+  ScResult finish(ScAction & action, bool isSuccessful);
 
   void initFields();
 };
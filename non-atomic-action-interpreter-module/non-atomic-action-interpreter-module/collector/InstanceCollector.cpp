@@ -0,0 +1,239 @@
+#include "InstanceCollector.hpp"
+
+#include <algorithm>
+#include <list>
+#include <sstream>
+
+#include <sc-agents-common/utils/IteratorUtils.hpp>
+
+#include <ps-common-lib/utils/macros.hpp>
+
+#include "constants/NonAtomicActionInterpreterConstants.hpp"
+#include "keynodes/NonAtomicKeynodes.hpp"
+
+using namespace nonAtomicActionInterpreterModule;
+
+void InstanceCollector::track(
+    ScAddr const & action,
+    ScAddr const & nonAtomicActionAddr,
+    ScAddrVector const & generatedElements,
+    std::shared_ptr<LazyInstantiation> const & lazyInstantiation,
+    std::chrono::milliseconds const & retentionTime)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  instances.insert({action, {nonAtomicActionAddr, generatedElements, lazyInstantiation, retentionTime}});
+  if (collector.joinable())
+    return;
+
+  collectorContext = std::make_unique<ScAgentContext>();
+  collector = std::thread(&InstanceCollector::collectInstances);
+}
+
+// Retention time is counted from the end of the interpretation, so the results of the non-atomic action can be
+// consumed before its instance is erased. Batch interpretation action has several instances.
+void InstanceCollector::release(ScAddr const & action)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto const & [begin, end] = instances.equal_range(action);
+    if (begin == end)
+      return;
+
+    for (auto it = begin; it != end; ++it)
+      it->second.collectionTime = std::chrono::steady_clock::now() + it->second.retentionTime;
+  }
+  instancesChanged.notify_all();
+}
+
+void InstanceCollector::clear()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    isStopped = true;
+  }
+  instancesChanged.notify_all();
+  if (collector.joinable())
+    collector.join();
+
+  std::lock_guard<std::mutex> lock(mutex);
+  instances.clear();
+  collectorContext.reset();
+  isStopped = false;
+}
+
+void InstanceCollector::collectInstances()
+{
+  TRACE_SPAN("InstanceCollector::collectInstances", "interpreter");
+
+  std::unique_lock<std::mutex> lock(mutex);
+  while (!isStopped)
+  {
+    auto const now = std::chrono::steady_clock::now();
+    auto nearestCollectionTime = std::chrono::steady_clock::time_point::max();
+    std::list<std::pair<ScAddr, Instance>> expiredInstances;
+    for (auto it = instances.begin(); it != instances.end();)
+    {
+      if (it->second.collectionTime <= now)
+      {
+        expiredInstances.emplace_back(it->first, std::move(it->second));
+        it = instances.erase(it);
+      }
+      else
+      {
+        nearestCollectionTime = std::min(nearestCollectionTime, it->second.collectionTime);
+        ++it;
+      }
+    }
+
+    if (!expiredInstances.empty())
+    {
+      lock.unlock();
+      std::list<std::pair<ScAddr, Instance>> deferredInstances;
+      for (auto & [action, instance] : expiredInstances)
+      {
+        try
+        {
+          ScAddr const & decompositionTuple = utils::IteratorUtils::getAnyByOutRelation(
+              collectorContext.get(), instance.nonAtomicAction, Keynodes::nrel_decomposition_of_action);
+          if (hasRunningSubActions(*collectorContext, decompositionTuple))
+          {
+            instance.collectionTime = std::chrono::steady_clock::now()
+                                      + std::chrono::milliseconds(
+                                          NonAtomicActionInterpreterConstants::INSTANCE_COLLECTION_RECHECK_TIME);
+            deferredInstances.emplace_back(action, std::move(instance));
+            continue;
+          }
+
+          collect(*collectorContext, action, instance);
+        }
+        catch (utils::ScException const & exception)
+        {
+          SC_LOG_ERROR(exception.Message());
+        }
+      }
+      lock.lock();
+      for (auto & [action, instance] : deferredInstances)
+        instances.insert({action, std::move(instance)});
+      continue;
+    }
+
+    if (nearestCollectionTime == std::chrono::steady_clock::time_point::max())
+      instancesChanged.wait(lock);
+    else
+      instancesChanged.wait_until(lock, nearestCollectionTime);
+  }
+}
+
+void InstanceCollector::collect(ScAgentContext & context, ScAddr const & action, Instance const & instance)
+{
+  TRACE_SPAN("InstanceCollector::collect", "interpreter");
+
+  SC_LOG_DEBUG("NonAtomicActionInterpreter: collecting finished non-atomic action instance.");
+  ScAddr const & decompositionTuple = utils::IteratorUtils::getAnyByOutRelation(
+      &context, instance.nonAtomicAction, Keynodes::nrel_decomposition_of_action);
+  if (context.CheckConnector(Keynodes::action_with_execution_summary, action, ScType::ConstPermPosArc))
+    generateSummary(context, action, decompositionTuple);
+
+  ScAddrVector generatedElements = instance.generatedElements;
+  if (instance.lazyInstantiation)
+  {
+    ScAddrVector const & lazilyGeneratedElements = instance.lazyInstantiation->getGeneratedElements();
+    generatedElements.insert(generatedElements.end(), lazilyGeneratedElements.cbegin(), lazilyGeneratedElements.cend());
+  }
+  eraseElements(context, getElementsToErase(context, generatedElements));
+}
+
+// Sub-action that is still performed, e.g. when the interpretation failed or was cancelled before it finished, may
+// use the elements of the instance, so the instance is collected only after all its initiated sub-actions finish.
+bool InstanceCollector::hasRunningSubActions(ScAgentContext & context, ScAddr const & decompositionTuple)
+{
+  if (!decompositionTuple.IsValid())
+    return false;
+
+  ScIterator3Ptr subActionsIterator3 =
+      context.CreateIterator3(decompositionTuple, ScType::ConstPermPosArc, ScType::ConstNode);
+  while (subActionsIterator3->Next())
+  {
+    ScAddr const & subAction = subActionsIterator3->Get(2);
+    if (context.CheckConnector(ScKeynodes::action_initiated, subAction, ScType::ConstPermPosArc)
+        && !context.CheckConnector(ScKeynodes::action_finished, subAction, ScType::ConstPermPosArc))
+      return true;
+  }
+  return false;
+}
+
+void InstanceCollector::generateSummary(
+    ScAgentContext & context,
+    ScAddr const & action,
+    ScAddr const & decompositionTuple)
+{
+  size_t subActionsCount = 0;
+  size_t successfulSubActionsCount = 0;
+  size_t unsuccessfulSubActionsCount = 0;
+  ScIterator3Ptr subActionsIterator3 =
+      context.CreateIterator3(decompositionTuple, ScType::ConstPermPosArc, ScType::ConstNode);
+  while (subActionsIterator3->Next())
+  {
+    ScAddr const & subAction = subActionsIterator3->Get(2);
+    subActionsCount++;
+    if (context.CheckConnector(ScKeynodes::action_finished_successfully, subAction, ScType::ConstPermPosArc))
+      successfulSubActionsCount++;
+    else if (context.CheckConnector(ScKeynodes::action_finished_unsuccessfully, subAction, ScType::ConstPermPosArc))
+      unsuccessfulSubActionsCount++;
+  }
+
+  std::stringstream summary;
+  summary << "sub-actions: " << subActionsCount << ", successful: " << successfulSubActionsCount
+          << ", unsuccessful: " << unsuccessfulSubActionsCount;
+
+  ScAddr const & summaryLink = context.GenerateLink(ScType::ConstNodeLink);
+  context.SetLinkContent(summaryLink, summary.str());
+  ScAddr const & summaryArc = context.GenerateConnector(ScType::ConstCommonArc, action, summaryLink);
+  context.GenerateConnector(ScType::ConstPermPosArc, Keynodes::nrel_execution_summary, summaryArc);
+}
+
+// Connectors incident to generated elements are erased together with them, so only generated nodes and connectors
+// between other elements are erased explicitly. It keeps addresses of the erased elements from being reused before
+// they are erased.
+ScAddrVector InstanceCollector::getElementsToErase(ScAgentContext & context, ScAddrVector const & generatedElements)
+{
+  ScAddrUnorderedSet const generatedElementsSet(generatedElements.cbegin(), generatedElements.cend());
+  ScAddrVector elementsToErase;
+  for (auto const & element : generatedElementsSet)
+  {
+    if (!context.IsElement(element))
+      continue;
+
+    if (!context.GetElementType(element).IsConnector())
+    {
+      elementsToErase.push_back(element);
+      continue;
+    }
+
+    auto const [source, target] = context.GetConnectorIncidentElements(element);
+    if (!generatedElementsSet.count(source) && !generatedElementsSet.count(target))
+      elementsToErase.push_back(element);
+  }
+
+  std::stable_partition(
+      elementsToErase.begin(),
+      elementsToErase.end(),
+      [&context](ScAddr const & element)
+      {
+        return context.GetElementType(element).IsConnector();
+      });
+  return elementsToErase;
+}
+
+void InstanceCollector::eraseElements(ScAgentContext & context, ScAddrVector const & elements)
+{
+  size_t const batchSize = NonAtomicActionInterpreterConstants::INSTANCE_COLLECTION_BATCH_SIZE;
+  for (size_t batchBegin = 0; batchBegin < elements.size(); batchBegin += batchSize)
+  {
+    size_t const batchEnd = std::min(elements.size(), batchBegin + batchSize);
+    context.BeginEventsPending();
+    for (size_t index = batchBegin; index < batchEnd; index++)
+      context.EraseElement(elements[index]);
+    context.EndEventsPending();
+  }
+}
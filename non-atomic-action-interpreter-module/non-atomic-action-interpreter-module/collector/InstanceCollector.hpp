@@ -0,0 +1,60 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include <sc-memory/sc_agent_context.hpp>
+
+#include "interpreter/LazyInstantiation.hpp"
+
+namespace nonAtomicActionInterpreterModule
+{
+class InstanceCollector
+{
+public:
+  static void track(
+      ScAddr const & action,
+      ScAddr const & nonAtomicActionAddr,
+      ScAddrVector const & generatedElements,
+      std::shared_ptr<LazyInstantiation> const & lazyInstantiation,
+      std::chrono::milliseconds const & retentionTime);
+
+  static void release(ScAddr const & action);
+
+  static void clear();
+
+private:
+  struct Instance
+  {
+    ScAddr nonAtomicAction;
+    ScAddrVector generatedElements;
+    std::shared_ptr<LazyInstantiation> lazyInstantiation;
+    std::chrono::milliseconds retentionTime;
+    std::chrono::steady_clock::time_point collectionTime = std::chrono::steady_clock::time_point::max();
+  };
+
+  static inline std::mutex mutex;
+  static inline std::condition_variable instancesChanged;
+  static inline std::unordered_multimap<ScAddr, Instance, ScAddrHashFunc> instances;
+  static inline std::unique_ptr<ScAgentContext> collectorContext;
+  static inline std::thread collector;
+  static inline bool isStopped = false;
+
+  static void collectInstances();
+
+  static void collect(ScAgentContext & context, ScAddr const & action, Instance const & instance);
+
+  static bool hasRunningSubActions(ScAgentContext & context, ScAddr const & decompositionTuple);
+
+  static void generateSummary(ScAgentContext & context, ScAddr const & action, ScAddr const & decompositionTuple);
+
+  static ScAddrVector getElementsToErase(ScAgentContext & context, ScAddrVector const & generatedElements);
+
+  static void eraseElements(ScAgentContext & context, ScAddrVector const & elements);
+};
+
+}  // namespace nonAtomicActionInterpreterModule
@@ -3,4 +3,22 @@
 namespace nonAtomicActionInterpreterModule
 {
 int const NonAtomicActionInterpreterConstants::INTERPRETER_ACTION_WAIT_TIME = 15000;
+
+size_t const NonAtomicActionInterpreterConstants::TRANSITION_GRAPH_CACHE_CAPACITY = 256;
+
+size_t const NonAtomicActionInterpreterConstants::ARGUMENT_BINDING_PLAN_CACHE_CAPACITY = 256;
+
+size_t const NonAtomicActionInterpreterConstants::INSTANCE_COLLECTION_BATCH_SIZE = 1000;
+
+int const NonAtomicActionInterpreterConstants::INSTANCE_COLLECTION_RECHECK_TIME = 1000;
+
+size_t const NonAtomicActionInterpreterConstants::MAX_QUEUED_INTERPRETATIONS = 10000;
+
+size_t const NonAtomicActionInterpreterConstants::DEFAULT_RETRY_MAX_ATTEMPTS = 3;
+
+size_t const NonAtomicActionInterpreterConstants::DEFAULT_RETRY_INITIAL_BACKOFF = 100;
+
+size_t const NonAtomicActionInterpreterConstants::DEFAULT_RETRY_BACKOFF_MULTIPLIER = 2;
+
+size_t const NonAtomicActionInterpreterConstants::MAX_RETRY_BACKOFF = 10000;
 }  // namespace nonAtomicActionInterpreterModule
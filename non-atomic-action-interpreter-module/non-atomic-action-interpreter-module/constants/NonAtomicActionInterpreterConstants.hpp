@@ -1,11 +1,31 @@
 #pragma once
 
+#include <cstddef>
+
 namespace nonAtomicActionInterpreterModule
 {
 class NonAtomicActionInterpreterConstants
 {
 public:
   static int const INTERPRETER_ACTION_WAIT_TIME;
+
+  static size_t const TRANSITION_GRAPH_CACHE_CAPACITY;
+
+  static size_t const ARGUMENT_BINDING_PLAN_CACHE_CAPACITY;
+
+  static size_t const INSTANCE_COLLECTION_BATCH_SIZE;
+
+  static int const INSTANCE_COLLECTION_RECHECK_TIME;
+
+  static size_t const MAX_QUEUED_INTERPRETATIONS;
+
+  static size_t const DEFAULT_RETRY_MAX_ATTEMPTS;
+
+  static size_t const DEFAULT_RETRY_INITIAL_BACKOFF;
+
+  static size_t const DEFAULT_RETRY_BACKOFF_MULTIPLIER;
+
+  static size_t const MAX_RETRY_BACKOFF;
 };
 
 }  // namespace nonAtomicActionInterpreterModule
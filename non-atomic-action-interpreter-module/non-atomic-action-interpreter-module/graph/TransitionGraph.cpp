@@ -0,0 +1,55 @@
+#include "TransitionGraph.hpp"
+
+#include <limits>
+
+using namespace nonAtomicActionInterpreterModule;
+
+size_t const TransitionGraph::NO_NODE = std::numeric_limits<size_t>::max();
+
+TransitionGraph::TransitionGraph(ScAddr const & decompositionTuple)
+  : decompositionTuple(decompositionTuple)
+  , firstNode(NO_NODE)
+{
+}
+
+ScAddr const & TransitionGraph::getDecompositionTuple() const
+{
+  return decompositionTuple;
+}
+
+size_t TransitionGraph::getFirstNode() const
+{
+  return firstNode;
+}
+
+TransitionGraph::Node const & TransitionGraph::getNode(size_t index) const
+{
+  return nodes[index];
+}
+
+size_t TransitionGraph::findNode(ScAddr const & action) const
+{
+  auto const & it = nodeIndices.find(action);
+  return it == nodeIndices.cend() ? NO_NODE : it->second;
+}
+
+std::vector<TransitionGraph::Transition> const & TransitionGraph::getTransitions(size_t index, ActionResult result)
+    const
+{
+  return nodes[index].transitions[static_cast<size_t>(result)];
+}
+
+std::vector<TransitionGraph::Node> const & TransitionGraph::getNodes() const
+{
+  return nodes;
+}
+
+std::unordered_set<ScAddr, ScAddrHashFunc> const & TransitionGraph::getTransitionArcs() const
+{
+  return transitionArcs;
+}
+
+bool TransitionGraph::hasTransitionArc(ScAddr const & arc) const
+{
+  return transitionArcs.count(arc);
+}
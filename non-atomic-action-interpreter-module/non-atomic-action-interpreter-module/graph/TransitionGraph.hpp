@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <sc-memory/sc_addr.hpp>
+
+namespace nonAtomicActionInterpreterModule
+{
+enum class ActionResult : size_t
+{
+  Successful = 0,
+  Unsuccessful = 1,
+  Unknown = 2
+};
+
+class TransitionGraph
+{
+public:
+  static size_t const NO_NODE;
+
+  struct Transition
+  {
+    ScAddr arc;
+    ScAddr target;
+    size_t targetNode;
+    ScAddr condition;
+  };
+
+  struct Node
+  {
+    ScAddr action;
+    std::array<std::vector<Transition>, 3> transitions;
+    std::vector<Transition> forks;
+    ScAddr join;
+    ScAddr joinArc;
+    size_t joinNode = NO_NODE;
+  };
+
+  explicit TransitionGraph(ScAddr const & decompositionTuple);
+
+  ScAddr const & getDecompositionTuple() const;
+
+  size_t getFirstNode() const;
+
+  Node const & getNode(size_t index) const;
+
+  size_t findNode(ScAddr const & action) const;
+
+  std::vector<Transition> const & getTransitions(size_t index, ActionResult result) const;
+
+  std::vector<Node> const & getNodes() const;
+
+  std::unordered_set<ScAddr, ScAddrHashFunc> const & getTransitionArcs() const;
+
+  bool hasTransitionArc(ScAddr const & arc) const;
+
+private:
+  friend class TransitionGraphBuilder;
+
+  ScAddr decompositionTuple;
+  size_t firstNode;
+  std::vector<Node> nodes;
+  std::unordered_map<ScAddr, size_t, ScAddrHashFunc> nodeIndices;
+  std::unordered_set<ScAddr, ScAddrHashFunc> transitionArcs;
+};
+
+}  // namespace nonAtomicActionInterpreterModule
@@ -0,0 +1,194 @@
+#include "TransitionGraphBuilder.hpp"
+
+#include <algorithm>
+
+#include <ps-common-lib/utils/macros.hpp>
+
+#include "keynodes/NonAtomicKeynodes.hpp"
+
+using namespace nonAtomicActionInterpreterModule;
+
+TransitionGraphBuilder::TransitionGraphBuilder(ScMemoryContext * context)
+  : context(context)
+  , membershipArcType(ScType::ConstPermPosArc)
+  , commonArcType(ScType::ConstCommonArc)
+  , nodeType(ScType::ConstNode)
+{
+}
+
+std::shared_ptr<TransitionGraph const> TransitionGraphBuilder::build(ScAddr const & decompositionTuple)
+{
+  TRACE_SPAN("TransitionGraphBuilder::build", "interpreter");
+
+  setElementTypes(decompositionTuple);
+  auto graph = std::make_shared<TransitionGraph>(decompositionTuple);
+
+  ScIterator3Ptr actionsIterator = context->CreateIterator3(decompositionTuple, membershipArcType, ScType::Unknown);
+  while (actionsIterator->Next())
+  {
+    ScAddr const & action = actionsIterator->Get(2);
+    if (graph->nodeIndices.count(action))
+      continue;
+
+    graph->nodeIndices[action] = graph->nodes.size();
+    graph->nodes.push_back({action});
+  }
+
+  ScAddr firstAction = getAnyByOutRelation(decompositionTuple, ScKeynodes::rrel_1);
+  graph->firstNode = graph->findNode(firstAction);
+
+  for (auto & node : graph->nodes)
+  {
+    for (ActionResult result : {ActionResult::Successful, ActionResult::Unsuccessful, ActionResult::Unknown})
+    {
+      auto & transitions = node.transitions[static_cast<size_t>(result)];
+      for (auto const & transitionArc : getOrderedTransitionCandidates(node.action, result))
+      {
+        ScAddr const & target = context->GetArcTargetElement(transitionArc);
+        ScAddr const & condition = getAnyByOutRelation(transitionArc, Keynodes::nrel_condition);
+        transitions.push_back({transitionArc, target, graph->findNode(target), condition});
+        graph->transitionArcs.insert(transitionArc);
+      }
+    }
+
+    buildForks(*graph, node);
+  }
+
+  return graph;
+}
+
+// Lazily instantiated non-atomic actions are interpreted by the graph of their template, which is formed by variable
+// elements.
+void TransitionGraphBuilder::setElementTypes(ScAddr const & decompositionTuple)
+{
+  bool const isTemplate = context->GetElementType(decompositionTuple).IsVar();
+  membershipArcType = isTemplate ? ScType::VarPermPosArc : ScType::ConstPermPosArc;
+  commonArcType = isTemplate ? ScType::VarCommonArc : ScType::ConstCommonArc;
+  nodeType = isTemplate ? ScType::VarNode : ScType::ConstNode;
+}
+
+void TransitionGraphBuilder::buildForks(TransitionGraph & graph, TransitionGraph::Node & node)
+{
+  for (auto const & forkArc : getAllArcsByOutRelation(node.action, Keynodes::nrel_fork))
+  {
+    ScAddr const & target = context->GetArcTargetElement(forkArc);
+    ScAddr const & condition = getAnyByOutRelation(forkArc, Keynodes::nrel_condition);
+    node.forks.push_back({forkArc, target, graph.findNode(target), condition});
+    graph.transitionArcs.insert(forkArc);
+  }
+
+  ScIterator5Ptr joinIterator5 = getIteratorByOutRelation(node.action, Keynodes::nrel_join);
+  if (joinIterator5->Next())
+  {
+    node.join = joinIterator5->Get(2);
+    node.joinArc = joinIterator5->Get(1);
+    node.joinNode = graph.findNode(node.join);
+    graph.transitionArcs.insert(node.joinArc);
+  }
+}
+
+ScAddrList TransitionGraphBuilder::getOrderedTransitionCandidates(ScAddr const & actionAddr, ActionResult result)
+{
+  bool const actionIsSuccessful = result == ActionResult::Successful;
+  bool const actionIsUnsuccessful = result == ActionResult::Unsuccessful;
+
+  ScAddrList orderedTransitionCandidates =
+      getOrderedTransitionCandidatesFromSequence(actionAddr, actionIsSuccessful, actionIsUnsuccessful);
+
+  updateTransitionCandidatesWithTheCandidatesNotFromSequence(
+      orderedTransitionCandidates, actionAddr, actionIsSuccessful, actionIsUnsuccessful);
+
+  return orderedTransitionCandidates;
+}
+
+ScAddrList TransitionGraphBuilder::getOrderedTransitionCandidatesFromSequence(
+    ScAddr const & actionAddr,
+    bool const & actionIsSuccessful,
+    bool const & actionIsUnsuccessful)
+{
+  ScAddrList orderedTransitionCandidates;
+
+  ScAddr transitionArc = getPriorityTransitionArc(actionAddr);
+  while (transitionArc.IsValid())
+  {
+    bool const successCaseTransitionPossibility =
+        actionIsSuccessful && context->CheckConnector(Keynodes::nrel_then, transitionArc, membershipArcType);
+    bool const unsuccessCaseTransitionPossibility =
+        actionIsUnsuccessful && context->CheckConnector(Keynodes::nrel_else, transitionArc, membershipArcType);
+    bool const unconditionalTransitionPossibility =
+        context->CheckConnector(Keynodes::nrel_goto, transitionArc, membershipArcType);
+
+    if (successCaseTransitionPossibility || unsuccessCaseTransitionPossibility || unconditionalTransitionPossibility)
+      orderedTransitionCandidates.push_back(transitionArc);
+
+    transitionArc = getAnyByOutRelation(transitionArc, Keynodes::nrel_basic_sequence);
+  }
+
+  return orderedTransitionCandidates;
+}
+
+void TransitionGraphBuilder::updateTransitionCandidatesWithTheCandidatesNotFromSequence(
+    ScAddrList & orderedTransitionCandidates,
+    ScAddr const & actionAddr,
+    bool const & actionIsSuccessful,
+    bool const & actionIsUnsuccessful)
+{
+  if (actionIsSuccessful)
+  {
+    updateTransitionsByRelation(actionAddr, Keynodes::nrel_then, orderedTransitionCandidates);
+  }
+  else if (actionIsUnsuccessful)
+  {
+    updateTransitionsByRelation(actionAddr, Keynodes::nrel_else, orderedTransitionCandidates);
+  }
+
+  updateTransitionsByRelation(actionAddr, Keynodes::nrel_goto, orderedTransitionCandidates);
+}
+
+void TransitionGraphBuilder::updateTransitionsByRelation(
+    ScAddr const & action,
+    ScAddr const & relation,
+    ScAddrList & transitions)
+{
+  ScAddrList transitionArcs = getAllArcsByOutRelation(action, relation);
+  for (auto const & arc : transitionArcs)
+  {
+    if (std::find(transitions.begin(), transitions.end(), arc) == transitions.end())
+      transitions.push_back(arc);
+  }
+}
+
+ScAddr TransitionGraphBuilder::getPriorityTransitionArc(ScAddr const & node)
+{
+  ScAddr arcAddr;
+
+  ScIterator5Ptr priorityArcIterator =
+      context->CreateIterator5(node, commonArcType, nodeType, membershipArcType, Keynodes::nrel_priority_path);
+  if (priorityArcIterator->Next())
+  {
+    arcAddr = priorityArcIterator->Get(1);
+  }
+  return arcAddr;
+}
+
+ScAddrList TransitionGraphBuilder::getAllArcsByOutRelation(ScAddr const & node, ScAddr const & relation)
+{
+  ScAddrList arcs;
+  ScIterator5Ptr iterator5 = getIteratorByOutRelation(node, relation);
+  while (iterator5->Next())
+  {
+    arcs.push_back(iterator5->Get(1));
+  }
+  return arcs;
+}
+
+ScIterator5Ptr TransitionGraphBuilder::getIteratorByOutRelation(ScAddr const & node, ScAddr const & relation)
+{
+  return context->CreateIterator5(node, ScType::Unknown, ScType::Unknown, membershipArcType, relation);
+}
+
+ScAddr TransitionGraphBuilder::getAnyByOutRelation(ScAddr const & node, ScAddr const & relation)
+{
+  ScIterator5Ptr iterator5 = getIteratorByOutRelation(node, relation);
+  return iterator5->Next() ? iterator5->Get(2) : ScAddr::Empty;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <memory>
+
+#include <sc-memory/sc_memory.hpp>
+
+#include "TransitionGraph.hpp"
+
+namespace nonAtomicActionInterpreterModule
+{
+class TransitionGraphBuilder
+{
+public:
+  explicit TransitionGraphBuilder(ScMemoryContext * context);
+
+  std::shared_ptr<TransitionGraph const> build(ScAddr const & decompositionTuple);
+
+private:
+  ScMemoryContext * context;
+  ScType membershipArcType;
+  ScType commonArcType;
+  ScType nodeType;
+
+  void setElementTypes(ScAddr const & decompositionTuple);
+
+  void buildForks(TransitionGraph & graph, TransitionGraph::Node & node);
+
+  ScAddrList getOrderedTransitionCandidates(ScAddr const & actionAddr, ActionResult result);
+
+  ScAddrList getOrderedTransitionCandidatesFromSequence(
+      ScAddr const & actionAddr,
+      bool const & actionIsSuccessful,
+      bool const & actionIsUnsuccessful);
+
+  void updateTransitionCandidatesWithTheCandidatesNotFromSequence(
+      ScAddrList & orderedTransitionCandidates,
+      ScAddr const & actionAddr,
+      bool const & actionIsSuccessful,
+      bool const & actionIsUnsuccessful);
+
+  void updateTransitionsByRelation(ScAddr const & action, ScAddr const & relation, ScAddrList & transitions);
+
+  ScAddr getPriorityTransitionArc(ScAddr const & node);
+
+  ScAddrList getAllArcsByOutRelation(ScAddr const & node, ScAddr const & relation);
+
+  ScIterator5Ptr getIteratorByOutRelation(ScAddr const & node, ScAddr const & relation);
+
+  ScAddr getAnyByOutRelation(ScAddr const & node, ScAddr const & relation);
+};
+
+}  // namespace nonAtomicActionInterpreterModule
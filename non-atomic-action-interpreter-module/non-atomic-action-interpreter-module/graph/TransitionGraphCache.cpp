@@ -0,0 +1,102 @@
+#include "TransitionGraphCache.hpp"
+
+#include "TransitionGraphBuilder.hpp"
+
+#include "constants/NonAtomicActionInterpreterConstants.hpp"
+
+using namespace nonAtomicActionInterpreterModule;
+
+// Transitions are subscribed after the graph is built, because the subscribed elements are found by the graph.
+std::shared_ptr<TransitionGraph const> TransitionGraphCache::get(
+    ScAgentContext * context,
+    ScAddr const & decompositionTuple)
+{
+  return getCache().Get(
+      decompositionTuple,
+      [context, &decompositionTuple](
+          ScAgentContext * eventsContext,
+          std::shared_ptr<std::atomic_bool> const & isStale,
+          std::list<std::shared_ptr<ScEventSubscription>> & subscriptions)
+      {
+        TransitionGraphBuilder builder(context);
+        std::shared_ptr<TransitionGraph const> graph = builder.build(decompositionTuple);
+        subscriptions = context->GetElementType(decompositionTuple).IsVar()
+                            ? subscribe<ScType::VarPermPosArc, ScType::VarCommonArc>(eventsContext, graph, isStale)
+                            : subscribe<ScType::ConstPermPosArc, ScType::ConstCommonArc>(eventsContext, graph, isStale);
+        return graph;
+      });
+}
+
+void TransitionGraphCache::invalidate(ScAddr const & decompositionTuple)
+{
+  getCache().Invalidate(decompositionTuple);
+}
+
+void TransitionGraphCache::clear()
+{
+  getCache().Clear();
+}
+
+common::EventInvalidatedCache<TransitionGraph const> & TransitionGraphCache::getCache()
+{
+  static common::EventInvalidatedCache<TransitionGraph const> cache(
+      NonAtomicActionInterpreterConstants::TRANSITION_GRAPH_CACHE_CAPACITY);
+  return cache;
+}
+
+template <ScType const & membershipArcType, ScType const & commonArcType>
+std::list<std::shared_ptr<ScEventSubscription>> TransitionGraphCache::subscribe(
+    ScAgentContext * context,
+    std::shared_ptr<TransitionGraph const> const & graph,
+    std::shared_ptr<std::atomic_bool> const & isStale)
+{
+  using TupleChangedEvent = ScEventAfterGenerateOutgoingArc<membershipArcType>;
+  using TupleReducedEvent = ScEventBeforeEraseOutgoingArc<membershipArcType>;
+  using TransitionAddedEvent = ScEventAfterGenerateOutgoingArc<commonArcType>;
+  using TransitionErasedEvent = ScEventBeforeEraseOutgoingArc<commonArcType>;
+  using TransitionRelationAddedEvent = ScEventAfterGenerateIncomingArc<membershipArcType>;
+  using TransitionRelationErasedEvent = ScEventBeforeEraseIncomingArc<membershipArcType>;
+
+  std::list<std::shared_ptr<ScEventSubscription>> subscriptions;
+  auto const & markStale = [isStale](auto const &)
+  {
+    *isStale = true;
+  };
+
+  ScAddr const & decompositionTuple = graph->getDecompositionTuple();
+  subscriptions.push_back(context->CreateElementaryEventSubscription<TupleChangedEvent>(decompositionTuple, markStale));
+  subscriptions.push_back(context->CreateElementaryEventSubscription<TupleReducedEvent>(decompositionTuple, markStale));
+  subscriptions.push_back(
+      context->CreateElementaryEventSubscription<ScEventBeforeEraseElement>(decompositionTuple, markStale));
+
+  for (auto const & node : graph->getNodes())
+  {
+    subscriptions.push_back(context->CreateElementaryEventSubscription<TransitionAddedEvent>(
+        node.action,
+        [graph, isStale](TransitionAddedEvent const & event)
+        {
+          if (graph->findNode(event.GetArcTargetElement()) != TransitionGraph::NO_NODE)
+            *isStale = true;
+        }));
+    subscriptions.push_back(context->CreateElementaryEventSubscription<TransitionErasedEvent>(
+        node.action,
+        [graph, isStale](TransitionErasedEvent const & event)
+        {
+          if (graph->hasTransitionArc(event.GetArc()))
+            *isStale = true;
+        }));
+  }
+
+  for (auto const & transitionArc : graph->getTransitionArcs())
+  {
+    subscriptions.push_back(
+        context->CreateElementaryEventSubscription<TransitionRelationAddedEvent>(transitionArc, markStale));
+    subscriptions.push_back(
+        context->CreateElementaryEventSubscription<TransitionRelationErasedEvent>(transitionArc, markStale));
+    subscriptions.push_back(context->CreateElementaryEventSubscription<TransitionAddedEvent>(transitionArc, markStale));
+    subscriptions.push_back(
+        context->CreateElementaryEventSubscription<TransitionErasedEvent>(transitionArc, markStale));
+  }
+
+  return subscriptions;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <ps-common-lib/utils/event_invalidated_cache.hpp>
+
+#include "TransitionGraph.hpp"
+
+namespace nonAtomicActionInterpreterModule
+{
+class TransitionGraphCache
+{
+public:
+  static std::shared_ptr<TransitionGraph const> get(ScAgentContext * context, ScAddr const & decompositionTuple);
+
+  static void invalidate(ScAddr const & decompositionTuple);
+
+  static void clear();
+
+private:
+  static common::EventInvalidatedCache<TransitionGraph const> & getCache();
+
+  template <ScType const & membershipArcType, ScType const & commonArcType>
+  static std::list<std::shared_ptr<ScEventSubscription>> subscribe(
+      ScAgentContext * context,
+      std::shared_ptr<TransitionGraph const> const & graph,
+      std::shared_ptr<std::atomic_bool> const & isStale);
+};
+
+}  // namespace nonAtomicActionInterpreterModule
@@ -0,0 +1,105 @@
+#include "ArgumentBindingPlanCache.hpp"
+
+#include <sc-agents-common/utils/IteratorUtils.hpp>
+
+#include <ps-common-lib/utils/macros.hpp>
+
+#include "constants/NonAtomicActionInterpreterConstants.hpp"
+
+using namespace nonAtomicActionInterpreterModule;
+
+std::shared_ptr<ArgumentBindingPlanCache::Plan const> ArgumentBindingPlanCache::get(
+    ScAgentContext * context,
+    ScAddr const & templateKeyElement)
+{
+  return getCache().Get(
+      templateKeyElement,
+      [context, &templateKeyElement](
+          ScAgentContext * eventsContext,
+          std::shared_ptr<std::atomic_bool> const & isStale,
+          std::list<std::shared_ptr<ScEventSubscription>> & subscriptions)
+      {
+        subscriptions = subscribe(eventsContext, templateKeyElement, isStale);
+        return build(context, templateKeyElement);
+      });
+}
+
+void ArgumentBindingPlanCache::clear()
+{
+  getCache().Clear();
+}
+
+common::EventInvalidatedCache<ArgumentBindingPlanCache::Plan const> & ArgumentBindingPlanCache::getCache()
+{
+  static common::EventInvalidatedCache<Plan const> cache(
+      NonAtomicActionInterpreterConstants::ARGUMENT_BINDING_PLAN_CACHE_CAPACITY);
+  return cache;
+}
+
+// Role-labelled variables of the key element are found by one scan, then they are ordered by the indexes of their
+// roles. Roles without variables are kept in the plan, because the binding stops at the first missing argument.
+std::shared_ptr<ArgumentBindingPlanCache::Plan const> ArgumentBindingPlanCache::build(
+    ScAgentContext * context,
+    ScAddr const & templateKeyElement)
+{
+  TRACE_SPAN("ArgumentBindingPlanCache::build", "interpreter");
+
+  std::unordered_map<ScAddr, ScAddr, ScAddrHashFunc> variablesByRoles;
+  ScIterator5Ptr variablesIterator5 = context->CreateIterator5(
+      templateKeyElement, ScType::VarPermPosArc, ScType::VarNode, ScType::VarPermPosArc, ScType::ConstNodeRole);
+  while (variablesIterator5->Next())
+    variablesByRoles.emplace(variablesIterator5->Get(4), variablesIterator5->Get(2));
+
+  auto plan = std::make_shared<Plan>();
+  for (int index = 1; !variablesByRoles.empty(); index++)
+  {
+    ScAddr const & role = utils::IteratorUtils::getRoleRelation(context, index);
+    if (!role.IsValid())
+      break;
+
+    auto const & it = variablesByRoles.find(role);
+    if (it == variablesByRoles.cend())
+      plan->emplace_back(role, ScAddr::Empty);
+    else
+    {
+      plan->emplace_back(role, it->second);
+      variablesByRoles.erase(it);
+    }
+  }
+  return plan;
+}
+
+std::list<std::shared_ptr<ScEventSubscription>> ArgumentBindingPlanCache::subscribe(
+    ScAgentContext * context,
+    ScAddr const & templateKeyElement,
+    std::shared_ptr<std::atomic_bool> const & isStale)
+{
+  using ArgumentAddedEvent = ScEventAfterGenerateOutgoingArc<ScType::VarPermPosArc>;
+  using ArgumentErasedEvent = ScEventBeforeEraseOutgoingArc<ScType::VarPermPosArc>;
+  using RoleAddedEvent = ScEventAfterGenerateIncomingArc<ScType::VarPermPosArc>;
+  using RoleErasedEvent = ScEventBeforeEraseIncomingArc<ScType::VarPermPosArc>;
+
+  std::list<std::shared_ptr<ScEventSubscription>> subscriptions;
+  auto const & markStale = [isStale](auto const &)
+  {
+    *isStale = true;
+  };
+
+  subscriptions.push_back(
+      context->CreateElementaryEventSubscription<ArgumentAddedEvent>(templateKeyElement, markStale));
+  subscriptions.push_back(
+      context->CreateElementaryEventSubscription<ArgumentErasedEvent>(templateKeyElement, markStale));
+  subscriptions.push_back(
+      context->CreateElementaryEventSubscription<ScEventBeforeEraseElement>(templateKeyElement, markStale));
+
+  ScIterator3Ptr argumentsIterator3 =
+      context->CreateIterator3(templateKeyElement, ScType::VarPermPosArc, ScType::VarNode);
+  while (argumentsIterator3->Next())
+  {
+    ScAddr const & argumentArc = argumentsIterator3->Get(1);
+    subscriptions.push_back(context->CreateElementaryEventSubscription<RoleAddedEvent>(argumentArc, markStale));
+    subscriptions.push_back(context->CreateElementaryEventSubscription<RoleErasedEvent>(argumentArc, markStale));
+  }
+
+  return subscriptions;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <ps-common-lib/utils/event_invalidated_cache.hpp>
+
+namespace nonAtomicActionInterpreterModule
+{
+class ArgumentBindingPlanCache
+{
+public:
+  // Roles in the order of their indexes and the template variables labelled by them, variable is empty if the role
+  // has no variable.
+  using Plan = std::vector<std::pair<ScAddr, ScAddr>>;
+
+  static std::shared_ptr<Plan const> get(ScAgentContext * context, ScAddr const & templateKeyElement);
+
+  static void clear();
+
+private:
+  static common::EventInvalidatedCache<Plan const> & getCache();
+
+  static std::shared_ptr<Plan const> build(ScAgentContext * context, ScAddr const & templateKeyElement);
+
+  static std::list<std::shared_ptr<ScEventSubscription>> subscribe(
+      ScAgentContext * context,
+      ScAddr const & templateKeyElement,
+      std::shared_ptr<std::atomic_bool> const & isStale);
+};
+
+}  // namespace nonAtomicActionInterpreterModule
@@ -0,0 +1,462 @@
+#include "AsyncNonAtomicActionInterpreter.hpp"
+
+#include <algorithm>
+
+#include <ps-common-lib/action_cancelled_exception.hpp>
+#include <ps-common-lib/utils/macros.hpp>
+
+#include "InterpretationCheckpoint.hpp"
+#include "NonAtomicActionInstantiator.hpp"
+
+#include "collector/InstanceCollector.hpp"
+#include "constants/NonAtomicActionInterpreterConstants.hpp"
+#include "keynodes/NonAtomicKeynodes.hpp"
+#include "metrics/InterpretationMetrics.hpp"
+#include "scheduler/InterpretationScheduler.hpp"
+
+using namespace nonAtomicActionInterpreterModule;
+
+// Admitted action is resumed from its checkpoint or instantiated, and then it stays initiated until its interpretation
+// finishes it. Action that can't be interpreted is finished unsuccessfully here, because nobody waits for it.
+void AsyncNonAtomicActionInterpreter::interpretAdmitted(ScAgentContext * context, ScAction & action)
+{
+  TRACE_SPAN("AsyncNonAtomicActionInterpreter::interpretAdmitted", "interpreter");
+
+  try
+  {
+    ScAddr const & interruptedCheckpoint = InterpretationCheckpoint::find(context, action);
+    if (interruptedCheckpoint.IsValid())
+    {
+      InterpretationCheckpoint::resume(context, action, interruptedCheckpoint);
+      return;
+    }
+
+    NonAtomicActionInstantiator instantiator(context);
+    std::map<ScAddr, ScAddr, ScAddrLessFunc> replacements;
+    std::shared_ptr<LazyInstantiation> lazyInstantiation;
+    ScAddr const & nonAtomicActionAddr = instantiator.instantiate(action, replacements, lazyInstantiation);
+    ScAddr const & generalAction = instantiator.getGeneralAction(action);
+    auto const deadline = instantiator.getDeadline(action, nonAtomicActionAddr);
+    ScAddr const & checkpoint = InterpretationCheckpoint::generate(context, action, nonAtomicActionAddr, replacements);
+    interpret(
+        context, action, nonAtomicActionAddr, replacements, generalAction, deadline, lazyInstantiation, checkpoint);
+  }
+  catch (common::ActionCancelledException const & exception)
+  {
+    SC_LOG_ERROR(exception.Description());
+    context->GenerateConnector(ScType::ConstPermPosArc, Keynodes::action_cancelled, action);
+    finishUnsuccessfully(context, action);
+  }
+  catch (utils::ScException const & exception)
+  {
+    SC_LOG_ERROR(exception.Message());
+    finishUnsuccessfully(context, action);
+  }
+}
+
+void AsyncNonAtomicActionInterpreter::interpret(
+    ScAgentContext * context,
+    ScAddr const & action,
+    ScAddr const & nonAtomicActionAddr,
+    std::map<ScAddr, ScAddr, ScAddrLessFunc> const & replacements,
+    ScAddr const & generalAction,
+    std::chrono::steady_clock::time_point const & deadline,
+    std::shared_ptr<LazyInstantiation> const & lazyInstantiation,
+    ScAddr const & checkpoint)
+{
+  TRACE_SPAN("AsyncNonAtomicActionInterpreter::interpret", "interpreter");
+
+  start();
+
+  auto interpretation = std::make_shared<Interpretation>();
+  interpretation->context = std::make_unique<ScAgentContext>(context->GetUser());
+  interpretation->flow = std::make_unique<InterpretationFlow>(
+      interpretation->context.get(),
+      nonAtomicActionAddr,
+      replacements,
+      generalAction,
+      deadline,
+      lazyInstantiation,
+      checkpoint);
+  interpretation->action = action;
+
+  std::lock_guard<std::mutex> lock(interpretation->mutex);
+  subscribeToCancellation(interpretation);
+  try
+  {
+    applyActions(interpretation, interpretation->flow->start());
+    if (interpretation->flow->isFinished())
+      finish(interpretation, true);
+    else
+      interpretation->flow->prefetch();
+  }
+  catch (utils::ScException const &)
+  {
+    interpretation->isFinished = true;
+    retireSubscription(interpretation);
+    throw;
+  }
+}
+
+void AsyncNonAtomicActionInterpreter::clear()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    isStopped = true;
+  }
+  deadlinesChanged.notify_all();
+  if (deadlinesWatcher.joinable())
+    deadlinesWatcher.join();
+
+  std::list<RetiredSubscription> subscriptions;
+  std::unordered_map<ScAddr, PendingSubAction, ScAddrHashFunc> subActions;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    subscriptions.swap(retiredSubscriptions);
+    subActions.swap(pendingSubActions);
+    isStopped = false;
+  }
+}
+
+void AsyncNonAtomicActionInterpreter::start()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!deadlinesWatcher.joinable())
+    deadlinesWatcher = std::thread(&AsyncNonAtomicActionInterpreter::watchDeadlines);
+}
+
+void AsyncNonAtomicActionInterpreter::applyActions(
+    std::shared_ptr<Interpretation> const & interpretation,
+    ScAddrVector const & subActions)
+{
+  TRACE_SPAN("AsyncNonAtomicActionInterpreter::applyActions", "interpreter");
+
+  try
+  {
+    std::list<std::shared_ptr<ScEventSubscription>> subscriptions;
+    for (auto const & subActionAddr : subActions)
+      subscriptions.push_back(subscribeToFinish(interpretation, subActionAddr));
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto const now = std::chrono::steady_clock::now();
+      auto const waitDeadline =
+          now + std::chrono::milliseconds(NonAtomicActionInterpreterConstants::INTERPRETER_ACTION_WAIT_TIME);
+      auto subscriptionIt = subscriptions.begin();
+      for (auto const & subActionAddr : subActions)
+        pendingSubActions[subActionAddr] = {
+            interpretation,
+            std::move(*subscriptionIt++),
+            std::min(waitDeadline, interpretation->flow->getDeadline(subActionAddr)),
+            interpretation->flow->getSubActionClass(subActionAddr),
+            now};
+    }
+    deadlinesChanged.notify_all();
+
+    for (auto const & subActionAddr : subActions)
+    {
+      SC_LOG_DEBUG("AsyncNonAtomicActionInterpreter: initiating atomic action without waiting for its finish.");
+      interpretation->context->ConvertToAction(subActionAddr).Initiate();
+    }
+  }
+  catch (utils::ScException const &)
+  {
+    discardPendingSubActions(interpretation);
+    throw;
+  }
+}
+
+// Each applied sub-action is watched by its own subscription, as the synchronous interpreter does, so finishes of
+// unrelated actions don't reach the interpreter.
+std::shared_ptr<ScEventSubscription> AsyncNonAtomicActionInterpreter::subscribeToFinish(
+    std::shared_ptr<Interpretation> const & interpretation,
+    ScAddr const & subActionAddr)
+{
+  using ActionFinishedEvent = ScEventAfterGenerateIncomingArc<ScType::ConstPermPosArc>;
+
+  return interpretation->context->CreateElementaryEventSubscription<ActionFinishedEvent>(
+      subActionAddr,
+      [subActionAddr](ActionFinishedEvent const & event)
+      {
+        if (event.GetArcSourceElement() == ScKeynodes::action_finished)
+          onActionFinished(subActionAddr);
+      });
+}
+
+// Cancellation of the general action finishes the interpretation immediately instead of being noticed only
+// after the active sub-actions finish.
+void AsyncNonAtomicActionInterpreter::subscribeToCancellation(std::shared_ptr<Interpretation> const & interpretation)
+{
+  using ActionCancelledEvent = ScEventAfterGenerateIncomingArc<ScType::ConstPermPosArc>;
+
+  ScAddr const & generalAction = interpretation->flow->getGeneralAction();
+  if (!generalAction.IsValid())
+    return;
+
+  std::weak_ptr<Interpretation> weakInterpretation = interpretation;
+  interpretation->cancellationSubscription =
+      interpretation->context->CreateElementaryEventSubscription<ActionCancelledEvent>(
+          generalAction,
+          [weakInterpretation](ActionCancelledEvent const & event)
+          {
+            if (event.GetArcSourceElement() == Keynodes::action_cancelled)
+              onActionCancelled(weakInterpretation);
+          });
+}
+
+void AsyncNonAtomicActionInterpreter::onActionFinished(ScAddr const & subActionAddr)
+{
+  auto const finishTime = std::chrono::steady_clock::now();
+  PendingSubAction pendingSubAction;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto const & it = pendingSubActions.find(subActionAddr);
+    if (it == pendingSubActions.cend() || it->second.isRetry)
+      return;
+
+    pendingSubAction = std::move(it->second);
+    pendingSubActions.erase(it);
+    retireSubscription(pendingSubAction);
+  }
+  deadlinesChanged.notify_all();
+
+  SC_LOG_DEBUG("AsyncNonAtomicActionInterpreter: atomic action finished.");
+  proceed(subActionAddr, pendingSubAction, finishTime);
+}
+
+void AsyncNonAtomicActionInterpreter::onActionCancelled(std::weak_ptr<Interpretation> const & weakInterpretation)
+{
+  std::shared_ptr<Interpretation> const interpretation = weakInterpretation.lock();
+  if (!interpretation)
+    return;
+
+  std::lock_guard<std::mutex> lock(interpretation->mutex);
+  if (interpretation->isFinished)
+    return;
+
+  SC_LOG_ERROR(
+      "AsyncNonAtomicActionInterpreter: the processing action of the current non-atomic action has been interrupted.");
+  try
+  {
+    interpretation->flow->cancel();
+    interpretation->context->GenerateConnector(
+        ScType::ConstPermPosArc, Keynodes::action_cancelled, interpretation->action);
+  }
+  catch (utils::ScException const & exception)
+  {
+    SC_LOG_ERROR(exception.Message());
+  }
+  finish(interpretation, false);
+}
+
+void AsyncNonAtomicActionInterpreter::proceed(
+    ScAddr const & subActionAddr,
+    PendingSubAction const & pendingSubAction,
+    std::chrono::steady_clock::time_point const & finishTime)
+{
+  TRACE_SPAN("AsyncNonAtomicActionInterpreter::proceed", "interpreter");
+
+  std::shared_ptr<Interpretation> const & interpretation = pendingSubAction.interpretation;
+  std::lock_guard<std::mutex> lock(interpretation->mutex);
+  if (interpretation->isFinished)
+    return;
+
+  InterpretationMetrics::recordSubAction(
+      pendingSubAction.subActionClass, pendingSubAction.initiationTime, finishTime, std::chrono::steady_clock::now());
+
+  try
+  {
+    std::chrono::steady_clock::time_point retryTime;
+    if (interpretation->flow->scheduleRetry(subActionAddr, false, retryTime))
+    {
+      delayRetry(interpretation, subActionAddr, retryTime);
+      return;
+    }
+
+    applyActions(interpretation, interpretation->flow->proceed(subActionAddr));
+    if (interpretation->flow->isFinished())
+      finish(interpretation, true);
+    else
+      interpretation->flow->prefetch();
+  }
+  catch (common::ActionCancelledException const & exception)
+  {
+    SC_LOG_ERROR(exception.Description());
+    interpretation->context->GenerateConnector(
+        ScType::ConstPermPosArc, Keynodes::action_cancelled, interpretation->action);
+    finish(interpretation, false);
+  }
+  catch (utils::ScException const & exception)
+  {
+    SC_LOG_ERROR(exception.Message());
+    finish(interpretation, false);
+  }
+}
+
+// Retry waits in the pending sub-actions until its retry time, so its backoff is watched by the deadlines watcher
+// instead of occupying a thread.
+void AsyncNonAtomicActionInterpreter::delayRetry(
+    std::shared_ptr<Interpretation> const & interpretation,
+    ScAddr const & subActionAddr,
+    std::chrono::steady_clock::time_point const & retryTime)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    PendingSubAction & pendingSubAction = pendingSubActions[subActionAddr];
+    pendingSubAction.interpretation = interpretation;
+    pendingSubAction.deadline = retryTime;
+    pendingSubAction.isRetry = true;
+  }
+  deadlinesChanged.notify_all();
+}
+
+// Delayed retry is initiated again when its retry time comes. Expired sub-action is retried if its retry policy
+// allows it, otherwise the interpretation fails.
+void AsyncNonAtomicActionInterpreter::processExpiredSubAction(
+    ScAddr const & subActionAddr,
+    PendingSubAction const & expiredSubAction)
+{
+  std::shared_ptr<Interpretation> const & interpretation = expiredSubAction.interpretation;
+  std::lock_guard<std::mutex> lock(interpretation->mutex);
+  if (interpretation->isFinished || !interpretation->flow->isActive(subActionAddr))
+    return;
+
+  try
+  {
+    std::chrono::steady_clock::time_point retryTime;
+    if (expiredSubAction.isRetry)
+    {
+      SC_LOG_DEBUG("AsyncNonAtomicActionInterpreter: initiating atomic action again.");
+      interpretation->flow->prepareRetry(subActionAddr);
+      applyActions(interpretation, {subActionAddr});
+      return;
+    }
+
+    if (interpretation->flow->scheduleRetry(subActionAddr, true, retryTime))
+    {
+      delayRetry(interpretation, subActionAddr, retryTime);
+      return;
+    }
+
+    SC_LOG_ERROR("AsyncNonAtomicActionInterpreter: action wait time expired.");
+    interpretation->flow->cancel();
+  }
+  catch (utils::ScException const & exception)
+  {
+    SC_LOG_ERROR(exception.Message());
+  }
+  finish(interpretation, false);
+}
+
+void AsyncNonAtomicActionInterpreter::finish(std::shared_ptr<Interpretation> const & interpretation, bool isSuccessful)
+{
+  TRACE_SPAN("AsyncNonAtomicActionInterpreter::finish", "interpreter");
+
+  interpretation->isFinished = true;
+  discardPendingSubActions(interpretation);
+  retireSubscription(interpretation);
+
+  ScAction action = interpretation->context->ConvertToAction(interpretation->action);
+  if (isSuccessful)
+    action.FinishSuccessfully();
+  else
+    action.FinishUnsuccessfully();
+  InstanceCollector::release(action);
+  InterpretationCheckpoint::erase(interpretation->context.get(), action);
+  InterpretationScheduler::release(interpretation->context.get(), action);
+}
+
+void AsyncNonAtomicActionInterpreter::finishUnsuccessfully(ScAgentContext * context, ScAction & action)
+{
+  action.FinishUnsuccessfully();
+  InstanceCollector::release(action);
+  InterpretationCheckpoint::erase(context, action);
+  InterpretationScheduler::release(context, action);
+}
+
+void AsyncNonAtomicActionInterpreter::discardPendingSubActions(std::shared_ptr<Interpretation> const & interpretation)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto const & subActionAddr : interpretation->flow->getActiveSubActions())
+    {
+      auto const & it = pendingSubActions.find(subActionAddr);
+      if (it == pendingSubActions.cend())
+        continue;
+
+      retireSubscription(it->second);
+      pendingSubActions.erase(it);
+    }
+  }
+  deadlinesChanged.notify_all();
+}
+
+// Subscription can't be destroyed in its own callback, so it is destroyed by the deadlines watcher.
+void AsyncNonAtomicActionInterpreter::retireSubscription(std::shared_ptr<Interpretation> const & interpretation)
+{
+  if (!interpretation->cancellationSubscription)
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    retiredSubscriptions.push_back({interpretation, std::move(interpretation->cancellationSubscription)});
+  }
+  deadlinesChanged.notify_all();
+}
+
+// Subscription of a completed sub-action is retired together with its interpretation, so the context it was created
+// on outlives it. Caller holds the mutex.
+void AsyncNonAtomicActionInterpreter::retireSubscription(PendingSubAction & pendingSubAction)
+{
+  if (pendingSubAction.subscription)
+    retiredSubscriptions.push_back({pendingSubAction.interpretation, std::move(pendingSubAction.subscription)});
+}
+
+void AsyncNonAtomicActionInterpreter::watchDeadlines()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  while (!isStopped)
+  {
+    if (!retiredSubscriptions.empty())
+    {
+      std::list<RetiredSubscription> subscriptions;
+      subscriptions.swap(retiredSubscriptions);
+      lock.unlock();
+      subscriptions.clear();
+      lock.lock();
+      continue;
+    }
+
+    auto const now = std::chrono::steady_clock::now();
+    auto nearestDeadline = std::chrono::steady_clock::time_point::max();
+    std::list<std::pair<ScAddr, PendingSubAction>> expiredSubActions;
+    for (auto it = pendingSubActions.begin(); it != pendingSubActions.end();)
+    {
+      if (it->second.deadline <= now)
+      {
+        retireSubscription(it->second);
+        expiredSubActions.emplace_back(it->first, std::move(it->second));
+        it = pendingSubActions.erase(it);
+      }
+      else
+      {
+        nearestDeadline = std::min(nearestDeadline, it->second.deadline);
+        ++it;
+      }
+    }
+
+    if (!expiredSubActions.empty())
+    {
+      lock.unlock();
+      for (auto const & [subActionAddr, expiredSubAction] : expiredSubActions)
+        processExpiredSubAction(subActionAddr, expiredSubAction);
+      lock.lock();
+      continue;
+    }
+
+    if (nearestDeadline == std::chrono::steady_clock::time_point::max())
+      deadlinesChanged.wait(lock);
+    else
+      deadlinesChanged.wait_until(lock, nearestDeadline);
+  }
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include <sc-memory/sc_agent_context.hpp>
+
+#include "InterpretationFlow.hpp"
+
+namespace nonAtomicActionInterpreterModule
+{
+class AsyncNonAtomicActionInterpreter
+{
+public:
+  static void interpretAdmitted(ScAgentContext * context, ScAction & action);
+
+  static void interpret(
+      ScAgentContext * context,
+      ScAddr const & action,
+      ScAddr const & nonAtomicActionAddr,
+      std::map<ScAddr, ScAddr, ScAddrLessFunc> const & replacements,
+      ScAddr const & generalAction,
+      std::chrono::steady_clock::time_point const & deadline = std::chrono::steady_clock::time_point::max(),
+      std::shared_ptr<LazyInstantiation> const & lazyInstantiation = nullptr,
+      ScAddr const & checkpoint = ScAddr::Empty);
+
+  static void clear();
+
+private:
+  struct Interpretation
+  {
+    std::unique_ptr<ScAgentContext> context;
+    std::unique_ptr<InterpretationFlow> flow;
+    std::shared_ptr<ScEventSubscription> cancellationSubscription;
+    ScAddr action;
+    std::mutex mutex;
+    bool isFinished = false;
+  };
+
+  struct PendingSubAction
+  {
+    std::shared_ptr<Interpretation> interpretation;
+    std::shared_ptr<ScEventSubscription> subscription;
+    std::chrono::steady_clock::time_point deadline;
+    std::string subActionClass;
+    std::chrono::steady_clock::time_point initiationTime;
+    bool isRetry = false;
+  };
+
+  struct RetiredSubscription
+  {
+    std::shared_ptr<Interpretation> interpretation;
+    std::shared_ptr<ScEventSubscription> subscription;
+  };
+
+  static inline std::mutex mutex;
+  static inline std::condition_variable deadlinesChanged;
+  static inline std::unordered_map<ScAddr, PendingSubAction, ScAddrHashFunc> pendingSubActions;
+  static inline std::list<RetiredSubscription> retiredSubscriptions;
+  static inline std::thread deadlinesWatcher;
+  static inline bool isStopped = false;
+
+  static void start();
+
+  static void applyActions(std::shared_ptr<Interpretation> const & interpretation, ScAddrVector const & subActions);
+
+  static std::shared_ptr<ScEventSubscription> subscribeToFinish(
+      std::shared_ptr<Interpretation> const & interpretation,
+      ScAddr const & subActionAddr);
+
+  static void subscribeToCancellation(std::shared_ptr<Interpretation> const & interpretation);
+
+  static void onActionFinished(ScAddr const & subActionAddr);
+
+  static void onActionCancelled(std::weak_ptr<Interpretation> const & weakInterpretation);
+
+  static void proceed(
+      ScAddr const & subActionAddr,
+      PendingSubAction const & pendingSubAction,
+      std::chrono::steady_clock::time_point const & finishTime);
+
+  static void delayRetry(
+      std::shared_ptr<Interpretation> const & interpretation,
+      ScAddr const & subActionAddr,
+      std::chrono::steady_clock::time_point const & retryTime);
+
+  static void processExpiredSubAction(ScAddr const & subActionAddr, PendingSubAction const & expiredSubAction);
+
+  static void finish(std::shared_ptr<Interpretation> const & interpretation, bool isSuccessful);
+
+  static void finishUnsuccessfully(ScAgentContext * context, ScAction & action);
+
+  static void discardPendingSubActions(std::shared_ptr<Interpretation> const & interpretation);
+
+  static void retireSubscription(std::shared_ptr<Interpretation> const & interpretation);
+
+  static void retireSubscription(PendingSubAction & pendingSubAction);
+
+  static void watchDeadlines();
+};
+
+}  // namespace nonAtomicActionInterpreterModule
@@ -0,0 +1,218 @@
+#include "InterpretationCheckpoint.hpp"
+
+#include <list>
+
+#include <sc-agents-common/utils/IteratorUtils.hpp>
+
+#include <ps-common-lib/utils/macros.hpp>
+
+#include "AsyncNonAtomicActionInterpreter.hpp"
+#include "NonAtomicActionInstantiator.hpp"
+
+#include "keynodes/NonAtomicKeynodes.hpp"
+#include "scheduler/InterpretationScheduler.hpp"
+
+using namespace nonAtomicActionInterpreterModule;
+
+// Checkpoint is kept in the knowledge base, so it survives the restart of the machine together with the instance of
+// the non-atomic action. It refers to the instance as the first element, to the tuple of the replacements of the
+// instance as the second one and to the ordered path of the taken transitions as the third one, and contains finished
+// sub-actions of the instance. Lazily instantiated action is rejected, because its instantiation state is not
+// persisted, so it can't be resumed.
+ScAddr InterpretationCheckpoint::generate(
+    ScAgentContext * context,
+    ScAction const & action,
+    ScAddr const & nonAtomicActionAddr,
+    std::map<ScAddr, ScAddr, ScAddrLessFunc> const & replacements)
+{
+  TRACE_SPAN("InterpretationCheckpoint::generate", "interpreter");
+
+  if (!context->CheckConnector(Keynodes::action_with_checkpoints, action, ScType::ConstPermPosArc))
+    return ScAddr::Empty;
+
+  if (context->CheckConnector(Keynodes::lazily_instantiated_action, action, ScType::ConstPermPosArc))
+    SC_THROW_EXCEPTION(
+        utils::ExceptionInvalidParams,
+        "NonAtomicActionInterpreter: lazily instantiated non-atomic action can't be interpreted with checkpoints.");
+
+  ScAddr const & checkpoint = context->GenerateNode(ScType::ConstNodeStructure);
+  ScAddr const & instanceArc = context->GenerateConnector(ScType::ConstPermPosArc, checkpoint, nonAtomicActionAddr);
+  context->GenerateConnector(ScType::ConstPermPosArc, ScKeynodes::rrel_1, instanceArc);
+
+  ScAddr const & replacementsTuple = context->GenerateNode(ScType::ConstNodeTuple);
+  for (auto const & [variable, value] : replacements)
+  {
+    ScAddr const & replacementArc = context->GenerateConnector(ScType::ConstCommonArc, variable, value);
+    context->GenerateConnector(ScType::ConstPermPosArc, replacementsTuple, replacementArc);
+  }
+  ScAddr const & replacementsArc = context->GenerateConnector(ScType::ConstPermPosArc, checkpoint, replacementsTuple);
+  context->GenerateConnector(ScType::ConstPermPosArc, ScKeynodes::rrel_2, replacementsArc);
+
+  ScAddr const & path = context->GenerateNode(ScType::ConstNodeTuple);
+  ScAddr const & pathArc = context->GenerateConnector(ScType::ConstPermPosArc, checkpoint, path);
+  context->GenerateConnector(ScType::ConstPermPosArc, ScKeynodes::rrel_3, pathArc);
+
+  ScAddr const & checkpointArc = context->GenerateConnector(ScType::ConstCommonArc, action, checkpoint);
+  context->GenerateConnector(ScType::ConstPermPosArc, Keynodes::nrel_interpretation_checkpoint, checkpointArc);
+  return checkpoint;
+}
+
+ScAddr InterpretationCheckpoint::find(ScAgentContext * context, ScAddr const & action)
+{
+  return utils::IteratorUtils::getAnyByOutRelation(context, action, Keynodes::nrel_interpretation_checkpoint);
+}
+
+// Replacement arcs are erased together with their tuple, the elements they connect belong to the template and the
+// instance.
+void InterpretationCheckpoint::erase(ScAgentContext * context, ScAddr const & action)
+{
+  ScAddr const & checkpoint = find(context, action);
+  if (!checkpoint.IsValid())
+    return;
+
+  ScAddrVector elementsToErase;
+  ScAddr const & replacementsTuple = utils::IteratorUtils::getAnyByOutRelation(context, checkpoint, ScKeynodes::rrel_2);
+  if (replacementsTuple.IsValid())
+  {
+    ScIterator3Ptr replacementsIterator3 =
+        context->CreateIterator3(replacementsTuple, ScType::ConstPermPosArc, ScType::ConstCommonArc);
+    while (replacementsIterator3->Next())
+      elementsToErase.push_back(replacementsIterator3->Get(2));
+    elementsToErase.push_back(replacementsTuple);
+  }
+
+  ScAddr const & path = getPath(context, checkpoint);
+  if (path.IsValid())
+    elementsToErase.push_back(path);
+  elementsToErase.push_back(checkpoint);
+
+  for (auto const & element : elementsToErase)
+    context->EraseElement(element);
+}
+
+// Resumed action is interpreted asynchronously from the sub-actions that are not finished yet.
+void InterpretationCheckpoint::resume(ScAgentContext * context, ScAction & action, ScAddr const & checkpoint)
+{
+  TRACE_SPAN("InterpretationCheckpoint::resume", "interpreter");
+
+  SC_LOG_INFO("NonAtomicActionInterpreter: resuming interrupted non-atomic action.");
+  ScAddr const & nonAtomicActionAddr =
+      utils::IteratorUtils::getAnyByOutRelation(context, checkpoint, ScKeynodes::rrel_1);
+  if (!nonAtomicActionAddr.IsValid())
+    SC_THROW_EXCEPTION(utils::ExceptionInvalidParams, "checkpoint doesn't refer to non-atomic action.");
+
+  NonAtomicActionInstantiator instantiator(context);
+  AsyncNonAtomicActionInterpreter::interpret(
+      context,
+      action,
+      nonAtomicActionAddr,
+      getReplacements(context, checkpoint),
+      instantiator.getGeneralAction(action),
+      instantiator.getDeadline(action, nonAtomicActionAddr),
+      nullptr,
+      checkpoint);
+}
+
+// Interrupted actions are resumed asynchronously, so the startup of the module doesn't wait for them. They are
+// admitted by the scheduler as newly initiated actions are, so the concurrency cap and priorities hold after the
+// restart. Queued action is resumed by the scheduler when a slot is freed.
+void InterpretationCheckpoint::resumeInterrupted(ScAgentContext * context)
+{
+  TRACE_SPAN("InterpretationCheckpoint::resumeInterrupted", "interpreter");
+
+  std::list<std::pair<ScAddr, ScAddr>> checkpoints;
+  ScIterator5Ptr checkpointsIterator5 = context->CreateIterator5(
+      ScType::ConstNode,
+      ScType::ConstCommonArc,
+      ScType::ConstNodeStructure,
+      ScType::ConstPermPosArc,
+      Keynodes::nrel_interpretation_checkpoint);
+  while (checkpointsIterator5->Next())
+    checkpoints.emplace_back(checkpointsIterator5->Get(0), checkpointsIterator5->Get(2));
+
+  for (auto const & [actionAddr, checkpoint] : checkpoints)
+  {
+    ScAction action = context->ConvertToAction(actionAddr);
+    if (action.IsFinished())
+    {
+      context->EraseElement(checkpoint);
+      continue;
+    }
+
+    Admission const admission = InterpretationScheduler::admit(context, action);
+    if (admission == Admission::Queued)
+      continue;
+    else if (admission == Admission::Rejected)
+    {
+      context->EraseElement(checkpoint);
+      action.FinishUnsuccessfully();
+      continue;
+    }
+
+    AsyncNonAtomicActionInterpreter::interpretAdmitted(context, action);
+  }
+}
+
+std::map<ScAddr, ScAddr, ScAddrLessFunc> InterpretationCheckpoint::getReplacements(
+    ScAgentContext * context,
+    ScAddr const & checkpoint)
+{
+  std::map<ScAddr, ScAddr, ScAddrLessFunc> replacements;
+  ScAddr const & replacementsTuple = utils::IteratorUtils::getAnyByOutRelation(context, checkpoint, ScKeynodes::rrel_2);
+  if (!replacementsTuple.IsValid())
+    SC_THROW_EXCEPTION(utils::ExceptionInvalidParams, "checkpoint doesn't refer to replacements.");
+
+  ScIterator3Ptr replacementsIterator3 =
+      context->CreateIterator3(replacementsTuple, ScType::ConstPermPosArc, ScType::ConstCommonArc);
+  while (replacementsIterator3->Next())
+  {
+    auto const [variable, value] = context->GetConnectorIncidentElements(replacementsIterator3->Get(2));
+    replacements[variable] = value;
+  }
+  return replacements;
+}
+
+ScAddr InterpretationCheckpoint::getPath(ScAgentContext * context, ScAddr const & checkpoint)
+{
+  return utils::IteratorUtils::getAnyByOutRelation(context, checkpoint, ScKeynodes::rrel_3);
+}
+
+// Path is ordered as the sequences of sub-actions are: its first arc is marked by rrel_1, and each next arc is
+// connected with the previous one by nrel_basic_sequence. Returns the arc of the last taken transition.
+ScAddr InterpretationCheckpoint::getPathEnd(ScAgentContext * context, ScAddr const & path)
+{
+  ScAddr pathEnd;
+  ScIterator5Ptr firstArcIterator5 = context->CreateIterator5(
+      path, ScType::ConstPermPosArc, ScType::Unknown, ScType::ConstPermPosArc, ScKeynodes::rrel_1);
+  if (firstArcIterator5->Next())
+    pathEnd = firstArcIterator5->Get(1);
+
+  while (pathEnd.IsValid())
+  {
+    ScAddr const & nextArc = utils::IteratorUtils::getAnyByOutRelation(context, pathEnd, Keynodes::nrel_basic_sequence);
+    if (!nextArc.IsValid())
+      break;
+    pathEnd = nextArc;
+  }
+  return pathEnd;
+}
+
+ScAddr InterpretationCheckpoint::appendToPath(
+    ScAgentContext * context,
+    ScAddr const & path,
+    ScAddr const & pathEnd,
+    ScAddr const & transitionArc)
+{
+  if (context->CheckConnector(path, transitionArc, ScType::ConstPermPosArc))
+    return pathEnd;
+
+  ScAddr const & pathArc = context->GenerateConnector(ScType::ConstPermPosArc, path, transitionArc);
+  if (pathEnd.IsValid())
+  {
+    ScAddr const & sequenceArc = context->GenerateConnector(ScType::ConstCommonArc, pathEnd, pathArc);
+    context->GenerateConnector(ScType::ConstPermPosArc, Keynodes::nrel_basic_sequence, sequenceArc);
+  }
+  else
+    context->GenerateConnector(ScType::ConstPermPosArc, ScKeynodes::rrel_1, pathArc);
+  return pathArc;
+}
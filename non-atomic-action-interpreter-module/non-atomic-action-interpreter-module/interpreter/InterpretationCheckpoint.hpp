@@ -0,0 +1,39 @@
+#pragma once
+
+#include <map>
+
+#include <sc-memory/sc_agent_context.hpp>
+
+namespace nonAtomicActionInterpreterModule
+{
+class InterpretationCheckpoint
+{
+public:
+  static ScAddr generate(
+      ScAgentContext * context,
+      ScAction const & action,
+      ScAddr const & nonAtomicActionAddr,
+      std::map<ScAddr, ScAddr, ScAddrLessFunc> const & replacements);
+
+  static ScAddr find(ScAgentContext * context, ScAddr const & action);
+
+  static void erase(ScAgentContext * context, ScAddr const & action);
+
+  static void resume(ScAgentContext * context, ScAction & action, ScAddr const & checkpoint);
+
+  static void resumeInterrupted(ScAgentContext * context);
+
+  static std::map<ScAddr, ScAddr, ScAddrLessFunc> getReplacements(ScAgentContext * context, ScAddr const & checkpoint);
+
+  static ScAddr getPath(ScAgentContext * context, ScAddr const & checkpoint);
+
+  static ScAddr getPathEnd(ScAgentContext * context, ScAddr const & path);
+
+  static ScAddr appendToPath(
+      ScAgentContext * context,
+      ScAddr const & path,
+      ScAddr const & pathEnd,
+      ScAddr const & transitionArc);
+};
+
+}  // namespace nonAtomicActionInterpreterModule
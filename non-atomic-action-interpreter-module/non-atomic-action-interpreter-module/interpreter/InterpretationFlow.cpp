@@ -0,0 +1,762 @@
+#include "InterpretationFlow.hpp"
+
+#include <algorithm>
+#include <list>
+
+#include <sc-agents-common/utils/IteratorUtils.hpp>
+#include <ps-common-lib/action_cancelled_exception.hpp>
+#include <ps-common-lib/utils/logic_utils.hpp>
+#include <ps-common-lib/utils/macros.hpp>
+
+#include "InterpretationCheckpoint.hpp"
+#include "RetryPolicy.hpp"
+
+#include "collector/InstanceCollector.hpp"
+#include "graph/TransitionGraphCache.hpp"
+#include "interpreter/NonAtomicActionInstantiator.hpp"
+#include "keynodes/NonAtomicKeynodes.hpp"
+#include "metrics/InterpretationMetrics.hpp"
+
+using namespace nonAtomicActionInterpreterModule;
+
+InterpretationFlow::InterpretationFlow(
+    ScAgentContext * context,
+    ScAddr const & nonAtomicActionAddr,
+    std::map<ScAddr, ScAddr, ScAddrLessFunc> const & replacements,
+    ScAddr const & generalAction,
+    std::chrono::steady_clock::time_point const & deadline,
+    std::shared_ptr<LazyInstantiation> const & lazyInstantiation,
+    ScAddr const & checkpoint)
+  : context(context)
+  , replacements(replacements)
+  , generalAction(generalAction)
+  , deadline(deadline)
+  , lazyInstantiation(lazyInstantiation)
+  , checkpoint(checkpoint)
+  , graph(getTransitionGraph(nonAtomicActionAddr))
+  , finished(false)
+{
+  if (checkpoint.IsValid())
+  {
+    path = InterpretationCheckpoint::getPath(context, checkpoint);
+    if (path.IsValid())
+      pathEnd = InterpretationCheckpoint::getPathEnd(context, path);
+  }
+}
+
+ScAddrVector InterpretationFlow::start()
+{
+  TRACE_SPAN("InterpretationFlow::start", "interpreter");
+
+  ScAddrVector subActionsToApply;
+  size_t firstNode = getFirstSubAction();
+  auto rootGroup =
+      std::make_shared<JoinGroup>(JoinGroup{TransitionGraph::NO_NODE, ScAddr::Empty, ScAddr::Empty, 1, nullptr});
+  startBranch(firstNode, graph->getNode(firstNode).action, rootGroup, subActionsToApply);
+  return checkpoint.IsValid() ? replayCheckpoint(subActionsToApply) : subActionsToApply;
+}
+
+ScAddrVector InterpretationFlow::proceed(ScAddr const & finishedSubAction)
+{
+  TRACE_SPAN("InterpretationFlow::proceed", "interpreter");
+
+  ScAddrVector subActionsToApply;
+  auto const & ownerIt = nestedSubActionOwners.find(finishedSubAction);
+  if (ownerIt != nestedSubActionOwners.cend())
+  {
+    ScAddr const nestedAction = ownerIt->second;
+    nestedSubActionOwners.erase(ownerIt);
+    proceedNestedFlow(nestedAction, finishedSubAction, subActionsToApply);
+  }
+  else
+    completeSubAction(finishedSubAction, subActionsToApply);
+
+  return subActionsToApply;
+}
+
+bool InterpretationFlow::isFinished() const
+{
+  return finished;
+}
+
+ScAddrVector InterpretationFlow::getActiveSubActions() const
+{
+  ScAddrVector subActions;
+  for (auto const & [subAction, activeSubAction] : activeSubActions)
+  {
+    auto const & nestedFlowIt = nestedFlows.find(subAction);
+    if (nestedFlowIt == nestedFlows.cend())
+      subActions.push_back(subAction);
+    else
+    {
+      ScAddrVector const & nestedSubActions = nestedFlowIt->second->getActiveSubActions();
+      subActions.insert(subActions.end(), nestedSubActions.cbegin(), nestedSubActions.cend());
+    }
+  }
+  return subActions;
+}
+
+bool InterpretationFlow::isActive(ScAddr const & subAction) const
+{
+  auto const & ownerIt = nestedSubActionOwners.find(subAction);
+  if (ownerIt != nestedSubActionOwners.cend())
+    return nestedFlows.at(ownerIt->second)->isActive(subAction);
+
+  return activeSubActions.count(subAction) && !nestedFlows.count(subAction);
+}
+
+ScAddr InterpretationFlow::getGeneralAction() const
+{
+  return generalAction;
+}
+
+std::chrono::steady_clock::time_point InterpretationFlow::getDeadline(ScAddr const & subAction) const
+{
+  auto const & ownerIt = nestedSubActionOwners.find(subAction);
+  if (ownerIt != nestedSubActionOwners.cend())
+    return nestedFlows.at(ownerIt->second)->getDeadline(subAction);
+
+  return deadline;
+}
+
+// Class is searched by the sub-action of the transition graph, so it is cached once for all instances of the template.
+std::string InterpretationFlow::getSubActionClass(ScAddr const & subAction) const
+{
+  auto const & ownerIt = nestedSubActionOwners.find(subAction);
+  if (ownerIt != nestedSubActionOwners.cend())
+    return nestedFlows.at(ownerIt->second)->getSubActionClass(subAction);
+
+  auto const & it = activeSubActions.find(subAction);
+  if (it == activeSubActions.cend())
+    return InterpretationMetrics::getSubActionClass(context, subAction);
+
+  return InterpretationMetrics::getSubActionClass(context, graph->getNode(it->second.node).action);
+}
+
+// Conditions of all possible transitions from the active sub-actions and templates of the nested non-atomic actions
+// among their successors are compiled by a background task while the sub-actions are performed, so only the search by
+// the compiled templates remains after a sub-action finishes. Successors themselves are already resolved by the
+// transition graph. Active sub-actions are not collected while the previous task is running, their successors are
+// compiled on demand then.
+void InterpretationFlow::prefetch()
+{
+  TRACE_SPAN("InterpretationFlow::prefetch", "interpreter");
+
+  if (prefetchTask.valid() && prefetchTask.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    return;
+
+  ScAddrVector conditions;
+  ScAddrVector nestedTemplates;
+  collectPrefetched(conditions, nestedTemplates);
+  if (conditions.empty() && nestedTemplates.empty())
+    return;
+
+  prefetchTask = std::async(
+      std::launch::async,
+      [conditions = std::move(conditions), nestedTemplates = std::move(nestedTemplates)]()
+      {
+        TRACE_SPAN("InterpretationFlow::prefetchTask", "interpreter");
+
+        auto const startTime = InterpretationMetrics::Clock::now();
+        ScAgentContext prefetchContext;
+        for (auto const & condition : conditions)
+          prefetchTransitionCondition(&prefetchContext, condition);
+        for (auto const & templateAddr : nestedTemplates)
+          prefetchNestedTemplate(&prefetchContext, templateAddr);
+        InterpretationMetrics::recordDuration("prefetch_time", startTime, InterpretationMetrics::Clock::now());
+      });
+}
+
+void InterpretationFlow::collectPrefetched(ScAddrVector & conditions, ScAddrVector & nestedTemplates)
+{
+  for (auto const & [subAction, activeSubAction] : activeSubActions)
+  {
+    auto const & nestedFlowIt = nestedFlows.find(subAction);
+    if (nestedFlowIt != nestedFlows.cend())
+    {
+      nestedFlowIt->second->collectPrefetched(conditions, nestedTemplates);
+      continue;
+    }
+
+    if (!prefetchedNodes.insert(activeSubAction.node).second)
+      continue;
+
+    TransitionGraph::Node const & node = graph->getNode(activeSubAction.node);
+    auto const & collectTransition = [&](TransitionGraph::Transition const & transition)
+    {
+      if (transition.condition.IsValid())
+        conditions.push_back(transition.condition);
+      ScAddr const & nestedTemplate = getNestedTemplate(transition.target);
+      if (nestedTemplate.IsValid())
+        nestedTemplates.push_back(nestedTemplate);
+    };
+    for (auto const & transitions : node.transitions)
+    {
+      for (auto const & transition : transitions)
+        collectTransition(transition);
+    }
+    for (auto const & fork : node.forks)
+      collectTransition(fork);
+  }
+}
+
+// Successors are elements of the template when the flow is instantiated lazily, so arcs of any constancy are checked.
+// Templates bound by arguments are variables there, they are compiled on demand.
+ScAddr InterpretationFlow::getNestedTemplate(ScAddr const & successor)
+{
+  if (!successor.IsValid())
+    return ScAddr::Empty;
+
+  ScIterator3Ptr classesIterator3 =
+      context->CreateIterator3(Keynodes::action_interpret_non_atomic_action, ScType::PermPosArc, successor);
+  if (!classesIterator3->Next())
+    return ScAddr::Empty;
+
+  ScIterator5Ptr templatesIterator5 = context->CreateIterator5(
+      successor, ScType::PermPosArc, ScType::Unknown, ScType::PermPosArc, ScKeynodes::rrel_1);
+  if (!templatesIterator5->Next() || !context->GetElementType(templatesIterator5->Get(2)).IsConst())
+    return ScAddr::Empty;
+
+  return templatesIterator5->Get(2);
+}
+
+// Sub-action is retried if its retry policy allows to retry the outcome, attempts remain and the next attempt starts
+// before the time budget expires. The sub-action stays active until its retry time, the driver initiates it again.
+bool InterpretationFlow::scheduleRetry(
+    ScAddr const & subAction,
+    bool isTimedOut,
+    std::chrono::steady_clock::time_point & retryTime)
+{
+  auto const & ownerIt = nestedSubActionOwners.find(subAction);
+  if (ownerIt != nestedSubActionOwners.cend())
+    return nestedFlows.at(ownerIt->second)->scheduleRetry(subAction, isTimedOut, retryTime);
+
+  if (!isActive(subAction) || (!isTimedOut && !context->ConvertToAction(subAction).IsFinishedUnsuccessfully()))
+    return false;
+
+  RetryPolicy policy;
+  if (!RetryPolicy::get(context, subAction, policy) || !policy.isRetryable(isTimedOut))
+    return false;
+
+  size_t & attempt = retryAttempts[subAction];
+  if (attempt + 1 >= policy.maxAttempts)
+    return false;
+
+  retryTime = std::chrono::steady_clock::now() + policy.getBackoff(attempt);
+  if (retryTime >= deadline)
+    return false;
+
+  attempt++;
+  SC_LOG_WARNING(
+      "NonAtomicActionInterpreter: " << (isTimedOut ? "atomic action wait time expired" : "atomic action failed")
+                                     << ", retrying it, attempt " << attempt + 1 << " of " << policy.maxAttempts
+                                     << ".");
+  InterpretationMetrics::recordRetry(isTimedOut);
+  return true;
+}
+
+// Sub-action is initiated again as the same element, so the marks and the results of its previous attempt are erased.
+// Result structure is erased without its elements, because they may belong to the rest of the knowledge base.
+void InterpretationFlow::prepareRetry(ScAddr const & subAction)
+{
+  ScAddrVector results;
+  ScIterator5Ptr resultsIterator5 = context->CreateIterator5(
+      subAction, ScType::ConstCommonArc, ScType::Unknown, ScType::ConstPermPosArc, ScKeynodes::nrel_result);
+  while (resultsIterator5->Next())
+  {
+    ScAddr const & result = resultsIterator5->Get(2);
+    results.push_back(context->GetElementType(result).IsStructure() ? result : resultsIterator5->Get(1));
+  }
+  for (auto const & result : results)
+    context->EraseElement(result);
+
+  for (auto const & mark :
+       {ScKeynodes::action_initiated,
+        ScKeynodes::action_finished,
+        ScKeynodes::action_finished_successfully,
+        ScKeynodes::action_finished_unsuccessfully,
+        ScKeynodes::action_finished_with_error})
+  {
+    ScIterator3Ptr markArcsIterator3 = context->CreateIterator3(mark, ScType::ConstPermPosArc, subAction);
+    while (markArcsIterator3->Next())
+      context->EraseElement(markArcsIterator3->Get(1));
+  }
+}
+
+void InterpretationFlow::cancel()
+{
+  SC_LOG_DEBUG("NonAtomicActionInterpreter: cancelling active sub-actions.");
+  for (auto const & [subAction, activeSubAction] : activeSubActions)
+  {
+    auto const & nestedFlowIt = nestedFlows.find(subAction);
+    if (nestedFlowIt != nestedFlows.cend())
+      nestedFlowIt->second->cancel();
+
+    if (!context->CheckConnector(Keynodes::action_cancelled, subAction, ScType::ConstPermPosArc))
+      context->GenerateConnector(ScType::ConstPermPosArc, Keynodes::action_cancelled, subAction);
+  }
+}
+
+// Graph is built on the template tuple and shared by all runs of the template, elements of the template are mapped to
+// the elements of the instance by its instantiation. Resumed action has no instantiation, so it is interpreted by the
+// graph of its own decomposition tuple, which is cached and invalidated by sc-events as well.
+std::shared_ptr<TransitionGraph const> InterpretationFlow::getTransitionGraph(ScAddr const & nonAtomicActionAddr)
+{
+  if (lazyInstantiation)
+    return TransitionGraphCache::get(context, lazyInstantiation->getDecompositionTuple());
+
+  ScAddr const & decompositionTuple =
+      utils::IteratorUtils::getAnyByOutRelation(context, nonAtomicActionAddr, Keynodes::nrel_decomposition_of_action);
+  return TransitionGraphCache::get(context, decompositionTuple);
+}
+
+size_t InterpretationFlow::getFirstSubAction()
+{
+  size_t firstNode = graph->getFirstNode();
+  if (firstNode == TransitionGraph::NO_NODE)
+  {
+    SC_THROW_EXCEPTION(
+        utils::ExceptionCritical, "Non-atomic action structure is incorrect. Failed to find first action.");
+  }
+  return firstNode;
+}
+
+void InterpretationFlow::checkSubAction(size_t node)
+{
+  if (node == TransitionGraph::NO_NODE)
+    SC_THROW_EXCEPTION(
+        utils::ExceptionCritical,
+        "NonAtomicActionInterpreter: action is not belongs to non-atomic action decomposition.");
+
+  if (context->CheckConnector(Keynodes::action_cancelled, generalAction, ScType::ConstPermPosArc))
+    SC_THROW_EXCEPTION(
+        common::ActionCancelledException,
+        "NonAtomicActionInterpreter: the processing action of the current non-atomic action has been interrupted.");
+
+  if (std::chrono::steady_clock::now() >= deadline)
+    SC_THROW_EXCEPTION(utils::ExceptionCritical, "NonAtomicActionInterpreter: non-atomic action time budget expired.");
+}
+
+ScAddr InterpretationFlow::instantiate(ScAddr const & element)
+{
+  return lazyInstantiation ? lazyInstantiation->instantiate(context, element) : element;
+}
+
+bool InterpretationFlow::isRecorded(ScAddr const & subAction)
+{
+  return checkpoint.IsValid() && context->CheckConnector(checkpoint, subAction, ScType::ConstPermPosArc);
+}
+
+bool InterpretationFlow::isCompletedBeforeRestart(ScAddr const & subAction)
+{
+  return checkpoint.IsValid()
+         && (isRecorded(subAction) || context->ConvertToAction(subAction).IsFinished());
+}
+
+void InterpretationFlow::recordCheckpoint(ScAddr const & finishedSubAction)
+{
+  if (checkpoint.IsValid() && !isRecorded(finishedSubAction))
+    context->GenerateConnector(ScType::ConstPermPosArc, checkpoint, finishedSubAction);
+}
+
+void InterpretationFlow::recordTransition(ScAddr const & transitionArc)
+{
+  if (path.IsValid())
+    pathEnd = InterpretationCheckpoint::appendToPath(context, path, pathEnd, transitionArc);
+}
+
+// Transitions taken before the restart are taken again without checking their conditions, because the knowledge base
+// may have changed since then. Conditions are checked if the restart happened before any of them was recorded.
+bool InterpretationFlow::isTakenBeforeRestart(std::vector<TransitionGraph::Transition> const & transitions)
+{
+  if (!path.IsValid())
+    return false;
+
+  for (auto const & transition : transitions)
+  {
+    if (isTaken(transition))
+      return true;
+  }
+  return false;
+}
+
+bool InterpretationFlow::isTaken(TransitionGraph::Transition const & transition)
+{
+  return context->CheckConnector(path, instantiate(transition.arc), ScType::ConstPermPosArc);
+}
+
+// Sub-actions recorded in the checkpoint or finished before the restart are completed again without being applied,
+// so the flow reaches the state it had before the restart. Sub-actions that were being performed are initiated again.
+ScAddrVector InterpretationFlow::replayCheckpoint(ScAddrVector const & subActions)
+{
+  SC_LOG_DEBUG("NonAtomicActionInterpreter: resuming non-atomic action from checkpoint.");
+  ScAddrVector subActionsToApply;
+  std::list<ScAddr> subActionsToReplay(subActions.cbegin(), subActions.cend());
+  while (!subActionsToReplay.empty())
+  {
+    ScAddr const subAction = subActionsToReplay.front();
+    subActionsToReplay.pop_front();
+    if (isCompletedBeforeRestart(subAction))
+    {
+      ScAddrVector nextSubActions;
+      completeSubAction(subAction, nextSubActions);
+      subActionsToReplay.insert(subActionsToReplay.end(), nextSubActions.cbegin(), nextSubActions.cend());
+      continue;
+    }
+
+    ScIterator3Ptr initiatedArcsIterator3 =
+        context->CreateIterator3(ScKeynodes::action_initiated, ScType::ConstPermPosArc, subAction);
+    while (initiatedArcsIterator3->Next())
+      context->EraseElement(initiatedArcsIterator3->Get(1));
+    subActionsToApply.push_back(subAction);
+  }
+  return subActionsToApply;
+}
+
+void InterpretationFlow::startBranch(
+    size_t node,
+    ScAddr const & action,
+    std::shared_ptr<JoinGroup> const & group,
+    ScAddrVector & subActionsToApply)
+{
+  checkSubAction(node);
+  ScAddr const subAction = instantiate(action);
+  activeSubActions[subAction] = {node, group};
+  if (isNestedNonAtomicAction(subAction) && !isCompletedBeforeRestart(subAction))
+    startNestedFlow(subAction, subActionsToApply);
+  else
+    subActionsToApply.push_back(subAction);
+}
+
+void InterpretationFlow::completeSubAction(ScAddr const & finishedSubAction, ScAddrVector & subActionsToApply)
+{
+  auto const & it = activeSubActions.find(finishedSubAction);
+  if (it == activeSubActions.cend())
+    return;
+
+  ActiveSubAction const activeSubAction = it->second;
+  activeSubActions.erase(it);
+  retryAttempts.erase(finishedSubAction);
+  conditionResults.clear();
+  recordCheckpoint(finishedSubAction);
+
+  TransitionGraph::Node const & node = graph->getNode(activeSubAction.node);
+  if (!node.forks.empty())
+  {
+    forkBranches(node, activeSubAction.group, subActionsToApply);
+    return;
+  }
+
+  size_t nextNode = activeSubAction.node;
+  ScAddr nextAction;
+  if (getNextAction(nextNode, finishedSubAction, nextAction) && nextAction != activeSubAction.group->join)
+    startBranch(nextNode, nextAction, activeSubAction.group, subActionsToApply);
+  else
+    completeBranch(activeSubAction.group, subActionsToApply);
+}
+
+bool InterpretationFlow::isNestedNonAtomicAction(ScAddr const & subAction)
+{
+  return context->CheckConnector(Keynodes::action_interpret_non_atomic_action, subAction, ScType::ConstPermPosArc);
+}
+
+// Nested non-atomic action is interpreted by a nested flow instead of the agent, its atomic sub-actions are
+// applied by the driver of this flow. Errors of the nested interpretation finish the nested action unsuccessfully,
+// as the agent does, and do not interrupt this flow.
+void InterpretationFlow::startNestedFlow(ScAddr const & nestedAction, ScAddrVector & subActionsToApply)
+{
+  TRACE_SPAN("InterpretationFlow::startNestedFlow", "interpreter");
+
+  SC_LOG_DEBUG("NonAtomicActionInterpreter: interpreting nested non-atomic action inline.");
+  ScAddrVector nestedSubActions;
+  bool isSuccessful = true;
+  try
+  {
+    ScAction action = context->ConvertToAction(nestedAction);
+    std::map<ScAddr, ScAddr, ScAddrLessFunc> nestedReplacements;
+    std::shared_ptr<LazyInstantiation> nestedLazyInstantiation;
+    NonAtomicActionInstantiator instantiator(context);
+    ScAddr const & nestedNonAtomicActionAddr =
+        instantiator.instantiate(action, nestedReplacements, nestedLazyInstantiation);
+    auto nestedFlow = std::make_unique<InterpretationFlow>(
+        context,
+        nestedNonAtomicActionAddr,
+        nestedReplacements,
+        instantiator.getGeneralAction(nestedAction),
+        instantiator.getDeadline(action, nestedNonAtomicActionAddr, deadline),
+        nestedLazyInstantiation);
+    nestedSubActions = nestedFlow->start();
+    nestedFlows[nestedAction] = std::move(nestedFlow);
+  }
+  catch (common::ActionCancelledException const & exception)
+  {
+    SC_LOG_ERROR(exception.Description());
+    context->GenerateConnector(ScType::ConstPermPosArc, Keynodes::action_cancelled, nestedAction);
+    isSuccessful = false;
+  }
+  catch (utils::ScException const & exception)
+  {
+    SC_LOG_ERROR(exception.Message());
+    isSuccessful = false;
+  }
+
+  if (isSuccessful)
+    addNestedSubActions(nestedAction, nestedSubActions, subActionsToApply);
+  else
+    finishNestedAction(nestedAction, false, subActionsToApply);
+}
+
+void InterpretationFlow::proceedNestedFlow(
+    ScAddr const & nestedAction,
+    ScAddr const & finishedSubAction,
+    ScAddrVector & subActionsToApply)
+{
+  InterpretationFlow & nestedFlow = *nestedFlows.at(nestedAction);
+  ScAddrVector nestedSubActions;
+  bool isSuccessful = true;
+  try
+  {
+    nestedSubActions = nestedFlow.proceed(finishedSubAction);
+  }
+  catch (common::ActionCancelledException const & exception)
+  {
+    SC_LOG_ERROR(exception.Description());
+    context->GenerateConnector(ScType::ConstPermPosArc, Keynodes::action_cancelled, nestedAction);
+    isSuccessful = false;
+  }
+  catch (utils::ScException const & exception)
+  {
+    SC_LOG_ERROR(exception.Message());
+    isSuccessful = false;
+  }
+
+  if (isSuccessful)
+    addNestedSubActions(nestedAction, nestedSubActions, subActionsToApply);
+  else
+    finishNestedAction(nestedAction, false, subActionsToApply);
+}
+
+void InterpretationFlow::addNestedSubActions(
+    ScAddr const & nestedAction,
+    ScAddrVector const & nestedSubActions,
+    ScAddrVector & subActionsToApply)
+{
+  if (nestedFlows.at(nestedAction)->isFinished())
+  {
+    finishNestedAction(nestedAction, true, subActionsToApply);
+    return;
+  }
+
+  for (auto const & nestedSubAction : nestedSubActions)
+    nestedSubActionOwners[nestedSubAction] = nestedAction;
+  subActionsToApply.insert(subActionsToApply.end(), nestedSubActions.cbegin(), nestedSubActions.cend());
+}
+
+void InterpretationFlow::finishNestedAction(
+    ScAddr const & nestedAction,
+    bool isSuccessful,
+    ScAddrVector & subActionsToApply)
+{
+  auto const & nestedFlowIt = nestedFlows.find(nestedAction);
+  if (nestedFlowIt != nestedFlows.cend())
+  {
+    for (auto const & nestedSubAction : nestedFlowIt->second->getActiveSubActions())
+      nestedSubActionOwners.erase(nestedSubAction);
+    nestedFlows.erase(nestedFlowIt);
+  }
+
+  SC_LOG_DEBUG("NonAtomicActionInterpreter: nested non-atomic action finished.");
+  context->GenerateConnector(
+      ScType::ConstPermPosArc,
+      isSuccessful ? ScKeynodes::action_finished_successfully : ScKeynodes::action_finished_unsuccessfully,
+      nestedAction);
+  context->GenerateConnector(ScType::ConstPermPosArc, ScKeynodes::action_finished, nestedAction);
+  InstanceCollector::release(nestedAction);
+  completeSubAction(nestedAction, subActionsToApply);
+}
+
+void InterpretationFlow::forkBranches(
+    TransitionGraph::Node const & node,
+    std::shared_ptr<JoinGroup> const & group,
+    ScAddrVector & subActionsToApply)
+{
+  TRACE_SPAN("InterpretationFlow::forkBranches", "interpreter");
+
+  SC_LOG_DEBUG("NonAtomicActionInterpreter: forking parallel branches.");
+  std::vector<TransitionGraph::Transition const *> branches;
+  bool const isReplayed = isTakenBeforeRestart(node.forks);
+  for (auto const & fork : node.forks)
+  {
+    if (isReplayed ? isTaken(fork) : checkTransitionCondition(fork.condition))
+      branches.push_back(&fork);
+  }
+
+  auto forkGroup =
+      std::make_shared<JoinGroup>(JoinGroup{node.joinNode, node.join, node.joinArc, branches.size(), group});
+  for (auto const * branch : branches)
+  {
+    InterpretationMetrics::recordTransition(TransitionKind::Fork);
+    recordTransition(instantiate(branch->arc));
+    startBranch(branch->targetNode, branch->target, forkGroup, subActionsToApply);
+  }
+
+  if (branches.empty())
+    joinBranches(forkGroup, subActionsToApply);
+}
+
+void InterpretationFlow::completeBranch(std::shared_ptr<JoinGroup> const & group, ScAddrVector & subActionsToApply)
+{
+  if (--group->activeBranches == 0)
+    joinBranches(group, subActionsToApply);
+}
+
+void InterpretationFlow::joinBranches(std::shared_ptr<JoinGroup> const & group, ScAddrVector & subActionsToApply)
+{
+  TRACE_SPAN("InterpretationFlow::joinBranches", "interpreter");
+
+  if (group->join.IsValid())
+  {
+    SC_LOG_DEBUG("NonAtomicActionInterpreter: all parallel branches are joined.");
+    InterpretationMetrics::recordTransition(TransitionKind::Join);
+    instantiate(group->joinArc);
+    startBranch(group->joinNode, group->join, group->parent, subActionsToApply);
+  }
+  else if (group->parent)
+    completeBranch(group->parent, subActionsToApply);
+  else
+    finished = true;
+}
+
+// Only the transition that is taken is instantiated, so the other branches of a lazily instantiated non-atomic action
+// are not generated.
+bool InterpretationFlow::getNextAction(size_t & node, ScAddr const & finishedSubAction, ScAddr & nextAction)
+{
+  TRACE_SPAN("InterpretationFlow::getNextAction", "interpreter");
+
+  ActionResult const result = getActionResult(context->ConvertToAction(finishedSubAction));
+  auto const & transitions = graph->getTransitions(node, result);
+  bool const isReplayed = isTakenBeforeRestart(transitions);
+  for (auto const & transition : transitions)
+  {
+    if (isReplayed ? isTaken(transition) : checkTransitionCondition(transition.condition))
+    {
+      InterpretationMetrics::recordTransition(getTransitionKind(result));
+      recordTransition(instantiate(transition.arc));
+      node = transition.targetNode;
+      nextAction = transition.target;
+      return true;
+    }
+  }
+  return false;
+}
+
+TransitionKind InterpretationFlow::getTransitionKind(ActionResult result)
+{
+  if (result == ActionResult::Successful)
+    return TransitionKind::AfterSuccessfulAction;
+  else if (result == ActionResult::Unsuccessful)
+    return TransitionKind::AfterUnsuccessfulAction;
+
+  return TransitionKind::AfterActionWithUnknownResult;
+}
+
+ActionResult InterpretationFlow::getActionResult(ScAction const & actionAddr)
+{
+  if (actionAddr.IsFinishedSuccessfully())
+  {
+    SC_LOG_DEBUG("NonAtomicActionInterpreter: atomic action finished successfully.");
+    return ActionResult::Successful;
+  }
+  else if (actionAddr.IsFinishedUnsuccessfully())
+  {
+    SC_LOG_DEBUG("NonAtomicActionInterpreter: atomic action finished unsuccessfully.");
+    return ActionResult::Unsuccessful;
+  }
+
+  SC_LOG_DEBUG("NonAtomicActionInterpreter: atomic action finished with unknown result.");
+  return ActionResult::Unknown;
+}
+
+// Errors of incorrect conditions are reported when the conditions are checked.
+void InterpretationFlow::prefetchTransitionCondition(ScAgentContext * prefetchContext, ScAddr const & logicFormula)
+{
+  TRACE_SPAN("InterpretationFlow::prefetchTransitionCondition", "interpreter");
+
+  try
+  {
+    common::LogicUtils::PrepareLogicalFormula(prefetchContext, logicFormula);
+  }
+  catch (utils::ScException const & exception)
+  {
+    SC_LOG_DEBUG("NonAtomicActionInterpreter: failed to prefetch transition condition. " << exception.Message());
+  }
+}
+
+// Errors of incorrect templates are reported when the nested non-atomic actions are instantiated.
+void InterpretationFlow::prefetchNestedTemplate(ScAgentContext * prefetchContext, ScAddr const & templateAddr)
+{
+  TRACE_SPAN("InterpretationFlow::prefetchNestedTemplate", "interpreter");
+
+  try
+  {
+    NonAtomicActionInstantiator instantiator(prefetchContext);
+    instantiator.prefetch(templateAddr);
+  }
+  catch (utils::ScException const & exception)
+  {
+    SC_LOG_DEBUG("NonAtomicActionInterpreter: failed to prefetch nested template. " << exception.Message());
+  }
+}
+
+// Knowledge base is changed between steps only by finished sub-actions, so condition results are kept until the next
+// sub-action completes. They are keyed by the formula and the values of its variables, so a formula checked with other
+// values of its variables is checked again.
+bool InterpretationFlow::checkTransitionCondition(ScAddr const & logicFormula)
+{
+  TRACE_SPAN("InterpretationFlow::checkTransitionCondition", "interpreter");
+
+  if (!logicFormula.IsValid())
+    return true;
+
+  ConditionKey key = getConditionKey(logicFormula);
+  auto const & it = conditionResults.find(key);
+  if (it != conditionResults.cend())
+    return it->second;
+
+  auto const startTime = InterpretationMetrics::Clock::now();
+  bool const result = common::LogicUtils::CheckLogicalFormula(context, logicFormula, replacements);
+  InterpretationMetrics::recordCondition(startTime, InterpretationMetrics::Clock::now());
+  conditionResults.emplace(std::move(key), result);
+  return result;
+}
+
+InterpretationFlow::ConditionKey InterpretationFlow::getConditionKey(ScAddr const & logicFormula) const
+{
+  ScAddrUnorderedSet const & variables = common::LogicUtils::GetVariables(context, logicFormula);
+  ScAddrVector boundVariables;
+  for (auto const & variable : variables)
+  {
+    if (replacements.count(variable))
+      boundVariables.push_back(variable);
+  }
+  std::sort(boundVariables.begin(), boundVariables.end(), ScAddrLessFunc());
+
+  ConditionKey key{logicFormula, {}};
+  key.values.reserve(boundVariables.size());
+  for (auto const & variable : boundVariables)
+    key.values.push_back(replacements.find(variable)->second);
+  return key;
+}
+
+bool InterpretationFlow::ConditionKey::operator==(ConditionKey const & other) const
+{
+  return logicFormula == other.logicFormula && values == other.values;
+}
+
+size_t InterpretationFlow::ConditionKeyHashFunc::operator()(ConditionKey const & key) const
+{
+  size_t hash = ScAddrHashFunc()(key.logicFormula);
+  for (auto const & value : key.values)
+    hash = hash * 31 + ScAddrHashFunc()(value);
+  return hash;
+}
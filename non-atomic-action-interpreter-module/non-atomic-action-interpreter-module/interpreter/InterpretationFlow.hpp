@@ -0,0 +1,184 @@
+#pragma once
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <sc-memory/sc_action.hpp>
+
+#include <ps-common-lib/utils/flat_addr_map.hpp>
+
+#include "graph/TransitionGraph.hpp"
+#include "interpreter/LazyInstantiation.hpp"
+#include "metrics/InterpretationMetrics.hpp"
+
+namespace nonAtomicActionInterpreterModule
+{
+class InterpretationFlow
+{
+public:
+  InterpretationFlow(
+      ScAgentContext * context,
+      ScAddr const & nonAtomicActionAddr,
+      std::map<ScAddr, ScAddr, ScAddrLessFunc> const & replacements,
+      ScAddr const & generalAction,
+      std::chrono::steady_clock::time_point const & deadline = std::chrono::steady_clock::time_point::max(),
+      std::shared_ptr<LazyInstantiation> const & lazyInstantiation = nullptr,
+      ScAddr const & checkpoint = ScAddr::Empty);
+
+  ScAddrVector start();
+
+  ScAddrVector proceed(ScAddr const & finishedSubAction);
+
+  bool isFinished() const;
+
+  ScAddrVector getActiveSubActions() const;
+
+  bool isActive(ScAddr const & subAction) const;
+
+  ScAddr getGeneralAction() const;
+
+  std::chrono::steady_clock::time_point getDeadline(ScAddr const & subAction) const;
+
+  std::string getSubActionClass(ScAddr const & subAction) const;
+
+  void prefetch();
+
+  bool scheduleRetry(
+      ScAddr const & subAction,
+      bool isTimedOut,
+      std::chrono::steady_clock::time_point & retryTime);
+
+  void prepareRetry(ScAddr const & subAction);
+
+  void cancel();
+
+private:
+  struct JoinGroup
+  {
+    size_t joinNode;
+    ScAddr join;
+    ScAddr joinArc;
+    size_t activeBranches;
+    std::shared_ptr<JoinGroup> parent;
+  };
+
+  struct ActiveSubAction
+  {
+    size_t node;
+    std::shared_ptr<JoinGroup> group;
+  };
+
+  struct ConditionKey
+  {
+    ScAddr logicFormula;
+    // Values of the variables of the formula bound by the replacements, in the order of the variables.
+    ScAddrVector values;
+
+    bool operator==(ConditionKey const & other) const;
+  };
+
+  struct ConditionKeyHashFunc
+  {
+    size_t operator()(ConditionKey const & key) const;
+  };
+
+  ScAgentContext * context;
+  // Replacements are searched on every check of a transition condition, so they are kept flat.
+  common::FlatAddrMap replacements;
+  ScAddr generalAction;
+  std::chrono::steady_clock::time_point deadline;
+  std::shared_ptr<LazyInstantiation> lazyInstantiation;
+  ScAddr checkpoint;
+  // Ordered path of the transitions taken in the checkpoint and its last arc.
+  ScAddr path;
+  ScAddr pathEnd;
+  std::shared_ptr<TransitionGraph const> graph;
+  std::unordered_map<ScAddr, ActiveSubAction, ScAddrHashFunc> activeSubActions;
+  std::unordered_map<ScAddr, std::unique_ptr<InterpretationFlow>, ScAddrHashFunc> nestedFlows;
+  std::unordered_map<ScAddr, ScAddr, ScAddrHashFunc> nestedSubActionOwners;
+  std::unordered_map<ConditionKey, bool, ConditionKeyHashFunc> conditionResults;
+  std::unordered_set<size_t> prefetchedNodes;
+  std::unordered_map<ScAddr, size_t, ScAddrHashFunc> retryAttempts;
+  bool finished;
+  std::future<void> prefetchTask;
+
+  std::shared_ptr<TransitionGraph const> getTransitionGraph(ScAddr const & nonAtomicActionAddr);
+
+  size_t getFirstSubAction();
+
+  void checkSubAction(size_t node);
+
+  ScAddr instantiate(ScAddr const & element);
+
+  bool isRecorded(ScAddr const & subAction);
+
+  bool isCompletedBeforeRestart(ScAddr const & subAction);
+
+  void recordCheckpoint(ScAddr const & finishedSubAction);
+
+  void recordTransition(ScAddr const & transitionArc);
+
+  bool isTakenBeforeRestart(std::vector<TransitionGraph::Transition> const & transitions);
+
+  bool isTaken(TransitionGraph::Transition const & transition);
+
+  ScAddrVector replayCheckpoint(ScAddrVector const & subActions);
+
+  void startBranch(
+      size_t node,
+      ScAddr const & action,
+      std::shared_ptr<JoinGroup> const & group,
+      ScAddrVector & subActionsToApply);
+
+  void completeSubAction(ScAddr const & finishedSubAction, ScAddrVector & subActionsToApply);
+
+  bool isNestedNonAtomicAction(ScAddr const & subAction);
+
+  void startNestedFlow(ScAddr const & nestedAction, ScAddrVector & subActionsToApply);
+
+  void proceedNestedFlow(
+      ScAddr const & nestedAction,
+      ScAddr const & finishedSubAction,
+      ScAddrVector & subActionsToApply);
+
+  void addNestedSubActions(
+      ScAddr const & nestedAction,
+      ScAddrVector const & nestedSubActions,
+      ScAddrVector & subActionsToApply);
+
+  void finishNestedAction(ScAddr const & nestedAction, bool isSuccessful, ScAddrVector & subActionsToApply);
+
+  void forkBranches(
+      TransitionGraph::Node const & node,
+      std::shared_ptr<JoinGroup> const & group,
+      ScAddrVector & subActionsToApply);
+
+  void completeBranch(std::shared_ptr<JoinGroup> const & group, ScAddrVector & subActionsToApply);
+
+  void joinBranches(std::shared_ptr<JoinGroup> const & group, ScAddrVector & subActionsToApply);
+
+  bool getNextAction(size_t & node, ScAddr const & finishedSubAction, ScAddr & nextAction);
+
+  static ActionResult getActionResult(ScAction const & actionAddr);
+
+  static TransitionKind getTransitionKind(ActionResult result);
+
+  bool checkTransitionCondition(ScAddr const & logicFormula);
+
+  ConditionKey getConditionKey(ScAddr const & logicFormula) const;
+
+  void collectPrefetched(ScAddrVector & conditions, ScAddrVector & nestedTemplates);
+
+  ScAddr getNestedTemplate(ScAddr const & successor);
+
+  static void prefetchTransitionCondition(ScAgentContext * prefetchContext, ScAddr const & logicFormula);
+
+  static void prefetchNestedTemplate(ScAgentContext * prefetchContext, ScAddr const & templateAddr);
+};
+
+}  // namespace nonAtomicActionInterpreterModule
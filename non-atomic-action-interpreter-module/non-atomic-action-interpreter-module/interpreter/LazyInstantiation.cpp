@@ -0,0 +1,272 @@
+#include "LazyInstantiation.hpp"
+
+#include <list>
+
+#include <ps-common-lib/utils/compiled_template_cache.hpp>
+#include <ps-common-lib/utils/macros.hpp>
+
+#include "keynodes/NonAtomicKeynodes.hpp"
+
+using namespace nonAtomicActionInterpreterModule;
+
+// Template is indexed once and shared by all its instances, e.g. by the instances of a batch interpretation.
+std::shared_ptr<LazyInstantiation::Template const> LazyInstantiation::compileTemplate(
+    ScMemoryContext * context,
+    ScAddr const & templateAddr,
+    ScAddr const & templateKeyElement)
+{
+  auto programTemplate = std::make_shared<Template>();
+  programTemplate->keyElement = templateKeyElement;
+  programTemplate->compiledTemplate = common::CompiledTemplateCache::Get(context, templateAddr);
+  indexTemplate(context, templateAddr, *programTemplate);
+
+  ScIterator5Ptr decompositionIterator5 = context->CreateIterator5(
+      templateKeyElement,
+      ScType::VarCommonArc,
+      ScType::Unknown,
+      ScType::VarPermPosArc,
+      Keynodes::nrel_decomposition_of_action);
+  if (!decompositionIterator5->Next())
+    SC_THROW_EXCEPTION(utils::ExceptionInvalidParams, "non-atomic action template has no decomposition.");
+
+  programTemplate->decompositionTuple = decompositionIterator5->Get(2);
+  indexStructuralElements(context, *programTemplate);
+  return programTemplate;
+}
+
+LazyInstantiation::LazyInstantiation(
+    std::shared_ptr<Template const> const & programTemplate,
+    std::map<ScAddr, ScAddr, ScAddrLessFunc> const & replacements,
+    ScAddr const & keyElementReplacement)
+  : programTemplate(programTemplate)
+  , nonAtomicAction(keyElementReplacement)
+  , bindings(replacements)
+  , generatedElements({keyElementReplacement})
+{
+  bindings[programTemplate->keyElement] = keyElementReplacement;
+}
+
+ScAddr const & LazyInstantiation::getNonAtomicAction() const
+{
+  return nonAtomicAction;
+}
+
+ScAddr const & LazyInstantiation::getDecompositionTuple() const
+{
+  return programTemplate->decompositionTuple;
+}
+
+ScAddrVector const & LazyInstantiation::getGeneratedElements() const
+{
+  return generatedElements;
+}
+
+// Only the header of the non-atomic action is generated here: the key element, the decomposition tuple and the
+// arguments with their neighbourhoods. Sub-actions and transitions are generated when control flow reaches them.
+void LazyInstantiation::instantiateHeader(ScMemoryContext * context)
+{
+  expand(context, programTemplate->keyElement);
+  instantiate(context, programTemplate->decompositionTuple);
+  for (auto const & [variable, value] : bindings)
+  {
+    if (variable != programTemplate->keyElement)
+      expand(context, variable);
+  }
+}
+
+ScAddr LazyInstantiation::instantiate(ScMemoryContext * context, ScAddr const & templateElement)
+{
+  TRACE_SPAN("LazyInstantiation::instantiate", "interpreter");
+
+  if (!isVariable(templateElement))
+    return templateElement;
+
+  if (!expandedElements.count(templateElement))
+    expand(context, templateElement);
+
+  auto const & it = bindings.find(templateElement);
+  if (it == bindings.cend())
+    SC_THROW_EXCEPTION(
+        utils::ExceptionCritical, "NonAtomicActionInterpreter: failed to instantiate element of non-atomic action.");
+
+  return it->second;
+}
+
+// Instantiation of the whole template at once, so the non-atomic action is still interpreted by the shared graph of
+// its template.
+void LazyInstantiation::instantiateAll(ScMemoryContext * context)
+{
+  TRACE_SPAN("LazyInstantiation::instantiateAll", "interpreter");
+
+  ScAddrUnorderedSet connectors;
+  for (auto const & [connector, incidentElements] : programTemplate->connectorIncidentElements)
+  {
+    if (isVariable(connector) && !bindings.count(connector))
+      connectors.insert(connector);
+  }
+
+  generate(context, connectors);
+  for (auto const & [element, type] : programTemplate->elementTypes)
+    expandedElements.insert(element);
+}
+
+void LazyInstantiation::indexTemplate(
+    ScMemoryContext * context,
+    ScAddr const & templateAddr,
+    Template & programTemplate)
+{
+  ScIterator3Ptr elementsIterator3 = context->CreateIterator3(templateAddr, ScType::ConstPermPosArc, ScType::Unknown);
+  while (elementsIterator3->Next())
+  {
+    ScAddr const & element = elementsIterator3->Get(2);
+    ScType const type = context->GetElementType(element);
+    programTemplate.elementTypes.emplace(element, type);
+    if (!type.IsConnector())
+      continue;
+
+    auto const [source, target] = context->GetConnectorIncidentElements(element);
+    programTemplate.connectorIncidentElements.emplace(element, std::make_pair(source, target));
+    programTemplate.incidentConnectors[source].push_back(element);
+    programTemplate.incidentConnectors[target].push_back(element);
+  }
+}
+
+// Sub-actions of the decomposition and connectors between them are generated only on demand, the other elements of
+// the template are generated together with the first sub-action or transition that refers to them.
+void LazyInstantiation::indexStructuralElements(ScMemoryContext * context, Template & programTemplate)
+{
+  ScAddrUnorderedSet subActions;
+  ScIterator3Ptr subActionsIterator3 =
+      context->CreateIterator3(programTemplate.decompositionTuple, ScType::VarPermPosArc, ScType::Unknown);
+  while (subActionsIterator3->Next())
+    subActions.insert(subActionsIterator3->Get(2));
+
+  programTemplate.structuralElements = subActions;
+  programTemplate.structuralElements.insert(programTemplate.decompositionTuple);
+  for (auto const & [connector, incidentElements] : programTemplate.connectorIncidentElements)
+  {
+    if (subActions.count(incidentElements.first) && subActions.count(incidentElements.second))
+      programTemplate.structuralElements.insert(connector);
+  }
+}
+
+bool LazyInstantiation::isVariable(ScAddr const & templateElement) const
+{
+  auto const & it = programTemplate->elementTypes.find(templateElement);
+  return it != programTemplate->elementTypes.cend() && it->second.IsVar();
+}
+
+void LazyInstantiation::expand(ScMemoryContext * context, ScAddr const & templateElement)
+{
+  auto const & incidentElementsIt = programTemplate->connectorIncidentElements.find(templateElement);
+  if (incidentElementsIt != programTemplate->connectorIncidentElements.cend())
+  {
+    auto const [source, target] = incidentElementsIt->second;
+    instantiate(context, source);
+    instantiate(context, target);
+  }
+
+  generate(context, collectConnectors(templateElement));
+  expandedElements.insert(templateElement);
+}
+
+// Connectors are collected through the neighbourhood of the element up to bound or structural elements, then the
+// ones that refer to elements which are not generated yet are dropped.
+ScAddrUnorderedSet LazyInstantiation::collectConnectors(ScAddr const & templateElement) const
+{
+  ScAddrUnorderedSet connectors;
+  if (programTemplate->connectorIncidentElements.count(templateElement) && isVariable(templateElement)
+      && !bindings.count(templateElement))
+    connectors.insert(templateElement);
+
+  ScAddrUnorderedSet visitedElements{templateElement};
+  std::list<ScAddr> elementsToVisit{templateElement};
+  while (!elementsToVisit.empty())
+  {
+    ScAddr const element = elementsToVisit.front();
+    elementsToVisit.pop_front();
+
+    auto const & incidentConnectorsIt = programTemplate->incidentConnectors.find(element);
+    if (incidentConnectorsIt == programTemplate->incidentConnectors.cend())
+      continue;
+
+    for (auto const & connector : incidentConnectorsIt->second)
+    {
+      if (!isVariable(connector) || bindings.count(connector)
+          || programTemplate->structuralElements.count(connector))
+        continue;
+
+      connectors.insert(connector);
+      auto const & [source, target] = programTemplate->connectorIncidentElements.at(connector);
+      for (auto const & nextElement : {connector, source, target})
+      {
+        if (isVariable(nextElement) && !bindings.count(nextElement)
+            && !programTemplate->structuralElements.count(nextElement) && visitedElements.insert(nextElement).second)
+          elementsToVisit.push_back(nextElement);
+      }
+    }
+  }
+
+  bool isChanged = true;
+  while (isChanged)
+  {
+    isChanged = false;
+    for (auto it = connectors.begin(); it != connectors.end();)
+    {
+      auto const & [source, target] = programTemplate->connectorIncidentElements.at(*it);
+      if (isAvailable(source, templateElement, connectors) && isAvailable(target, templateElement, connectors))
+        ++it;
+      else
+      {
+        it = connectors.erase(it);
+        isChanged = true;
+      }
+    }
+  }
+
+  return connectors;
+}
+
+bool LazyInstantiation::isAvailable(
+    ScAddr const & templateElement,
+    ScAddr const & expandedElement,
+    ScAddrUnorderedSet const & connectors) const
+{
+  if (!isVariable(templateElement) || bindings.count(templateElement) || templateElement == expandedElement)
+    return true;
+
+  if (programTemplate->connectorIncidentElements.count(templateElement))
+    return connectors.count(templateElement);
+
+  return !programTemplate->structuralElements.count(templateElement);
+}
+
+void LazyInstantiation::generate(ScMemoryContext * context, ScAddrUnorderedSet const & connectors)
+{
+  if (connectors.empty())
+    return;
+
+  ScTemplate connectorsTemplate;
+  programTemplate->compiledTemplate->Build(
+      connectorsTemplate,
+      bindings,
+      [&connectors](ScAddr const & connector)
+      {
+        return connectors.count(connector);
+      });
+  ScTemplateGenResult templateGenResult;
+  context->GenerateByTemplate(connectorsTemplate, templateGenResult);
+
+  for (auto const & connector : connectors)
+  {
+    auto const & [source, target] = programTemplate->connectorIncidentElements.at(connector);
+    for (auto const & element : {connector, source, target})
+    {
+      if (isVariable(element) && !bindings.count(element))
+      {
+        bindings[element] = templateGenResult[common::CompiledTemplate::GetVariableAlias(element)];
+        generatedElements.push_back(bindings[element]);
+      }
+    }
+  }
+}
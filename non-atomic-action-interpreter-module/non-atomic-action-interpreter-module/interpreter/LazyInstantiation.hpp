@@ -0,0 +1,73 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+
+#include <sc-memory/sc_memory.hpp>
+
+#include <ps-common-lib/utils/compiled_template.hpp>
+
+namespace nonAtomicActionInterpreterModule
+{
+class LazyInstantiation
+{
+public:
+  struct Template
+  {
+    ScAddr keyElement;
+    ScAddr decompositionTuple;
+    std::shared_ptr<common::CompiledTemplate const> compiledTemplate;
+    std::unordered_map<ScAddr, ScType, ScAddrHashFunc> elementTypes;
+    std::unordered_map<ScAddr, std::pair<ScAddr, ScAddr>, ScAddrHashFunc> connectorIncidentElements;
+    std::unordered_map<ScAddr, ScAddrVector, ScAddrHashFunc> incidentConnectors;
+    ScAddrUnorderedSet structuralElements;
+  };
+
+  static std::shared_ptr<Template const> compileTemplate(
+      ScMemoryContext * context,
+      ScAddr const & templateAddr,
+      ScAddr const & templateKeyElement);
+
+  LazyInstantiation(
+      std::shared_ptr<Template const> const & programTemplate,
+      std::map<ScAddr, ScAddr, ScAddrLessFunc> const & replacements,
+      ScAddr const & keyElementReplacement);
+
+  ScAddr const & getNonAtomicAction() const;
+
+  ScAddr const & getDecompositionTuple() const;
+
+  ScAddrVector const & getGeneratedElements() const;
+
+  void instantiateHeader(ScMemoryContext * context);
+
+  ScAddr instantiate(ScMemoryContext * context, ScAddr const & templateElement);
+
+  void instantiateAll(ScMemoryContext * context);
+
+private:
+  std::shared_ptr<Template const> programTemplate;
+  ScAddr nonAtomicAction;
+  std::map<ScAddr, ScAddr, ScAddrLessFunc> bindings;
+  ScAddrUnorderedSet expandedElements;
+  ScAddrVector generatedElements;
+
+  static void indexTemplate(ScMemoryContext * context, ScAddr const & templateAddr, Template & programTemplate);
+
+  static void indexStructuralElements(ScMemoryContext * context, Template & programTemplate);
+
+  bool isVariable(ScAddr const & templateElement) const;
+
+  void expand(ScMemoryContext * context, ScAddr const & templateElement);
+
+  ScAddrUnorderedSet collectConnectors(ScAddr const & templateElement) const;
+
+  bool isAvailable(
+      ScAddr const & templateElement,
+      ScAddr const & expandedElement,
+      ScAddrUnorderedSet const & connectors) const;
+
+  void generate(ScMemoryContext * context, ScAddrUnorderedSet const & connectors);
+};
+
+}  // namespace nonAtomicActionInterpreterModule
@@ -0,0 +1,207 @@
+#include "NonAtomicActionInstantiator.hpp"
+
+#include <algorithm>
+
+#include <sc-agents-common/utils/IteratorUtils.hpp>
+#include <ps-common-lib/utils/compiled_template_cache.hpp>
+#include <ps-common-lib/utils/macros.hpp>
+
+#include "ArgumentBindingPlanCache.hpp"
+
+#include "collector/InstanceCollector.hpp"
+#include "keynodes/NonAtomicKeynodes.hpp"
+
+using namespace nonAtomicActionInterpreterModule;
+
+NonAtomicActionInstantiator::NonAtomicActionInstantiator(ScAgentContext * context)
+  : context(context)
+{
+}
+
+// Lazily instantiated action generates only the header of the non-atomic action here, its sub-actions are generated
+// by the interpretation flow when they are reached. Eagerly instantiated action is generated at once, but it is bound
+// to its template as well, so it is interpreted by the shared transition graph of the template. Argument variables are
+// bound by their addresses, so they don't need system identifiers.
+ScAddr NonAtomicActionInstantiator::instantiate(
+    ScAction const & action,
+    std::map<ScAddr, ScAddr, ScAddrLessFunc> & replacements,
+    std::shared_ptr<LazyInstantiation> & lazyInstantiation)
+{
+  TRACE_SPAN("NonAtomicActionInstantiator::instantiate", "interpreter");
+
+  ScAddr const & nonAtomicActionTemplateAddr = action.GetArgument(1);
+
+  SC_CHECK_PARAM(nonAtomicActionTemplateAddr, "action params are not formed correctly.");
+
+  ScAddr const & argumentsSet = action.GetArgument(2);
+  ScAddr const & templateKeyElement = getTemplateKeyElement(nonAtomicActionTemplateAddr);
+  replacements = createReplacements(templateKeyElement, argumentsSet);
+  size_t retentionTime = 0;
+  bool const isCollected = getRetentionTime(action, retentionTime);
+
+  lazyInstantiation = std::make_shared<LazyInstantiation>(
+      LazyInstantiation::compileTemplate(context, nonAtomicActionTemplateAddr, templateKeyElement),
+      replacements,
+      context->GenerateNode(ScType::ConstNode));
+  if (context->CheckConnector(Keynodes::lazily_instantiated_action, action, ScType::ConstPermPosArc))
+  {
+    SC_LOG_DEBUG("NonAtomicActionInterpreter: non-atomic action is instantiated lazily.");
+    lazyInstantiation->instantiateHeader(context);
+  }
+  else
+    lazyInstantiation->instantiateAll(context);
+
+  if (isCollected)
+    InstanceCollector::track(
+        action,
+        lazyInstantiation->getNonAtomicAction(),
+        {},
+        lazyInstantiation,
+        std::chrono::milliseconds(retentionTime));
+  return lazyInstantiation->getNonAtomicAction();
+}
+
+// Template of the batch is indexed and compiled once, and all instances are interpreted by the shared transition graph
+// of the template.
+std::vector<NonAtomicActionInstantiator::BatchInstance> NonAtomicActionInstantiator::instantiateBatch(
+    ScAction const & action)
+{
+  TRACE_SPAN("NonAtomicActionInstantiator::instantiateBatch", "interpreter");
+
+  ScAddr const & nonAtomicActionTemplateAddr = action.GetArgument(1);
+  ScAddr const & argumentsSets = action.GetArgument(2);
+
+  SC_CHECK_PARAM(nonAtomicActionTemplateAddr, "action params are not formed correctly.");
+  SC_CHECK_PARAM(argumentsSets, "action params are not formed correctly.");
+
+  ScAddr const & templateKeyElement = getTemplateKeyElement(nonAtomicActionTemplateAddr);
+  auto const & programTemplate =
+      LazyInstantiation::compileTemplate(context, nonAtomicActionTemplateAddr, templateKeyElement);
+  bool const isLazy = context->CheckConnector(Keynodes::lazily_instantiated_action, action, ScType::ConstPermPosArc);
+  size_t retentionTime = 0;
+  bool const isCollected = getRetentionTime(action, retentionTime);
+
+  std::vector<BatchInstance> instances;
+  ScIterator3Ptr argumentsSetsIterator3 =
+      context->CreateIterator3(argumentsSets, ScType::ConstPermPosArc, ScType::ConstNode);
+  while (argumentsSetsIterator3->Next())
+  {
+    BatchInstance instance;
+    instance.replacements = createReplacements(templateKeyElement, argumentsSetsIterator3->Get(2));
+    instance.instantiation = std::make_shared<LazyInstantiation>(
+        programTemplate, instance.replacements, context->GenerateNode(ScType::ConstNode));
+    if (isLazy)
+      instance.instantiation->instantiateHeader(context);
+    else
+      instance.instantiation->instantiateAll(context);
+
+    if (isCollected)
+      InstanceCollector::track(
+          action,
+          instance.instantiation->getNonAtomicAction(),
+          {},
+          instance.instantiation,
+          std::chrono::milliseconds(retentionTime));
+    instances.push_back(std::move(instance));
+  }
+
+  SC_LOG_DEBUG("NonAtomicActionInterpreter: " << instances.size() << " non-atomic actions are instantiated in batch.");
+  return instances;
+}
+
+// Compiled template and binding plan are cached by their templates, so the instantiation of a reached nested
+// non-atomic action only binds its arguments.
+void NonAtomicActionInstantiator::prefetch(ScAddr const & nonAtomicActionTemplateAddr)
+{
+  TRACE_SPAN("NonAtomicActionInstantiator::prefetch", "interpreter");
+
+  common::CompiledTemplateCache::Get(context, nonAtomicActionTemplateAddr);
+  ArgumentBindingPlanCache::get(context, getTemplateKeyElement(nonAtomicActionTemplateAddr));
+}
+
+ScAddr NonAtomicActionInstantiator::getGeneralAction(ScAddr const & action)
+{
+  return utils::IteratorUtils::getAnyByInRelation(context, action, Keynodes::nrel_subaction);
+}
+
+std::chrono::steady_clock::time_point NonAtomicActionInstantiator::getDeadline(
+    ScAction const & action,
+    ScAddr const & nonAtomicActionAddr,
+    std::chrono::steady_clock::time_point const & parentDeadline)
+{
+  size_t timeBudget = 0;
+  if (!getTimeBudget(action, nonAtomicActionAddr, timeBudget))
+    return parentDeadline;
+
+  SC_LOG_DEBUG("NonAtomicActionInterpreter: time budget is " << timeBudget << " milliseconds.");
+  return std::min(parentDeadline, std::chrono::steady_clock::now() + std::chrono::milliseconds(timeBudget));
+}
+
+// Time budget is passed as the third argument of the interpretation action or declared in the non-atomic action
+// template by nrel_time_budget relation.
+bool NonAtomicActionInstantiator::getTimeBudget(
+    ScAction const & action,
+    ScAddr const & nonAtomicActionAddr,
+    size_t & timeBudget)
+{
+  ScAddr timeBudgetLink = action.GetArgument(3);
+  if (!timeBudgetLink.IsValid())
+    timeBudgetLink =
+        utils::IteratorUtils::getAnyByOutRelation(context, nonAtomicActionAddr, Keynodes::nrel_time_budget);
+
+  return timeBudgetLink.IsValid() && context->GetElementType(timeBudgetLink).IsLink()
+         && context->GetLinkContent(timeBudgetLink, timeBudget);
+}
+
+// Instances of non-atomic actions with retention time are erased by InstanceCollector after the interpretation is
+// finished and the retention time expires.
+bool NonAtomicActionInstantiator::getRetentionTime(ScAction const & action, size_t & retentionTime)
+{
+  ScAddr const & retentionTimeLink =
+      utils::IteratorUtils::getAnyByOutRelation(context, action, Keynodes::nrel_retention_time);
+
+  return retentionTimeLink.IsValid() && context->GetElementType(retentionTimeLink).IsLink()
+         && context->GetLinkContent(retentionTimeLink, retentionTime);
+}
+
+ScAddr NonAtomicActionInstantiator::getTemplateKeyElement(ScAddr const & templateAddr)
+{
+  ScAddr templateKeyElement =
+      utils::IteratorUtils::getAnyByOutRelation(context, templateAddr, ScKeynodes::rrel_key_sc_element);
+
+  if (!templateKeyElement.IsValid())
+  {
+    SC_THROW_EXCEPTION(utils::ExceptionInvalidParams, "template key element not found.");
+  }
+
+  return templateKeyElement;
+}
+
+// Arguments set is scanned once and joined with the cached binding plan of the template. Arguments are bound in the
+// order of their roles up to the first missing one.
+std::map<ScAddr, ScAddr, ScAddrLessFunc> NonAtomicActionInstantiator::createReplacements(
+    ScAddr const & templateKeyElement,
+    ScAddr const & argumentsSet)
+{
+  std::map<ScAddr, ScAddr, ScAddrLessFunc> replacements;
+  if (!argumentsSet.IsValid())
+    return replacements;
+
+  std::unordered_map<ScAddr, ScAddr, ScAddrHashFunc> argumentsByRoles;
+  ScIterator5Ptr argumentsIterator5 = context->CreateIterator5(
+      argumentsSet, ScType::ConstPermPosArc, ScType::Unknown, ScType::ConstPermPosArc, ScType::ConstNodeRole);
+  while (argumentsIterator5->Next())
+    argumentsByRoles.emplace(argumentsIterator5->Get(4), argumentsIterator5->Get(2));
+
+  for (auto const & [role, variable] : *ArgumentBindingPlanCache::get(context, templateKeyElement))
+  {
+    auto const & it = argumentsByRoles.find(role);
+    if (it == argumentsByRoles.cend())
+      break;
+
+    if (variable.IsValid())
+      replacements[variable] = it->second;
+  }
+
+  return replacements;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+
+#include <sc-memory/sc_action.hpp>
+
+#include "LazyInstantiation.hpp"
+
+namespace nonAtomicActionInterpreterModule
+{
+class NonAtomicActionInstantiator
+{
+public:
+  struct BatchInstance
+  {
+    std::map<ScAddr, ScAddr, ScAddrLessFunc> replacements;
+    std::shared_ptr<LazyInstantiation> instantiation;
+  };
+
+  explicit NonAtomicActionInstantiator(ScAgentContext * context);
+
+  ScAddr instantiate(
+      ScAction const & action,
+      std::map<ScAddr, ScAddr, ScAddrLessFunc> & replacements,
+      std::shared_ptr<LazyInstantiation> & lazyInstantiation);
+
+  std::vector<BatchInstance> instantiateBatch(ScAction const & action);
+
+  void prefetch(ScAddr const & nonAtomicActionTemplateAddr);
+
+  ScAddr getGeneralAction(ScAddr const & action);
+
+  std::chrono::steady_clock::time_point getDeadline(
+      ScAction const & action,
+      ScAddr const & nonAtomicActionAddr,
+      std::chrono::steady_clock::time_point const & parentDeadline = std::chrono::steady_clock::time_point::max());
+
+private:
+  ScAgentContext * context;
+
+  std::map<ScAddr, ScAddr, ScAddrLessFunc> createReplacements(
+      ScAddr const & templateKeyElement,
+      ScAddr const & argumentsSet);
+
+  ScAddr getTemplateKeyElement(ScAddr const & templateAddr);
+
+  bool getTimeBudget(ScAction const & action, ScAddr const & nonAtomicActionAddr, size_t & timeBudget);
+
+  bool getRetentionTime(ScAction const & action, size_t & retentionTime);
+};
+
+}  // namespace nonAtomicActionInterpreterModule
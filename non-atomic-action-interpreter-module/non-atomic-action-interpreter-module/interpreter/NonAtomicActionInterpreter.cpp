@@ -2,202 +2,315 @@
 
 #include <algorithm>
 
-#include <sc-agents-common/utils/IteratorUtils.hpp>
 #include <ps-common-lib/action_cancelled_exception.hpp>
-#include <ps-common-lib/utils/logic_utils.hpp>
-#include <ps-common-lib/utils/template_params_utils.hpp>
 #include <ps-common-lib/utils/macros.hpp>
 
 #include "constants/NonAtomicActionInterpreterConstants.hpp"
 #include "keynodes/NonAtomicKeynodes.hpp"
+#include "metrics/InterpretationMetrics.hpp"
 
 using namespace nonAtomicActionInterpreterModule;
 
 NonAtomicActionInterpreter::NonAtomicActionInterpreter(ScAgentContext * context)
   : context(context)
+  , isCancelled(false)
 {
 }
 
 void NonAtomicActionInterpreter::interpret(
     ScAddr const & nonAtomicActionAddr,
     std::map<ScAddr, ScAddr, ScAddrLessFunc> const & replacements,
-    ScAddr const & generalAction)
+    ScAddr const & generalAction,
+    std::chrono::steady_clock::time_point const & deadline,
+    std::shared_ptr<LazyInstantiation> const & lazyInstantiation,
+    ScAddr const & checkpoint)
 {
-  ScAddr decompositionTuple =
-      utils::IteratorUtils::getAnyByOutRelation(context, nonAtomicActionAddr, Keynodes::nrel_decomposition_of_action);
-  ScAction action = getFirstSubAction(decompositionTuple);
-  bool hasActionToApply = context->IsElement(action);
-  while (hasActionToApply)
-  {
-    if (context->CheckConnector(decompositionTuple, action, ScType::ConstPermPosArc) == SC_FALSE)
-      SC_THROW_EXCEPTION(
-          utils::ExceptionCritical,
-          "NonAtomicActionInterpreter: action is not belongs to non-atomic action decomposition.");
-
-    if (context->CheckConnector(Keynodes::action_cancelled, generalAction, ScType::ConstPermPosArc))
-      SC_THROW_EXCEPTION(
-          common::ActionCancelledException,
-          "NonAtomicActionInterpreter: the processing action of the current non-atomic action has been interrupted.");
-
-    applyAction(action);
-    hasActionToApply = getNextAction(action, replacements);
-  }
+  std::vector<std::unique_ptr<InterpretationFlow>> flows;
+  flows.push_back(std::make_unique<InterpretationFlow>(
+      context, nonAtomicActionAddr, replacements, generalAction, deadline, lazyInstantiation, checkpoint));
+  std::exception_ptr const error = interpret(flows, generalAction).front();
+  if (error)
+    std::rethrow_exception(error);
 }
 
-ScAction NonAtomicActionInterpreter::getFirstSubAction(ScAddr const & decompositionTuple)
+// Flows of a batch are interpreted together: sub-actions of all flows are initiated without waiting for each other, and
+// a failure of one flow doesn't stop the others. Returned vector contains the error of each failed flow.
+std::vector<std::exception_ptr> NonAtomicActionInterpreter::interpret(
+    std::vector<std::unique_ptr<InterpretationFlow>> const & flows,
+    ScAddr const & generalAction)
 {
-  ScAddr firstAction = utils::IteratorUtils::getAnyByOutRelation(context, decompositionTuple, ScKeynodes::rrel_1);
-  if (!firstAction.IsValid())
+  pendingSubActions.clear();
+  pendingSubActionsCounts.assign(flows.size(), 0);
+  flowErrors.assign(flows.size(), nullptr);
   {
-    SC_THROW_EXCEPTION(
-        utils::ExceptionCritical, "Non-atomic action structure is incorrect. Failed to find first action.");
+    std::lock_guard<std::mutex> lock(finishedSubActionsMutex);
+    finishedSubActions.clear();
+    isCancelled = false;
   }
-  return context->ConvertToAction(firstAction);
-}
 
-void NonAtomicActionInterpreter::applyAction(ScAction & actionAddr)
-{
-  SC_LOG_DEBUG("NonAtomicActionInterpreter: waiting for atomic action finish.");
-  if (!actionAddr.InitiateAndWait(NonAtomicActionInterpreterConstants::INTERPRETER_ACTION_WAIT_TIME))
+  std::shared_ptr<ScEventSubscription> const cancellationSubscription = subscribeToCancellation(generalAction);
+  for (size_t flowIndex = 0; flowIndex < flows.size(); flowIndex++)
   {
-    SC_THROW_EXCEPTION(utils::ExceptionCritical, "NonAtomicActionInterpreter: action wait time expired.");
+    try
+    {
+      applyActions(*flows[flowIndex], flowIndex, flows[flowIndex]->start());
+      flows[flowIndex]->prefetch();
+    }
+    catch (utils::ScException const &)
+    {
+      failFlow(flowIndex, std::current_exception());
+    }
   }
-  SC_LOG_DEBUG("NonAtomicActionInterpreter: atomic action finished.");
-}
-
-bool NonAtomicActionInterpreter::getNextAction(
-    ScAction & actionAddr,
-    std::map<ScAddr, ScAddr, ScAddrLessFunc> const & replacements)
-{
-  ScAddrList orderedTransitionCandidates = getOrderedTransitionCandidates(actionAddr);
 
-  ScAddr nextAction;
-  for (auto const & transitionArc : orderedTransitionCandidates)
+  while (hasUnfinishedFlows(flows))
   {
-    if (checkTransitionCondition(transitionArc, replacements))
+    size_t flowIndex = 0;
+    ScAddr const & subActionAddr = waitForFinishedSubAction(flows, flowIndex);
+    if (!subActionAddr.IsValid())
+      continue;
+
+    try
+    {
+      std::chrono::steady_clock::time_point retryTime;
+      if (flows[flowIndex]->scheduleRetry(subActionAddr, false, retryTime))
+        delayRetry(flowIndex, subActionAddr, retryTime);
+      else
+      {
+        applyActions(*flows[flowIndex], flowIndex, flows[flowIndex]->proceed(subActionAddr));
+        flows[flowIndex]->prefetch();
+      }
+    }
+    catch (utils::ScException const &)
     {
-      nextAction = context->GetArcTargetElement(transitionArc);
-      actionAddr = context->ConvertToAction(nextAction);
-      return true;
+      failFlow(flowIndex, std::current_exception());
     }
   }
-  return false;
+
+  return flowErrors;
 }
 
-ScAddrList NonAtomicActionInterpreter::getOrderedTransitionCandidates(ScAction const & actionAddr)
+// Cancellation of the general action interrupts waiting for sub-actions immediately instead of being noticed only
+// before the next sub-action.
+std::shared_ptr<ScEventSubscription> NonAtomicActionInterpreter::subscribeToCancellation(ScAddr const & generalAction)
 {
-  bool actionIsSuccessful = false;
-  bool actionIsUnsuccessful = false;
-  if (actionAddr.IsFinishedSuccessfully())
-  {
-    SC_LOG_DEBUG("NonAtomicActionInterpreter: atomic action finished successfully.");
-    actionIsSuccessful = true;
-  }
-  else if (actionAddr.IsFinishedUnsuccessfully())
-  {
-    SC_LOG_DEBUG("NonAtomicActionInterpreter: atomic action finished unsuccessfully.");
-    actionIsUnsuccessful = true;
-  }
-  else
-    SC_LOG_DEBUG("NonAtomicActionInterpreter: atomic action finished with unknown result.");
+  using ActionCancelledEvent = ScEventAfterGenerateIncomingArc<ScType::ConstPermPosArc>;
 
-  ScAddrList orderedTransitionCandidates =
-      getOrderedTransitionCandidatesFromSequence(actionAddr, actionIsSuccessful, actionIsUnsuccessful);
+  if (!generalAction.IsValid())
+    return nullptr;
 
-  updateTransitionCandidatesWithTheCandidatesNotFromSequence(
-      orderedTransitionCandidates, actionAddr, actionIsSuccessful, actionIsUnsuccessful);
+  return context->CreateElementaryEventSubscription<ActionCancelledEvent>(
+      generalAction,
+      [this](ActionCancelledEvent const & event)
+      {
+        if (event.GetArcSourceElement() != Keynodes::action_cancelled)
+          return;
 
-  return orderedTransitionCandidates;
+        std::lock_guard<std::mutex> lock(finishedSubActionsMutex);
+        isCancelled = true;
+        finishedSubActionsChanged.notify_all();
+      });
 }
 
-ScAddrList NonAtomicActionInterpreter::getOrderedTransitionCandidatesFromSequence(
-    ScAddr const & actionAddr,
-    bool const & actionIsSuccessful,
-    bool const & actionIsUnsuccessful)
+void NonAtomicActionInterpreter::applyActions(
+    InterpretationFlow const & flow,
+    size_t flowIndex,
+    ScAddrVector const & subActions)
 {
-  ScAddrList orderedTransitionCandidates;
+  TRACE_SPAN("NonAtomicActionInterpreter::applyActions", "interpreter");
 
-  ScAddr transitionArc = getPriorityTransitionArc(actionAddr);
-  while (transitionArc.IsValid())
+  using ActionFinishedEvent = ScEventAfterGenerateIncomingArc<ScType::ConstPermPosArc>;
+
+  for (auto const & subActionAddr : subActions)
   {
-    bool const successCaseTransitionPossibility =
-        actionIsSuccessful && context->CheckConnector(Keynodes::nrel_then, transitionArc, ScType::ConstPermPosArc);
-    bool const unsuccessCaseTransitionPossibility =
-        actionIsUnsuccessful && context->CheckConnector(Keynodes::nrel_else, transitionArc, ScType::ConstPermPosArc);
-    bool const unconditionalTransitionPossibility =
-        context->CheckConnector(Keynodes::nrel_goto, transitionArc, ScType::ConstPermPosArc);
+    PendingSubAction & pendingSubAction = pendingSubActions[subActionAddr];
+    pendingSubAction.flowIndex = flowIndex;
+    pendingSubAction.isRetry = false;
+    pendingSubAction.subActionClass = flow.getSubActionClass(subActionAddr);
+    pendingSubActionsCounts[flowIndex]++;
+    pendingSubAction.deadline = std::min(
+        flow.getDeadline(subActionAddr),
+        std::chrono::steady_clock::now()
+            + std::chrono::milliseconds(NonAtomicActionInterpreterConstants::INTERPRETER_ACTION_WAIT_TIME));
+    pendingSubAction.subscription = context->CreateElementaryEventSubscription<ActionFinishedEvent>(
+        subActionAddr,
+        [this, subActionAddr](ActionFinishedEvent const & event)
+        {
+          if (event.GetArcSourceElement() != ScKeynodes::action_finished)
+            return;
 
-    if (successCaseTransitionPossibility || unsuccessCaseTransitionPossibility || unconditionalTransitionPossibility)
-      orderedTransitionCandidates.push_back(transitionArc);
+          std::lock_guard<std::mutex> lock(finishedSubActionsMutex);
+          finishedSubActions.emplace_back(subActionAddr, std::chrono::steady_clock::now());
+          finishedSubActionsChanged.notify_all();
+        });
 
-    transitionArc = utils::IteratorUtils::getAnyByOutRelation(context, transitionArc, Keynodes::nrel_basic_sequence);
+    SC_LOG_DEBUG("NonAtomicActionInterpreter: waiting for atomic action finish.");
+    pendingSubAction.initiationTime = std::chrono::steady_clock::now();
+    context->ConvertToAction(subActionAddr).Initiate();
   }
-
-  return orderedTransitionCandidates;
 }
 
-void NonAtomicActionInterpreter::updateTransitionCandidatesWithTheCandidatesNotFromSequence(
-    ScAddrList & orderedTransitionCandidates,
-    ScAddr const & actionAddr,
-    bool const & actionIsSuccessful,
-    bool const & actionIsUnsuccessful)
+bool NonAtomicActionInterpreter::hasUnfinishedFlows(std::vector<std::unique_ptr<InterpretationFlow>> const & flows)
 {
-  if (actionIsSuccessful)
-  {
-    updateTransitionsByRelation(actionAddr, Keynodes::nrel_then, orderedTransitionCandidates);
-  }
-  else if (actionIsUnsuccessful)
+  bool hasUnfinishedFlows = false;
+  for (size_t flowIndex = 0; flowIndex < flows.size(); flowIndex++)
   {
-    updateTransitionsByRelation(actionAddr, Keynodes::nrel_else, orderedTransitionCandidates);
-  }
+    if (flowErrors[flowIndex] || flows[flowIndex]->isFinished())
+      continue;
+
+    if (pendingSubActionsCounts[flowIndex] == 0)
+    {
+      try
+      {
+        SC_THROW_EXCEPTION(utils::ExceptionCritical, "NonAtomicActionInterpreter: there are no actions to wait for.");
+      }
+      catch (utils::ScException const &)
+      {
+        failFlow(flowIndex, std::current_exception());
+      }
+      continue;
+    }
 
-  updateTransitionsByRelation(actionAddr, Keynodes::nrel_goto, orderedTransitionCandidates);
+    hasUnfinishedFlows = true;
+  }
+  return hasUnfinishedFlows;
 }
 
-void NonAtomicActionInterpreter::updateTransitionsByRelation(
-    ScAddr const & action,
-    ScAddr const & relation,
-    ScAddrList & transitions)
+void NonAtomicActionInterpreter::failFlow(size_t flowIndex, std::exception_ptr const & error)
 {
-  ScAddrList transitionArcs = getAllArcsByOutRelation(action, relation);
-  for (auto const & arc : transitionArcs)
+  flowErrors[flowIndex] = error;
+  for (auto it = pendingSubActions.begin(); it != pendingSubActions.end();)
   {
-    if (std::find(transitions.begin(), transitions.end(), arc) == transitions.end())
-      transitions.push_back(arc);
+    if (it->second.flowIndex == flowIndex)
+      it = pendingSubActions.erase(it);
+    else
+      ++it;
   }
+  pendingSubActionsCounts[flowIndex] = 0;
+}
+
+// Retry waits in the pending sub-actions until its retry time, so its backoff is waited together with the deadlines of
+// the other sub-actions instead of blocking the interpretation.
+void NonAtomicActionInterpreter::delayRetry(
+    size_t flowIndex,
+    ScAddr const & subActionAddr,
+    std::chrono::steady_clock::time_point const & retryTime)
+{
+  PendingSubAction & pendingSubAction = pendingSubActions[subActionAddr];
+  pendingSubAction.subscription.reset();
+  pendingSubAction.deadline = retryTime;
+  pendingSubAction.flowIndex = flowIndex;
+  pendingSubAction.isRetry = true;
+  pendingSubActionsCounts[flowIndex]++;
 }
 
-ScAddr NonAtomicActionInterpreter::getPriorityTransitionArc(ScAddr const & node)
+// Delayed retry is initiated again when its retry time comes. Expired sub-action is retried if its retry policy
+// allows it, otherwise its flow fails. Returns false if the flow failed.
+bool NonAtomicActionInterpreter::processExpiredSubAction(
+    std::vector<std::unique_ptr<InterpretationFlow>> const & flows,
+    ScAddr const & subActionAddr,
+    PendingSubAction const & expiredSubAction)
 {
-  ScAddr arcAddr;
+  size_t const flowIndex = expiredSubAction.flowIndex;
+  InterpretationFlow & flow = *flows[flowIndex];
+  if (flowErrors[flowIndex] || !flow.isActive(subActionAddr))
+    return true;
 
-  ScIterator5Ptr priorityArcIterator = context->CreateIterator5(
-      node, ScType::ConstCommonArc, ScType::ConstNode, ScType::ConstPermPosArc, Keynodes::nrel_priority_path);
-  if (priorityArcIterator->Next())
+  try
+  {
+    std::chrono::steady_clock::time_point retryTime;
+    if (expiredSubAction.isRetry)
+    {
+      SC_LOG_DEBUG("NonAtomicActionInterpreter: initiating atomic action again.");
+      flow.prepareRetry(subActionAddr);
+      applyActions(flow, flowIndex, {subActionAddr});
+    }
+    else if (flow.scheduleRetry(subActionAddr, true, retryTime))
+      delayRetry(flowIndex, subActionAddr, retryTime);
+    else
+    {
+      flow.cancel();
+      SC_THROW_EXCEPTION(utils::ExceptionCritical, "NonAtomicActionInterpreter: action wait time expired.");
+    }
+  }
+  catch (utils::ScException const &)
   {
-    arcAddr = priorityArcIterator->Get(1);
+    failFlow(flowIndex, std::current_exception());
+    return false;
   }
-  return arcAddr;
+  return true;
 }
 
-ScAddrList NonAtomicActionInterpreter::getAllArcsByOutRelation(ScAddr const & node, ScAddr const & relation)
+// Returns empty address if no sub-action is finished, but some flow failed because its active sub-action expired.
+ScAddr NonAtomicActionInterpreter::waitForFinishedSubAction(
+    std::vector<std::unique_ptr<InterpretationFlow>> const & flows,
+    size_t & flowIndex)
 {
-  ScAddrList arcs;
-  ScIterator5Ptr iterator5 = utils::IteratorUtils::getIterator5(context, node, relation, true);
-  while (iterator5->Next())
+  TRACE_SPAN("NonAtomicActionInterpreter::waitForFinishedSubAction", "interpreter");
+
+  std::unique_lock<std::mutex> lock(finishedSubActionsMutex);
+  while (finishedSubActions.empty() || isCancelled)
   {
-    arcs.push_back(iterator5->Get(1));
+    if (isCancelled)
+    {
+      lock.unlock();
+      for (auto const & flow : flows)
+        flow->cancel();
+      pendingSubActions.clear();
+      SC_THROW_EXCEPTION(
+          common::ActionCancelledException,
+          "NonAtomicActionInterpreter: the processing action of the current non-atomic action has been interrupted.");
+    }
+
+    if (pendingSubActions.empty())
+      SC_THROW_EXCEPTION(utils::ExceptionCritical, "NonAtomicActionInterpreter: there are no actions to wait for.");
+
+    auto nearestDeadline = std::chrono::steady_clock::time_point::max();
+    for (auto const & [subActionAddr, pendingSubAction] : pendingSubActions)
+      nearestDeadline = std::min(nearestDeadline, pendingSubAction.deadline);
+
+    if (finishedSubActionsChanged.wait_until(lock, nearestDeadline) == std::cv_status::timeout
+        && finishedSubActions.empty() && !isCancelled)
+    {
+      lock.unlock();
+      auto const now = std::chrono::steady_clock::now();
+      std::list<std::pair<ScAddr, PendingSubAction>> expiredSubActions;
+      for (auto it = pendingSubActions.begin(); it != pendingSubActions.end();)
+      {
+        if (it->second.deadline > now)
+          ++it;
+        else
+        {
+          pendingSubActionsCounts[it->second.flowIndex]--;
+          expiredSubActions.emplace_back(it->first, std::move(it->second));
+          it = pendingSubActions.erase(it);
+        }
+      }
+
+      bool isFlowFailed = false;
+      for (auto const & [subActionAddr, expiredSubAction] : expiredSubActions)
+      {
+        if (!processExpiredSubAction(flows, subActionAddr, expiredSubAction))
+          isFlowFailed = true;
+      }
+      if (isFlowFailed)
+        return ScAddr::Empty;
+      lock.lock();
+    }
   }
-  return arcs;
-}
 
-bool NonAtomicActionInterpreter::checkTransitionCondition(
-    ScAddr const & transitionArc,
-    std::map<ScAddr, ScAddr, ScAddrLessFunc> const & replacements)
-{
-  ScAddr logicFormula = utils::IteratorUtils::getAnyByOutRelation(context, transitionArc, Keynodes::nrel_condition);
-  if (!logicFormula.IsValid())
-    return true;
+  auto const [subActionAddr, finishTime] = finishedSubActions.front();
+  finishedSubActions.pop_front();
+  lock.unlock();
 
-  return common::LogicUtils::CheckLogicalFormula(context, logicFormula, replacements);
+  auto const & it = pendingSubActions.find(subActionAddr);
+  if (it == pendingSubActions.cend() || it->second.isRetry)
+    return ScAddr::Empty;
+
+  InterpretationMetrics::recordSubAction(
+      it->second.subActionClass, it->second.initiationTime, finishTime, std::chrono::steady_clock::now());
+  flowIndex = it->second.flowIndex;
+  pendingSubActionsCounts[flowIndex]--;
+  pendingSubActions.erase(it);
+  SC_LOG_DEBUG("NonAtomicActionInterpreter: atomic action finished.");
+  return subActionAddr;
 }
@@ -1,7 +1,17 @@
 #pragma once
 
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
 #include <sc-memory/sc_action.hpp>
 
+#include "InterpretationFlow.hpp"
+
 namespace nonAtomicActionInterpreterModule
 {
 class NonAtomicActionInterpreter
@@ -12,39 +22,54 @@ public:
   void interpret(
       ScAddr const & nonAtomicActionAddr,
       std::map<ScAddr, ScAddr, ScAddrLessFunc> const & replacements,
+      ScAddr const & generalAction,
+      std::chrono::steady_clock::time_point const & deadline = std::chrono::steady_clock::time_point::max(),
+      std::shared_ptr<LazyInstantiation> const & lazyInstantiation = nullptr,
+      ScAddr const & checkpoint = ScAddr::Empty);
+
+  std::vector<std::exception_ptr> interpret(
+      std::vector<std::unique_ptr<InterpretationFlow>> const & flows,
       ScAddr const & generalAction);
 
 private:
-  ScAgentContext * context;
+  struct PendingSubAction
+  {
+    std::shared_ptr<ScEventSubscription> subscription;
+    std::chrono::steady_clock::time_point deadline;
+    size_t flowIndex;
+    std::string subActionClass;
+    std::chrono::steady_clock::time_point initiationTime;
+    bool isRetry = false;
+  };
 
-  ScAction getFirstSubAction(ScAddr const & decompositionTuple);
-
-  static void applyAction(ScAction & actionAddr);
-
-  bool getNextAction(ScAction & actionAddr, std::map<ScAddr, ScAddr, ScAddrLessFunc> const & replacements);
+  ScAgentContext * context;
+  std::mutex finishedSubActionsMutex;
+  std::condition_variable finishedSubActionsChanged;
+  std::list<std::pair<ScAddr, std::chrono::steady_clock::time_point>> finishedSubActions;
+  bool isCancelled;
+  std::unordered_map<ScAddr, PendingSubAction, ScAddrHashFunc> pendingSubActions;
+  std::vector<size_t> pendingSubActionsCounts;
+  std::vector<std::exception_ptr> flowErrors;
 
-  ScAddrList getOrderedTransitionCandidates(ScAction const & actionAddr);
+  std::shared_ptr<ScEventSubscription> subscribeToCancellation(ScAddr const & generalAction);
 
-  ScAddrList getOrderedTransitionCandidatesFromSequence(
-      ScAddr const & actionAddr,
-      bool const & actionIsSuccessful,
-      bool const & actionIsUnsuccessful);
+  void applyActions(InterpretationFlow const & flow, size_t flowIndex, ScAddrVector const & subActions);
 
-  void updateTransitionCandidatesWithTheCandidatesNotFromSequence(
-      ScAddrList & orderedTransitionCandidates,
-      ScAddr const & actionAddr,
-      bool const & actionIsSuccessful,
-      bool const & actionIsUnsuccessful);
+  bool hasUnfinishedFlows(std::vector<std::unique_ptr<InterpretationFlow>> const & flows);
 
-  void updateTransitionsByRelation(ScAddr const & action, ScAddr const & relation, ScAddrList & transitions);
+  void failFlow(size_t flowIndex, std::exception_ptr const & error);
 
-  ScAddr getPriorityTransitionArc(ScAddr const & node);
+  void delayRetry(
+      size_t flowIndex,
+      ScAddr const & subActionAddr,
+      std::chrono::steady_clock::time_point const & retryTime);
 
-  ScAddrList getAllArcsByOutRelation(ScAddr const & node, ScAddr const & relation);
+  bool processExpiredSubAction(
+      std::vector<std::unique_ptr<InterpretationFlow>> const & flows,
+      ScAddr const & subActionAddr,
+      PendingSubAction const & expiredSubAction);
 
-  bool checkTransitionCondition(
-      ScAddr const & transitionArc,
-      std::map<ScAddr, ScAddr, ScAddrLessFunc> const & replacements);
+  ScAddr waitForFinishedSubAction(std::vector<std::unique_ptr<InterpretationFlow>> const & flows, size_t & flowIndex);
 };
 
 }  // namespace nonAtomicActionInterpreterModule
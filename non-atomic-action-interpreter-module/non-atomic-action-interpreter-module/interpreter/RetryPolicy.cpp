@@ -0,0 +1,72 @@
+#include "RetryPolicy.hpp"
+
+#include <algorithm>
+
+#include <sc-agents-common/utils/IteratorUtils.hpp>
+
+#include "constants/NonAtomicActionInterpreterConstants.hpp"
+#include "keynodes/NonAtomicKeynodes.hpp"
+
+using namespace nonAtomicActionInterpreterModule;
+
+// Retry policy is declared for a sub-action by nrel_retry_policy relation. Outcomes to retry are the classes of the
+// policy, a policy without them retries only timed-out attempts.
+bool RetryPolicy::get(ScMemoryContext * context, ScAddr const & subAction, RetryPolicy & policy)
+{
+  ScAddr const & policyAddr =
+      utils::IteratorUtils::getAnyByOutRelation(context, subAction, Keynodes::nrel_retry_policy);
+  if (!policyAddr.IsValid())
+    return false;
+
+  policy.maxAttempts = getParameter(
+      context,
+      policyAddr,
+      Keynodes::nrel_max_attempts,
+      NonAtomicActionInterpreterConstants::DEFAULT_RETRY_MAX_ATTEMPTS);
+  policy.initialBackoff = std::chrono::milliseconds(getParameter(
+      context,
+      policyAddr,
+      Keynodes::nrel_initial_backoff,
+      NonAtomicActionInterpreterConstants::DEFAULT_RETRY_INITIAL_BACKOFF));
+  policy.backoffMultiplier = getParameter(
+      context,
+      policyAddr,
+      Keynodes::nrel_backoff_multiplier,
+      NonAtomicActionInterpreterConstants::DEFAULT_RETRY_BACKOFF_MULTIPLIER);
+  policy.isTimeoutRetryable =
+      context->CheckConnector(Keynodes::retry_on_timeout, policyAddr, ScType::ConstPermPosArc);
+  policy.isUnsuccessfulFinishRetryable =
+      context->CheckConnector(Keynodes::retry_on_unsuccessful_finish, policyAddr, ScType::ConstPermPosArc);
+  if (!policy.isTimeoutRetryable && !policy.isUnsuccessfulFinishRetryable)
+    policy.isTimeoutRetryable = true;
+  return true;
+}
+
+bool RetryPolicy::isRetryable(bool isTimedOut) const
+{
+  return isTimedOut ? isTimeoutRetryable : isUnsuccessfulFinishRetryable;
+}
+
+// Backoff before the attempt grows by the multiplier after each attempt up to the maximal backoff, multiplier 1 gives
+// constant backoff.
+std::chrono::milliseconds RetryPolicy::getBackoff(size_t attempt) const
+{
+  size_t const maxBackoff = NonAtomicActionInterpreterConstants::MAX_RETRY_BACKOFF;
+  size_t backoff = std::min<size_t>(initialBackoff.count(), maxBackoff);
+  for (size_t index = 0; index < attempt && backoff < maxBackoff; index++)
+    backoff = std::min(backoff * std::max<size_t>(backoffMultiplier, 1), maxBackoff);
+  return std::chrono::milliseconds(backoff);
+}
+
+size_t RetryPolicy::getParameter(
+    ScMemoryContext * context,
+    ScAddr const & policyAddr,
+    ScAddr const & relation,
+    size_t defaultValue)
+{
+  ScAddr const & parameterLink = utils::IteratorUtils::getAnyByOutRelation(context, policyAddr, relation);
+  size_t parameter = defaultValue;
+  if (parameterLink.IsValid() && context->GetElementType(parameterLink).IsLink())
+    context->GetLinkContent(parameterLink, parameter);
+  return parameter;
+}
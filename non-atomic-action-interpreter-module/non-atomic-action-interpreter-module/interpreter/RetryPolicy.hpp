@@ -0,0 +1,32 @@
+#pragma once
+
+#include <chrono>
+
+#include <sc-memory/sc_memory.hpp>
+
+namespace nonAtomicActionInterpreterModule
+{
+class RetryPolicy
+{
+public:
+  size_t maxAttempts;
+  std::chrono::milliseconds initialBackoff;
+  size_t backoffMultiplier;
+  bool isTimeoutRetryable;
+  bool isUnsuccessfulFinishRetryable;
+
+  static bool get(ScMemoryContext * context, ScAddr const & subAction, RetryPolicy & policy);
+
+  bool isRetryable(bool isTimedOut) const;
+
+  std::chrono::milliseconds getBackoff(size_t attempt) const;
+
+private:
+  static size_t getParameter(
+      ScMemoryContext * context,
+      ScAddr const & policyAddr,
+      ScAddr const & relation,
+      size_t defaultValue);
+};
+
+}  // namespace nonAtomicActionInterpreterModule
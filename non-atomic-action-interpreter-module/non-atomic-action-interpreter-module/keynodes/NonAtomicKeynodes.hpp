@@ -22,6 +22,10 @@ public:
 
   static inline ScKeynode const nrel_condition{"nrel_condition"};
 
+  static inline ScKeynode const nrel_fork{"nrel_fork"};
+
+  static inline ScKeynode const nrel_join{"nrel_join"};
+
   static inline ScKeynode const nrel_priority_path{"nrel_priority_path"};
 
   static inline ScKeynode const nrel_basic_sequence{"nrel_basic_sequence"};
@@ -29,6 +33,38 @@ public:
   static inline ScKeynode const action_cancelled{"action_cancelled"};
 
   static inline ScKeynode const nrel_subaction{"nrel_subaction"};
+
+  static inline ScKeynode const nrel_time_budget{"nrel_time_budget"};
+
+  static inline ScKeynode const asynchronously_interpreted_action{"asynchronously_interpreted_action"};
+
+  static inline ScKeynode const lazily_instantiated_action{"lazily_instantiated_action"};
+
+  static inline ScKeynode const batch_interpreted_action{"batch_interpreted_action"};
+
+  static inline ScKeynode const nrel_retention_time{"nrel_retention_time"};
+
+  static inline ScKeynode const action_with_execution_summary{"action_with_execution_summary"};
+
+  static inline ScKeynode const nrel_execution_summary{"nrel_execution_summary"};
+
+  static inline ScKeynode const action_with_checkpoints{"action_with_checkpoints"};
+
+  static inline ScKeynode const nrel_interpretation_checkpoint{"nrel_interpretation_checkpoint"};
+
+  static inline ScKeynode const nrel_interpretation_priority{"nrel_interpretation_priority"};
+
+  static inline ScKeynode const nrel_retry_policy{"nrel_retry_policy"};
+
+  static inline ScKeynode const nrel_max_attempts{"nrel_max_attempts"};
+
+  static inline ScKeynode const nrel_initial_backoff{"nrel_initial_backoff"};
+
+  static inline ScKeynode const nrel_backoff_multiplier{"nrel_backoff_multiplier"};
+
+  static inline ScKeynode const retry_on_timeout{"retry_on_timeout"};
+
+  static inline ScKeynode const retry_on_unsuccessful_finish{"retry_on_unsuccessful_finish"};
 };
 
 }  // namespace nonAtomicActionInterpreterModule
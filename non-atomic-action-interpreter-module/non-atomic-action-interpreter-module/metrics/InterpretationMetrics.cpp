@@ -0,0 +1,271 @@
+#include "InterpretationMetrics.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <unordered_set>
+
+#include <ps-common-lib/utils/tracer.hpp>
+
+#include "keynodes/NonAtomicKeynodes.hpp"
+
+using namespace nonAtomicActionInterpreterModule;
+
+namespace
+{
+char const * const METRICS_FILE_PATH_VARIABLE = "NON_ATOMIC_ACTION_INTERPRETER_METRICS_FILE";
+}  // namespace
+
+// Sub-action is a sub-action of a template, or of an instance if its flow has no template, so its class is searched
+// once per template and every applied sub-action is recorded by the cached class.
+std::string InterpretationMetrics::getSubActionClass(ScMemoryContext * context, ScAddr const & subAction)
+{
+  {
+    std::lock_guard<std::mutex> lock(classIdentifiersMutex);
+    auto const & it = subActionClasses.find(subAction);
+    if (it != subActionClasses.cend())
+      return it->second;
+  }
+
+  std::string const subActionClass = findSubActionClass(context, subAction);
+  std::lock_guard<std::mutex> lock(classIdentifiersMutex);
+  return subActionClasses.emplace(subAction, subActionClass).first->second;
+}
+
+// Wait time is counted from the initiation of the sub-action to its finish, queueing delay is counted from the finish
+// of the sub-action to its processing by the interpretation flow.
+void InterpretationMetrics::recordSubAction(
+    std::string const & subActionClass,
+    Clock::time_point const & initiationTime,
+    Clock::time_point const & finishTime,
+    Clock::time_point const & processingTime)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  histograms["sub_action_wait_time{class=\"" + subActionClass + "\"}"].add(
+      toMicroseconds(finishTime - initiationTime));
+  histograms["sub_action_queueing_delay{class=\"" + subActionClass + "\"}"].add(
+      toMicroseconds(processingTime - finishTime));
+  common::Tracer::RecordInterval("sub_action", "interpreter", initiationTime, finishTime);
+  common::Tracer::RecordInterval("sub_action_queueing", "interpreter", finishTime, processingTime);
+}
+
+// Conditions, transitions and retries are recorded on every step of all flows, so they are counted by preallocated
+// atomics instead of the maps guarded by the mutex.
+void InterpretationMetrics::recordCondition(Clock::time_point const & startTime, Clock::time_point const & endTime)
+{
+  conditionEvaluationTime.add(toMicroseconds(endTime - startTime));
+}
+
+void InterpretationMetrics::recordTransition(TransitionKind transitionKind)
+{
+  transitionsTaken[static_cast<size_t>(transitionKind)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void InterpretationMetrics::recordRetry(bool isTimedOut)
+{
+  (isTimedOut ? retriesAfterTimeout : retriesAfterUnsuccessfulFinish).fetch_add(1, std::memory_order_relaxed);
+}
+
+void InterpretationMetrics::recordCounter(std::string const & name)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  counters[name]++;
+}
+
+void InterpretationMetrics::recordDuration(
+    std::string const & name,
+    Clock::time_point const & startTime,
+    Clock::time_point const & endTime)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  histograms[name].add(toMicroseconds(endTime - startTime));
+}
+
+// Atomic metrics are exported together with the other ones, only if they are recorded.
+void InterpretationMetrics::exportMetrics(std::ostream & stream)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  std::map<std::string, uint64_t> exportedCounters = counters;
+  for (size_t kind = 0; kind < TRANSITION_KINDS_COUNT; kind++)
+  {
+    if (uint64_t const value = transitionsTaken[kind].load(std::memory_order_relaxed))
+      exportedCounters[std::string("transitions_taken{kind=\"")
+                       + getTransitionKindName(static_cast<TransitionKind>(kind)) + "\"}"] += value;
+  }
+  if (uint64_t const value = retriesAfterTimeout.load(std::memory_order_relaxed))
+    exportedCounters["retries_after_timeout"] += value;
+  if (uint64_t const value = retriesAfterUnsuccessfulFinish.load(std::memory_order_relaxed))
+    exportedCounters["retries_after_unsuccessful_finish"] += value;
+
+  std::map<std::string, Histogram> exportedHistograms = histograms;
+  Histogram const conditionHistogram = conditionEvaluationTime.load();
+  if (conditionHistogram.count)
+    exportedHistograms["condition_evaluation_time"] = conditionHistogram;
+
+  for (auto const & [name, value] : exportedCounters)
+    stream << name << " " << value << "\n";
+
+  for (auto const & [name, histogram] : exportedHistograms)
+  {
+    stream << name << " count=" << histogram.count << " sum_us=" << histogram.sum
+           << " min_us=" << (histogram.count ? histogram.min : 0) << " max_us=" << histogram.max
+           << " p50_us<=" << histogram.getPercentile(0.5) << " p90_us<=" << histogram.getPercentile(0.9)
+           << " p99_us<=" << histogram.getPercentile(0.99) << "\n";
+  }
+}
+
+// Histograms and counters are always collected, they are exported to the metrics file only if it is requested. Spans
+// of the interpretation are traced by common::Tracer.
+void InterpretationMetrics::exportToFiles()
+{
+  if (char const * const metricsFilePath = std::getenv(METRICS_FILE_PATH_VARIABLE))
+  {
+    std::ofstream metricsFile(metricsFilePath);
+    exportMetrics(metricsFile);
+  }
+}
+
+void InterpretationMetrics::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  histograms.clear();
+  counters.clear();
+  conditionEvaluationTime.reset();
+  for (auto & transitionsCount : transitionsTaken)
+    transitionsCount = 0;
+  retriesAfterTimeout = 0;
+  retriesAfterUnsuccessfulFinish = 0;
+
+  std::lock_guard<std::mutex> classIdentifiersLock(classIdentifiersMutex);
+  classIdentifiers.clear();
+  subActionClasses.clear();
+}
+
+void InterpretationMetrics::Histogram::add(uint64_t duration)
+{
+  buckets[getBucket(duration)]++;
+  count++;
+  sum += duration;
+  min = std::min(min, duration);
+  max = std::max(max, duration);
+}
+
+// Percentile is estimated by the upper bound of the bucket that contains it.
+uint64_t InterpretationMetrics::Histogram::getPercentile(double percentile) const
+{
+  uint64_t accumulatedCount = 0;
+  for (size_t bucket = 0; bucket < buckets.size(); bucket++)
+  {
+    accumulatedCount += buckets[bucket];
+    if (accumulatedCount > 0 && accumulatedCount >= percentile * count)
+      return std::min(max, uint64_t(1) << bucket);
+  }
+  return max;
+}
+
+// Minimum and maximum are updated by compare-and-swap, so concurrent records don't lose each other.
+void InterpretationMetrics::AtomicHistogram::add(uint64_t duration)
+{
+  buckets[getBucket(duration)].fetch_add(1, std::memory_order_relaxed);
+  count.fetch_add(1, std::memory_order_relaxed);
+  sum.fetch_add(duration, std::memory_order_relaxed);
+
+  uint64_t currentMin = min.load(std::memory_order_relaxed);
+  while (duration < currentMin && !min.compare_exchange_weak(currentMin, duration, std::memory_order_relaxed))
+    ;
+  uint64_t currentMax = max.load(std::memory_order_relaxed);
+  while (duration > currentMax && !max.compare_exchange_weak(currentMax, duration, std::memory_order_relaxed))
+    ;
+}
+
+// Snapshot may be taken during concurrent records, so its fields are consistent only up to those records.
+InterpretationMetrics::Histogram InterpretationMetrics::AtomicHistogram::load() const
+{
+  Histogram histogram;
+  for (size_t bucket = 0; bucket < buckets.size(); bucket++)
+    histogram.buckets[bucket] = buckets[bucket].load(std::memory_order_relaxed);
+  histogram.count = count.load(std::memory_order_relaxed);
+  histogram.sum = sum.load(std::memory_order_relaxed);
+  histogram.min = min.load(std::memory_order_relaxed);
+  histogram.max = max.load(std::memory_order_relaxed);
+  return histogram;
+}
+
+void InterpretationMetrics::AtomicHistogram::reset()
+{
+  for (auto & bucket : buckets)
+    bucket = 0;
+  count = 0;
+  sum = 0;
+  min = UINT64_MAX;
+  max = 0;
+}
+
+size_t InterpretationMetrics::getBucket(uint64_t duration)
+{
+  size_t bucket = 0;
+  while (bucket + 1 < BUCKETS_COUNT && duration >= (uint64_t(1) << bucket))
+    bucket++;
+  return bucket;
+}
+
+char const * InterpretationMetrics::getTransitionKindName(TransitionKind transitionKind)
+{
+  switch (transitionKind)
+  {
+  case TransitionKind::Fork:
+    return "fork";
+  case TransitionKind::Join:
+    return "join";
+  case TransitionKind::AfterSuccessfulAction:
+    return "after_successful_action";
+  case TransitionKind::AfterUnsuccessfulAction:
+    return "after_unsuccessful_action";
+  default:
+    return "after_action_with_unknown_result";
+  }
+}
+
+uint64_t InterpretationMetrics::toMicroseconds(Clock::duration const & duration)
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+// Sub-actions of the same classes are applied repeatedly, so identifiers of their classes are memoized. Unnamed classes
+// are memoized with empty identifiers.
+std::string InterpretationMetrics::getClassIdentifier(ScMemoryContext * context, ScAddr const & subActionClass)
+{
+  std::lock_guard<std::mutex> lock(classIdentifiersMutex);
+  auto const & it = classIdentifiers.find(subActionClass);
+  if (it != classIdentifiers.cend())
+    return it->second;
+
+  return classIdentifiers.emplace(subActionClass, context->GetElementSystemIdentifier(subActionClass)).first->second;
+}
+
+// Sub-action class is the first named class of the sub-action except the general action class and the action states.
+// Classes of a template sub-action are connected by variable arcs, so arcs of any constancy are searched.
+std::string InterpretationMetrics::findSubActionClass(ScMemoryContext * context, ScAddr const & subAction)
+{
+  static std::unordered_set<ScAddr, ScAddrHashFunc> const ignoredClasses = {
+      ScKeynodes::action,
+      ScKeynodes::action_initiated,
+      ScKeynodes::action_finished,
+      ScKeynodes::action_finished_successfully,
+      ScKeynodes::action_finished_unsuccessfully,
+      Keynodes::action_cancelled};
+
+  ScIterator3Ptr classesIterator3 = context->CreateIterator3(ScType::ConstNode, ScType::PermPosArc, subAction);
+  while (classesIterator3->Next())
+  {
+    ScAddr const & subActionClass = classesIterator3->Get(0);
+    if (ignoredClasses.count(subActionClass))
+      continue;
+
+    std::string const identifier = getClassIdentifier(context, subActionClass);
+    if (!identifier.empty())
+      return identifier;
+  }
+  return "unknown";
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+#include <sc-memory/sc_memory.hpp>
+
+namespace nonAtomicActionInterpreterModule
+{
+enum class TransitionKind : size_t
+{
+  Fork = 0,
+  Join = 1,
+  AfterSuccessfulAction = 2,
+  AfterUnsuccessfulAction = 3,
+  AfterActionWithUnknownResult = 4
+};
+
+class InterpretationMetrics
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  static std::string getSubActionClass(ScMemoryContext * context, ScAddr const & subAction);
+
+  static void recordSubAction(
+      std::string const & subActionClass,
+      Clock::time_point const & initiationTime,
+      Clock::time_point const & finishTime,
+      Clock::time_point const & processingTime);
+
+  static void recordCondition(Clock::time_point const & startTime, Clock::time_point const & endTime);
+
+  static void recordTransition(TransitionKind transitionKind);
+
+  static void recordRetry(bool isTimedOut);
+
+  static void recordCounter(std::string const & name);
+
+  static void recordDuration(
+      std::string const & name,
+      Clock::time_point const & startTime,
+      Clock::time_point const & endTime);
+
+  static void exportMetrics(std::ostream & stream);
+
+  static void exportToFiles();
+
+  static void clear();
+
+private:
+  static constexpr size_t BUCKETS_COUNT = 32;
+
+  // Bucket i counts durations shorter than 2^i microseconds, the last bucket counts all longer durations.
+  struct Histogram
+  {
+    std::array<uint64_t, BUCKETS_COUNT> buckets{};
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t min = UINT64_MAX;
+    uint64_t max = 0;
+
+    void add(uint64_t duration);
+
+    uint64_t getPercentile(double percentile) const;
+  };
+
+  // Histogram of a fixed key that is recorded on the hot path without locks.
+  struct AtomicHistogram
+  {
+    std::array<std::atomic<uint64_t>, BUCKETS_COUNT> buckets{};
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> min{UINT64_MAX};
+    std::atomic<uint64_t> max{0};
+
+    void add(uint64_t duration);
+
+    Histogram load() const;
+
+    void reset();
+  };
+
+  static size_t const TRANSITION_KINDS_COUNT = 5;
+
+  static inline std::mutex mutex;
+  static inline std::mutex classIdentifiersMutex;
+  static inline std::unordered_map<ScAddr, std::string, ScAddrHashFunc> classIdentifiers;
+  static inline std::unordered_map<ScAddr, std::string, ScAddrHashFunc> subActionClasses;
+  static inline std::map<std::string, Histogram> histograms;
+  static inline std::map<std::string, uint64_t> counters;
+  static inline AtomicHistogram conditionEvaluationTime;
+  static inline std::array<std::atomic<uint64_t>, TRANSITION_KINDS_COUNT> transitionsTaken{};
+  static inline std::atomic<uint64_t> retriesAfterTimeout{0};
+  static inline std::atomic<uint64_t> retriesAfterUnsuccessfulFinish{0};
+
+  static size_t getBucket(uint64_t duration);
+
+  static char const * getTransitionKindName(TransitionKind transitionKind);
+
+  static uint64_t toMicroseconds(Clock::duration const & duration);
+
+  static std::string getClassIdentifier(ScMemoryContext * context, ScAddr const & subActionClass);
+
+  static std::string findSubActionClass(ScMemoryContext * context, ScAddr const & subAction);
+};
+
+}  // namespace nonAtomicActionInterpreterModule
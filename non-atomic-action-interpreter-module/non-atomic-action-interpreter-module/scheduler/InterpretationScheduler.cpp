@@ -0,0 +1,205 @@
+#include "InterpretationScheduler.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+#include <sc-agents-common/utils/IteratorUtils.hpp>
+
+#include <ps-common-lib/utils/macros.hpp>
+
+#include "constants/NonAtomicActionInterpreterConstants.hpp"
+#include "interpreter/AsyncNonAtomicActionInterpreter.hpp"
+#include "keynodes/NonAtomicKeynodes.hpp"
+#include "metrics/InterpretationMetrics.hpp"
+
+using namespace nonAtomicActionInterpreterModule;
+
+namespace
+{
+char const * const CONCURRENCY_CAP_VARIABLE = "NON_ATOMIC_ACTION_INTERPRETER_CONCURRENCY_CAP";
+}  // namespace
+
+// Action that doesn't fit in the concurrency cap is queued by its priority and stays initiated until a slot is freed,
+// so it doesn't occupy a thread while waiting.
+Admission InterpretationScheduler::admit(ScMemoryContext * context, ScAddr const & action)
+{
+  TRACE_SPAN("InterpretationScheduler::admit", "interpreter");
+
+  size_t const priority = getPriority(context, action);
+  std::string const priorityLabel = "{priority=\"" + std::to_string(priority) + "\"}";
+  std::lock_guard<std::mutex> lock(mutex);
+  if (hasFreeSlot())
+  {
+    runningActions.insert(action);
+    InterpretationMetrics::recordCounter("interpretations_admitted" + priorityLabel);
+    return Admission::Admitted;
+  }
+
+  if (queuedActionsCount >= NonAtomicActionInterpreterConstants::MAX_QUEUED_INTERPRETATIONS)
+  {
+    SC_LOG_WARNING("NonAtomicActionInterpreter: interpretation queue is full, action is rejected.");
+    InterpretationMetrics::recordCounter("interpretations_rejected" + priorityLabel);
+    return Admission::Rejected;
+  }
+
+  SC_LOG_DEBUG("NonAtomicActionInterpreter: concurrency cap is reached, action is queued.");
+  PriorityQueue & queue = queues[priority];
+  if (queue.actions.empty())
+    queue.pass = std::max(queue.pass, virtualTime);
+  queue.actions.push_back({action, std::chrono::steady_clock::now()});
+  queuedActionsCount++;
+  InterpretationMetrics::recordCounter("interpretations_queued" + priorityLabel);
+  return Admission::Queued;
+}
+
+void InterpretationScheduler::release(ScAgentContext * context, ScAddr const & action)
+{
+  TRACE_SPAN("InterpretationScheduler::release", "interpreter");
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!runningActions.erase(action))
+      return;
+  }
+  interpretQueued(context);
+}
+
+// Queue is kept only in memory and queued actions have no checkpoints, so they can't be resumed after the restart of
+// the machine. They are finished unsuccessfully instead of staying initiated forever.
+void InterpretationScheduler::shutdown(ScAgentContext * context)
+{
+  ScAddrVector waitingActions;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto const & [priority, queue] : queues)
+    {
+      for (auto const & queuedAction : queue.actions)
+        waitingActions.push_back(queuedAction.action);
+    }
+  }
+  clear();
+
+  for (auto const & action : waitingActions)
+  {
+    if (!isWaiting(context, action))
+      continue;
+
+    try
+    {
+      context->ConvertToAction(action).FinishUnsuccessfully();
+    }
+    catch (utils::ScException const & exception)
+    {
+      SC_LOG_WARNING("NonAtomicActionInterpreter: failed to finish queued action. " << exception.Message());
+    }
+  }
+}
+
+void InterpretationScheduler::setConcurrencyCap(size_t cap)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  concurrencyCap = cap;
+}
+
+// Concurrency isn't limited if the cap isn't set.
+void InterpretationScheduler::initialize()
+{
+  if (char const * const cap = std::getenv(CONCURRENCY_CAP_VARIABLE))
+    setConcurrencyCap(std::strtoul(cap, nullptr, 10));
+}
+
+void InterpretationScheduler::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  runningActions.clear();
+  queues.clear();
+  queuedActionsCount = 0;
+  virtualTime = 0;
+}
+
+// Priority is a non-negative number in the link of nrel_interpretation_priority relation, the default priority is 0.
+size_t InterpretationScheduler::getPriority(ScMemoryContext * context, ScAddr const & action)
+{
+  ScAddr const & priorityLink =
+      utils::IteratorUtils::getAnyByOutRelation(context, action, Keynodes::nrel_interpretation_priority);
+  size_t priority = 0;
+  if (priorityLink.IsValid() && context->GetElementType(priorityLink).IsLink())
+    context->GetLinkContent(priorityLink, priority);
+  return priority;
+}
+
+bool InterpretationScheduler::hasFreeSlot()
+{
+  return concurrencyCap == 0 || runningActions.size() < concurrencyCap;
+}
+
+// Next queued action takes the freed slot before it is checked, so the slot isn't taken by another action meanwhile.
+// Admitted action is handed to the asynchronous interpreter directly, because initiating it again would trigger other
+// agents reacting to its initiation. Queued actions that are erased, finished or cancelled while waiting are dropped.
+void InterpretationScheduler::interpretQueued(ScAgentContext * context)
+{
+  while (true)
+  {
+    ScAddr nextAction;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!hasFreeSlot())
+        return;
+
+      nextAction = dequeue();
+      if (!nextAction.IsValid())
+        return;
+
+      runningActions.insert(nextAction);
+    }
+
+    if (isWaiting(context, nextAction))
+    {
+      SC_LOG_DEBUG("NonAtomicActionInterpreter: interpreting queued action.");
+      ScAction action = context->ConvertToAction(nextAction);
+      AsyncNonAtomicActionInterpreter::interpretAdmitted(context, action);
+      return;
+    }
+
+    SC_LOG_DEBUG("NonAtomicActionInterpreter: queued action is not waiting anymore, it is dropped.");
+    std::lock_guard<std::mutex> lock(mutex);
+    runningActions.erase(nextAction);
+  }
+}
+
+bool InterpretationScheduler::isWaiting(ScMemoryContext * context, ScAddr const & action)
+{
+  return context->IsElement(action)
+         && !context->CheckConnector(ScKeynodes::action_finished, action, ScType::ConstPermPosArc)
+         && !context->CheckConnector(Keynodes::action_cancelled, action, ScType::ConstPermPosArc);
+}
+
+// Queues of priorities are served by stride scheduling: each dequeued action advances the pass of its queue
+// inversely to the priority weight, and the queue with the smallest pass is served next. So higher priorities get
+// proportionally more slots, and lower priorities aren't starved.
+ScAddr InterpretationScheduler::dequeue()
+{
+  auto selectedQueueIt = queues.end();
+  for (auto it = queues.begin(); it != queues.end(); ++it)
+  {
+    if (!it->second.actions.empty()
+        && (selectedQueueIt == queues.end() || it->second.pass <= selectedQueueIt->second.pass))
+      selectedQueueIt = it;
+  }
+
+  if (selectedQueueIt == queues.end())
+    return ScAddr::Empty;
+
+  auto & [priority, queue] = *selectedQueueIt;
+  QueuedAction const queuedAction = queue.actions.front();
+  queue.actions.pop_front();
+  queuedActionsCount--;
+  virtualTime = queue.pass;
+  queue.pass += 1.0 / (priority + 1);
+  InterpretationMetrics::recordDuration(
+      "interpretation_queueing_time{priority=\"" + std::to_string(priority) + "\"}",
+      queuedAction.queueingTime,
+      std::chrono::steady_clock::now());
+  return queuedAction.action;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <list>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <sc-memory/sc_agent_context.hpp>
+
+namespace nonAtomicActionInterpreterModule
+{
+enum class Admission : size_t
+{
+  Admitted = 0,
+  Queued = 1,
+  Rejected = 2
+};
+
+class InterpretationScheduler
+{
+public:
+  static Admission admit(ScMemoryContext * context, ScAddr const & action);
+
+  static void release(ScAgentContext * context, ScAddr const & action);
+
+  static void shutdown(ScAgentContext * context);
+
+  static void setConcurrencyCap(size_t cap);
+
+  static void initialize();
+
+  static void clear();
+
+private:
+  struct QueuedAction
+  {
+    ScAddr action;
+    std::chrono::steady_clock::time_point queueingTime;
+  };
+
+  struct PriorityQueue
+  {
+    std::list<QueuedAction> actions;
+    double pass = 0;
+  };
+
+  static inline std::mutex mutex;
+  static inline size_t concurrencyCap = 0;
+  static inline std::unordered_set<ScAddr, ScAddrHashFunc> runningActions;
+  static inline std::map<size_t, PriorityQueue> queues;
+  static inline size_t queuedActionsCount = 0;
+  static inline double virtualTime = 0;
+
+  static size_t getPriority(ScMemoryContext * context, ScAddr const & action);
+
+  static bool hasFreeSlot();
+
+  static void interpretQueued(ScAgentContext * context);
+
+  static bool isWaiting(ScMemoryContext * context, ScAddr const & action);
+
+  static ScAddr dequeue();
+};
+
+}  // namespace nonAtomicActionInterpreterModule
@@ -0,0 +1,307 @@
+#include <fstream>
+
+#include <unistd.h>
+
+#include <benchmark/benchmark.h>
+
+#include <sc-memory/sc_memory.hpp>
+#include <sc-memory/sc_agent_context.hpp>
+
+#include <ps-common-lib/keynodes.hpp>
+#include <ps-common-lib/utils/compiled_template_cache.hpp>
+#include <ps-common-lib/utils/logic_utils.hpp>
+
+#include "agent/NonAtomicActionInterpreterAgent.hpp"
+#include "collector/InstanceCollector.hpp"
+#include "graph/TransitionGraphCache.hpp"
+#include "interpreter/ArgumentBindingPlanCache.hpp"
+#include "interpreter/AsyncNonAtomicActionInterpreter.hpp"
+#include "keynodes/NonAtomicKeynodes.hpp"
+#include "metrics/InterpretationMetrics.hpp"
+#include "scheduler/InterpretationScheduler.hpp"
+#include "agent/ActionFinishedTestAgent.hpp"
+#include "keynodes/TestKeynodes.hpp"
+
+using namespace nonAtomicActionInterpreterModule;
+using namespace nonAtomicActionInterpreterModuleTest;
+
+namespace nonAtomicActionInterpreterModuleBenchmark
+{
+int const WAIT_TIME = 60000;
+
+// Number of steps in sequence, number of parallel branches between two steps, percent of transitions with conditions
+// and depth of nested non-atomic actions. The last step of a non-atomic action is a nested non-atomic action of the
+// same shape while the depth allows it.
+struct ProgramShape
+{
+  size_t length;
+  size_t branchingFactor;
+  size_t conditionDensity;
+  size_t nestingDepth;
+};
+
+// Generates the program of a synthetic non-atomic action as the scs test structures declare it. All atomic steps are
+// performed by ActionFinishedTestAgent, so the measured time is the time of the interpreter itself.
+class ProgramGenerator
+{
+public:
+  ProgramGenerator(ScAgentContext & context, ProgramShape const & shape)
+    : context(context)
+    , shape(shape)
+    , condition(generateCondition())
+    , stepsCount(0)
+    , transitionsCount(0)
+  {
+  }
+
+  ScAddr generate()
+  {
+    return generate(shape.nestingDepth);
+  }
+
+  size_t getStepsCount() const
+  {
+    return stepsCount;
+  }
+
+private:
+  struct Program
+  {
+    ScAddr structure;
+    ScAddrUnorderedSet elements;
+  };
+
+  ScAgentContext & context;
+  ProgramShape shape;
+  ScAddr condition;
+  size_t stepsCount;
+  size_t transitionsCount;
+
+  // Condition is always true, so each conditional transition is taken after its template is found.
+  ScAddr generateCondition()
+  {
+    ScAddr const & set = context.GenerateNode(ScType::ConstNode);
+    context.GenerateConnector(ScType::ConstPermPosArc, set, context.GenerateNode(ScType::ConstNode));
+
+    ScAddr const & conditionAddr = context.GenerateNode(ScType::ConstNodeStructure);
+    ScAddr const & element = context.GenerateNode(ScType::VarNode);
+    ScAddr const & arc = context.GenerateConnector(ScType::VarPermPosArc, set, element);
+    for (auto const & conditionElement : {set, element, arc})
+      context.GenerateConnector(ScType::ConstPermPosArc, conditionAddr, conditionElement);
+    context.GenerateConnector(ScType::ConstPermPosArc, common::Keynodes::atomic_logical_formula, conditionAddr);
+    return conditionAddr;
+  }
+
+  ScAddr generate(size_t depth)
+  {
+    Program program{context.GenerateNode(ScType::ConstNodeStructure), {}};
+    ScAddr const & nonAtomicAction = addElement(program, context.GenerateNode(ScType::VarNode));
+    addArc(program, ScType::VarPermPosArc, ScKeynodes::action, nonAtomicAction);
+    ScAddr const & decompositionTuple = addElement(program, context.GenerateNode(ScType::VarNodeTuple));
+    addRelationPair(
+        program, ScType::VarCommonArc, nonAtomicAction, decompositionTuple, Keynodes::nrel_decomposition_of_action);
+
+    ScAddr step = addStep(program, decompositionTuple, true, shape.length == 1 ? depth : 0);
+    for (size_t index = 1; index < shape.length; index++)
+    {
+      ScAddr const & nextStep =
+          addStep(program, decompositionTuple, false, index + 1 == shape.length ? depth : 0);
+      if (shape.branchingFactor > 1)
+      {
+        for (size_t branchIndex = 0; branchIndex < shape.branchingFactor; branchIndex++)
+        {
+          ScAddr const & branch = addStep(program, decompositionTuple, false, 0);
+          addRelationPair(program, ScType::VarCommonArc, step, branch, Keynodes::nrel_fork);
+          addTransition(program, branch, nextStep);
+        }
+        addRelationPair(program, ScType::VarCommonArc, step, nextStep, Keynodes::nrel_join);
+      }
+      else
+        addTransition(program, step, nextStep);
+      step = nextStep;
+    }
+
+    ScAddr const & keyElementArc =
+        context.GenerateConnector(ScType::ConstPermPosArc, program.structure, nonAtomicAction);
+    context.GenerateConnector(ScType::ConstPermPosArc, ScKeynodes::rrel_key_sc_element, keyElementArc);
+    return program.structure;
+  }
+
+  // Step of the depth greater than zero is a nested non-atomic action, it is interpreted inline and its own steps are
+  // counted.
+  ScAddr addStep(Program & program, ScAddr const & decompositionTuple, bool isFirst, size_t depth)
+  {
+    ScAddr const & subAction = addElement(program, context.GenerateNode(ScType::VarNode));
+    addArc(program, ScType::VarPermPosArc, ScKeynodes::action, subAction);
+    ScAddr const & subActionArc = addArc(program, ScType::VarPermPosArc, decompositionTuple, subAction);
+    if (isFirst)
+      addArc(program, ScType::VarPermPosArc, ScKeynodes::rrel_1, subActionArc);
+
+    if (depth == 0)
+    {
+      addArc(program, ScType::VarPermPosArc, TestKeynodes::finished_test_action, subAction);
+      stepsCount++;
+      return subAction;
+    }
+
+    addArc(program, ScType::VarPermPosArc, Keynodes::action_interpret_non_atomic_action, subAction);
+    ScAddr const & nestedProgram = generate(depth - 1);
+    ScAddr const & nestedProgramArc = addArc(program, ScType::VarPermPosArc, subAction, nestedProgram);
+    addArc(program, ScType::VarPermPosArc, ScKeynodes::rrel_1, nestedProgramArc);
+    return subAction;
+  }
+
+  void addTransition(Program & program, ScAddr const & source, ScAddr const & target)
+  {
+    ScAddr const & transition = addRelationPair(program, ScType::VarCommonArc, source, target, Keynodes::nrel_goto);
+    if ((transitionsCount++ * shape.conditionDensity) % 100 < shape.conditionDensity)
+      addRelationPair(program, ScType::VarCommonArc, transition, condition, Keynodes::nrel_condition);
+  }
+
+  ScAddr addRelationPair(
+      Program & program,
+      ScType const & type,
+      ScAddr const & source,
+      ScAddr const & target,
+      ScAddr const & relation)
+  {
+    ScAddr const & arc = addArc(program, type, source, target);
+    addArc(program, ScType::VarPermPosArc, relation, arc);
+    return arc;
+  }
+
+  ScAddr addArc(Program & program, ScType const & type, ScAddr const & source, ScAddr const & target)
+  {
+    addElement(program, source);
+    addElement(program, target);
+    return addElement(program, context.GenerateConnector(type, source, target));
+  }
+
+  ScAddr addElement(Program & program, ScAddr const & element)
+  {
+    if (program.elements.insert(element).second)
+      context.GenerateConnector(ScType::ConstPermPosArc, program.structure, element);
+    return element;
+  }
+};
+
+size_t getResidentSetSize()
+{
+  size_t programSize = 0;
+  size_t residentPagesCount = 0;
+  std::ifstream statm("/proc/self/statm");
+  statm >> programSize >> residentPagesCount;
+  return residentPagesCount * sysconf(_SC_PAGESIZE);
+}
+
+// Instances of the non-atomic action are not collected, so memory growth shows how much memory one interpretation
+// leaves in the knowledge base and in the interpreter.
+void interpretSyntheticProgram(benchmark::State & state, bool isAsynchronous)
+{
+  ScAgentContext context;
+  ProgramShape const shape{
+      static_cast<size_t>(state.range(0)),
+      static_cast<size_t>(state.range(1)),
+      static_cast<size_t>(state.range(2)),
+      static_cast<size_t>(state.range(3))};
+  ProgramGenerator generator(context, shape);
+  ScAddr const & program = generator.generate();
+
+  size_t stepsCount = 0;
+  size_t const initialResidentSetSize = getResidentSetSize();
+  for (auto _ : state)
+  {
+    ScAction action = context.GenerateAction(Keynodes::action_interpret_non_atomic_action);
+    action.SetArguments(program);
+    if (isAsynchronous)
+      context.GenerateConnector(ScType::ConstPermPosArc, Keynodes::asynchronously_interpreted_action, action);
+
+    if (!action.InitiateAndWait(WAIT_TIME) || !action.IsFinishedSuccessfully())
+    {
+      state.SkipWithError("Non-atomic action is not interpreted successfully.");
+      break;
+    }
+    stepsCount += generator.getStepsCount();
+  }
+  size_t const residentSetSize = getResidentSetSize();
+
+  state.counters["steps_per_second"] = benchmark::Counter(stepsCount, benchmark::Counter::kIsRate);
+  state.counters["step_overhead"] =
+      benchmark::Counter(stepsCount, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+  state.counters["memory_growth"] = benchmark::Counter(
+      residentSetSize > initialResidentSetSize ? residentSetSize - initialResidentSetSize : 0,
+      benchmark::Counter::kAvgIterations,
+      benchmark::Counter::kIs1024);
+}
+
+void BM_InterpretSynchronously(benchmark::State & state)
+{
+  interpretSyntheticProgram(state, false);
+}
+
+void BM_InterpretAsynchronously(benchmark::State & state)
+{
+  interpretSyntheticProgram(state, true);
+}
+
+void applyProgramShapes(benchmark::internal::Benchmark * benchmark)
+{
+  benchmark->ArgNames({"length", "branching", "conditions", "depth"});
+  benchmark->Args({10, 1, 0, 0});
+  benchmark->Args({100, 1, 0, 0});
+  benchmark->Args({1000, 1, 0, 0});
+  benchmark->Args({10, 4, 0, 0});
+  benchmark->Args({10, 16, 0, 0});
+  benchmark->Args({100, 1, 50, 0});
+  benchmark->Args({100, 1, 100, 0});
+  benchmark->Args({10, 1, 0, 2});
+  benchmark->Args({10, 4, 50, 2});
+  benchmark->Unit(benchmark::kMillisecond);
+  benchmark->UseRealTime();
+}
+
+BENCHMARK(BM_InterpretSynchronously)->Apply(applyProgramShapes);
+
+BENCHMARK(BM_InterpretAsynchronously)->Apply(applyProgramShapes);
+
+}  // namespace nonAtomicActionInterpreterModuleBenchmark
+
+int main(int argc, char ** argv)
+{
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+
+  sc_memory_params params;
+  sc_memory_params_clear(&params);
+  params.clear = SC_TRUE;
+  params.storage = "non-atomic-action-interpreter-module-benchmarks-db";
+  params.log_type = "Console";
+  params.log_file = "";
+  params.log_level = "Error";
+  params.user_mode = SC_FALSE;
+  params.dump_memory = SC_FALSE;
+  params.dump_memory_statistics = SC_FALSE;
+  ScMemory::Initialize(params);
+
+  {
+    ScAgentContext context;
+    context.SubscribeAgent<NonAtomicActionInterpreterAgent>();
+    context.SubscribeAgent<ActionFinishedTestAgent>();
+    benchmark::RunSpecifiedBenchmarks();
+    context.UnsubscribeAgent<NonAtomicActionInterpreterAgent>();
+    context.UnsubscribeAgent<ActionFinishedTestAgent>();
+  }
+
+  AsyncNonAtomicActionInterpreter::clear();
+  InstanceCollector::clear();
+  TransitionGraphCache::clear();
+  ArgumentBindingPlanCache::clear();
+  InterpretationScheduler::clear();
+  InterpretationMetrics::clear();
+  common::LogicUtils::ClearFormulaPlans();
+  common::CompiledTemplateCache::Clear();
+  benchmark::Shutdown();
+  ScMemory::Shutdown(false);
+  return 0;
+}
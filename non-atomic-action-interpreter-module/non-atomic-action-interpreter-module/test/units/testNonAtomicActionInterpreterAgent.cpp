@@ -1,11 +1,27 @@
+#include <chrono>
+#include <sstream>
+#include <thread>
+
 #include <sc-memory/test/sc_test.hpp>
 #include <sc-builder/scs_loader.hpp>
 #include <sc-agents-common/utils/IteratorUtils.hpp>
 
 #include <ps-common-lib/keynodes.hpp>
+#include <ps-common-lib/utils/compiled_template_cache.hpp>
+#include <ps-common-lib/utils/logic_utils.hpp>
+#include <ps-common-lib/utils/template_params_utils.hpp>
+#include <ps-common-lib/utils/tracer.hpp>
 
 #include "agent/NonAtomicActionInterpreterAgent.hpp"
+#include "collector/InstanceCollector.hpp"
+#include "constants/NonAtomicActionInterpreterConstants.hpp"
+#include "graph/TransitionGraphCache.hpp"
+#include "interpreter/ArgumentBindingPlanCache.hpp"
+#include "interpreter/AsyncNonAtomicActionInterpreter.hpp"
+#include "interpreter/InterpretationCheckpoint.hpp"
 #include "keynodes/NonAtomicKeynodes.hpp"
+#include "metrics/InterpretationMetrics.hpp"
+#include "scheduler/InterpretationScheduler.hpp"
 #include "agent/ActionFinishedSuccessfullyTestAgent.hpp"
 #include "agent/ActionFinishedTestAgent.hpp"
 #include "agent/ActionFinishedUnsuccessfullyTestAgent.hpp"
@@ -41,14 +57,23 @@ void shutdown(ScAgentContext & agentContext)
   agentContext.UnsubscribeAgent<ActionFinishedUnsuccessfullyTestAgent>();
   agentContext.UnsubscribeAgent<AssignDynamicArgumentTestAgent>();
   agentContext.UnsubscribeAgent<CheckDynamicArgumentTestAgent>();
+  AsyncNonAtomicActionInterpreter::clear();
+  InstanceCollector::clear();
+  TransitionGraphCache::clear();
+  ArgumentBindingPlanCache::clear();
+  InterpretationScheduler::clear();
+  InterpretationMetrics::clear();
+  common::LogicUtils::ClearFormulaPlans();
+  common::CompiledTemplateCache::Clear();
+  common::TemplateParamsUtils::ClearStructureVariables();
 }
 
-ScAction getFirstAction(ScAgentContext & context)
+ScAction getFirstAction(ScAgentContext & context, std::string const & nonAtomicActionClass = "test_nonatomic_action")
 {
   ScAddr actionAddr;
   ScTemplate scTemplate;
   scTemplate.Triple(
-      context.SearchElementBySystemIdentifier("test_nonatomic_action"),
+      context.SearchElementBySystemIdentifier(nonAtomicActionClass),
       ScType::VarPermPosArc,
       ScType::VarNode >> "_nonAtomicAction");
   scTemplate.Quintuple(
@@ -421,4 +446,768 @@ TEST_F(NonAtomicActionInterpreterTest, checkArgumentsMatching)
   shutdown(context);
 }
 
+TEST_F(NonAtomicActionInterpreterTest, checkTransitionGraphCacheInvalidation)
+{
+  ScAgentContext & context = *m_ctx;
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "allPathsInSequence.scs");
+  initialize(context);
+
+  ScAddr testActionNode = context.SearchElementBySystemIdentifier("test_action_node");
+  EXPECT_TRUE(testActionNode.IsValid());
+  ScAction testAction = context.ConvertToAction(testActionNode);
+
+  EXPECT_TRUE(testAction.InitiateAndWait(WAIT_TIME));
+  EXPECT_TRUE(testAction.IsFinishedSuccessfully());
+
+  ScAction firstAction = getFirstAction(context);
+  ScIterator5Ptr tupleIterator5 = context.CreateIterator5(
+      ScType::ConstNodeTuple, ScType::ConstPermPosArc, firstAction, ScType::ConstPermPosArc, ScKeynodes::rrel_1);
+  EXPECT_TRUE(tupleIterator5->Next());
+  ScAddr const decompositionTuple = tupleIterator5->Get(0);
+
+  std::shared_ptr<TransitionGraph const> graph = TransitionGraphCache::get(&context, decompositionTuple);
+  EXPECT_EQ(graph, TransitionGraphCache::get(&context, decompositionTuple));
+  auto const & transitions = graph->getTransitions(graph->getFirstNode(), ActionResult::Successful);
+  EXPECT_EQ(transitions.size(), 2u);
+
+  context.EraseElement(transitions.back().arc);
+
+  std::shared_ptr<TransitionGraph const> updatedGraph = graph;
+  auto const start = std::chrono::steady_clock::now();
+  while (updatedGraph == graph && std::chrono::steady_clock::now() - start < std::chrono::milliseconds(WAIT_TIME))
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    updatedGraph = TransitionGraphCache::get(&context, decompositionTuple);
+  }
+  EXPECT_NE(updatedGraph, graph);
+  EXPECT_EQ(updatedGraph->getTransitions(updatedGraph->getFirstNode(), ActionResult::Successful).size(), 1u);
+
+  tupleIterator5.reset();
+  shutdown(context);
+}
+
+std::shared_ptr<ArgumentBindingPlanCache::Plan const> getUpdatedPlan(
+    ScAgentContext & context,
+    ScAddr const & templateKeyElement,
+    std::shared_ptr<ArgumentBindingPlanCache::Plan const> const & plan)
+{
+  std::shared_ptr<ArgumentBindingPlanCache::Plan const> updatedPlan = plan;
+  auto const start = std::chrono::steady_clock::now();
+  while (updatedPlan == plan && std::chrono::steady_clock::now() - start < std::chrono::milliseconds(WAIT_TIME))
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    updatedPlan = ArgumentBindingPlanCache::get(&context, templateKeyElement);
+  }
+  return updatedPlan;
+}
+
+TEST_F(NonAtomicActionInterpreterTest, checkArgumentBindingPlanCacheInvalidation)
+{
+  ScAgentContext & context = *m_ctx;
+  ScAddr const & templateKeyElement = context.GenerateNode(ScType::VarNode);
+  ScAddr const & firstArgument = context.GenerateNode(ScType::VarNode);
+  ScAddr const & firstArgumentArc =
+      context.GenerateConnector(ScType::VarPermPosArc, templateKeyElement, firstArgument);
+  context.GenerateConnector(ScType::VarPermPosArc, ScKeynodes::rrel_1, firstArgumentArc);
+
+  std::shared_ptr<ArgumentBindingPlanCache::Plan const> plan =
+      ArgumentBindingPlanCache::get(&context, templateKeyElement);
+  EXPECT_EQ(plan, ArgumentBindingPlanCache::get(&context, templateKeyElement));
+  ASSERT_EQ(plan->size(), 1u);
+  EXPECT_EQ(plan->front().first, ScKeynodes::rrel_1);
+  EXPECT_EQ(plan->front().second, firstArgument);
+
+  ScAddr const & secondArgument = context.GenerateNode(ScType::VarNode);
+  ScAddr const & secondArgumentArc =
+      context.GenerateConnector(ScType::VarPermPosArc, templateKeyElement, secondArgument);
+  context.GenerateConnector(ScType::VarPermPosArc, ScKeynodes::rrel_2, secondArgumentArc);
+
+  std::shared_ptr<ArgumentBindingPlanCache::Plan const> updatedPlan =
+      getUpdatedPlan(context, templateKeyElement, plan);
+  EXPECT_NE(updatedPlan, plan);
+  ASSERT_EQ(updatedPlan->size(), 2u);
+  EXPECT_EQ(updatedPlan->back().first, ScKeynodes::rrel_2);
+  EXPECT_EQ(updatedPlan->back().second, secondArgument);
+
+  context.EraseElement(firstArgumentArc);
+
+  plan = updatedPlan;
+  updatedPlan = getUpdatedPlan(context, templateKeyElement, plan);
+  EXPECT_NE(updatedPlan, plan);
+  ASSERT_EQ(updatedPlan->size(), 2u);
+  EXPECT_EQ(updatedPlan->front().first, ScKeynodes::rrel_1);
+  EXPECT_EQ(updatedPlan->front().second, ScAddr::Empty);
+  EXPECT_EQ(updatedPlan->back().first, ScKeynodes::rrel_2);
+  EXPECT_EQ(updatedPlan->back().second, secondArgument);
+
+  shutdown(context);
+}
+
+TEST_F(NonAtomicActionInterpreterTest, checkAsynchronousInterpretation)
+{
+  ScAgentContext & context = *m_ctx;
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "sucsesfullyFinishedSubaction.scs");
+  initialize(context);
+
+  ScAddr testActionNode = context.SearchElementBySystemIdentifier("test_action_node");
+  EXPECT_TRUE(testActionNode.IsValid());
+  context.GenerateConnector(ScType::ConstPermPosArc, Keynodes::asynchronously_interpreted_action, testActionNode);
+  ScAction testAction = context.ConvertToAction(testActionNode);
+
+  EXPECT_TRUE(testAction.InitiateAndWait(WAIT_TIME));
+  EXPECT_TRUE(testAction.IsFinishedSuccessfully());
+
+  ScAction action = getFirstAction(context);
+  EXPECT_TRUE(action.IsFinishedSuccessfully());
+
+  ScAddr const & thenAction = utils::IteratorUtils::getAnyByOutRelation(&context, action, TestKeynodes::nrel_then);
+  EXPECT_TRUE(thenAction.IsValid());
+  EXPECT_TRUE(context.ConvertToAction(thenAction).IsFinished());
+
+  shutdown(context);
+}
+
+TEST_F(NonAtomicActionInterpreterTest, checkForkJoin)
+{
+  ScAgentContext & context = *m_ctx;
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "forkJoin.scs");
+  initialize(context);
+
+  ScAddr testActionNode = context.SearchElementBySystemIdentifier("test_action_node");
+  EXPECT_TRUE(testActionNode.IsValid());
+  ScAction testAction = context.ConvertToAction(testActionNode);
+
+  EXPECT_TRUE(testAction.InitiateAndWait(WAIT_TIME));
+  EXPECT_TRUE(testAction.IsFinishedSuccessfully());
+
+  ScAction action = getFirstAction(context);
+  EXPECT_TRUE(action.IsFinishedSuccessfully());
+
+  size_t branchesCount = 0;
+  ScIterator5Ptr forkIterator5 = context.CreateIterator5(
+      action, ScType::ConstCommonArc, ScType::ConstNode, ScType::ConstPermPosArc, Keynodes::nrel_fork);
+  while (forkIterator5->Next())
+  {
+    EXPECT_TRUE(context.ConvertToAction(forkIterator5->Get(2)).IsFinished());
+    ++branchesCount;
+  }
+  EXPECT_EQ(branchesCount, 2u);
+
+  ScAddr const & joinAction = utils::IteratorUtils::getAnyByOutRelation(&context, action, Keynodes::nrel_join);
+  EXPECT_TRUE(joinAction.IsValid());
+  EXPECT_TRUE(context.ConvertToAction(joinAction).IsFinished());
+
+  forkIterator5.reset();
+  shutdown(context);
+}
+
+TEST_F(NonAtomicActionInterpreterTest, checkNestedNonAtomicActionInterpretation)
+{
+  ScAgentContext & context = *m_ctx;
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "nestedNonAtomicAction.scs");
+  initialize(context);
+
+  ScAddr testActionNode = context.SearchElementBySystemIdentifier("test_action_node");
+  EXPECT_TRUE(testActionNode.IsValid());
+  ScAction testAction = context.ConvertToAction(testActionNode);
+
+  EXPECT_TRUE(testAction.InitiateAndWait(WAIT_TIME));
+  EXPECT_TRUE(testAction.IsFinishedSuccessfully());
+
+  ScAction nestedAction = getFirstAction(context);
+  EXPECT_FALSE(nestedAction.IsInitiated());
+  EXPECT_TRUE(nestedAction.IsFinishedSuccessfully());
+
+  ScAction nestedFirstAction = getFirstAction(context, "test_nested_nonatomic_action");
+  EXPECT_TRUE(nestedFirstAction.IsFinishedSuccessfully());
+
+  ScAddr const & thenAction =
+      utils::IteratorUtils::getAnyByOutRelation(&context, nestedAction, TestKeynodes::nrel_then);
+  EXPECT_TRUE(thenAction.IsValid());
+  EXPECT_TRUE(context.ConvertToAction(thenAction).IsFinished());
+
+  shutdown(context);
+}
+
+TEST_F(NonAtomicActionInterpreterTest, checkGeneralActionCancellation)
+{
+  ScAgentContext & context = *m_ctx;
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "cancelledGeneralAction.scs");
+  initialize(context);
+
+  ScAddr testActionNode = context.SearchElementBySystemIdentifier("test_action_node");
+  EXPECT_TRUE(testActionNode.IsValid());
+  ScAction testAction = context.ConvertToAction(testActionNode);
+  testAction.Initiate();
+
+  ScAddr actionAddr;
+  auto const start = std::chrono::steady_clock::now();
+  while (!actionAddr.IsValid() && std::chrono::steady_clock::now() - start < std::chrono::milliseconds(WAIT_TIME))
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    try
+    {
+      actionAddr = getFirstAction(context);
+    }
+    catch (utils::ExceptionItemNotFound const &)
+    {
+    }
+  }
+  ASSERT_TRUE(actionAddr.IsValid());
+  ScAction action = context.ConvertToAction(actionAddr);
+  while (!action.IsInitiated() && std::chrono::steady_clock::now() - start < std::chrono::milliseconds(WAIT_TIME))
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_TRUE(action.IsInitiated());
+
+  context.GenerateConnector(
+      ScType::ConstPermPosArc, Keynodes::action_cancelled, context.SearchElementBySystemIdentifier("general_action"));
+
+  auto const cancellationStart = std::chrono::steady_clock::now();
+  while (!testAction.IsFinished()
+         && std::chrono::steady_clock::now() - cancellationStart < std::chrono::milliseconds(WAIT_TIME))
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_LT(
+      std::chrono::steady_clock::now() - cancellationStart,
+      std::chrono::milliseconds(NonAtomicActionInterpreterConstants::INTERPRETER_ACTION_WAIT_TIME));
+
+  EXPECT_TRUE(testAction.IsFinishedUnsuccessfully());
+  EXPECT_TRUE(context.CheckConnector(Keynodes::action_cancelled, testAction, ScType::ConstPermPosArc));
+  EXPECT_TRUE(context.CheckConnector(Keynodes::action_cancelled, action, ScType::ConstPermPosArc));
+
+  shutdown(context);
+}
+
+TEST_F(NonAtomicActionInterpreterTest, checkExpiredTimeBudget)
+{
+  ScAgentContext & context = *m_ctx;
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "expiredTimeBudget.scs");
+  initialize(context);
+
+  ScAddr testActionNode = context.SearchElementBySystemIdentifier("test_action_node");
+  EXPECT_TRUE(testActionNode.IsValid());
+  ScAction testAction = context.ConvertToAction(testActionNode);
+
+  auto const start = std::chrono::steady_clock::now();
+  EXPECT_TRUE(testAction.InitiateAndWait(WAIT_TIME));
+  EXPECT_LT(
+      std::chrono::steady_clock::now() - start,
+      std::chrono::milliseconds(NonAtomicActionInterpreterConstants::INTERPRETER_ACTION_WAIT_TIME));
+  EXPECT_TRUE(testAction.IsFinishedUnsuccessfully());
+
+  ScAction action = getFirstAction(context);
+  EXPECT_FALSE(action.IsFinished());
+  EXPECT_TRUE(context.CheckConnector(Keynodes::action_cancelled, action, ScType::ConstPermPosArc));
+
+  shutdown(context);
+}
+
+TEST_F(NonAtomicActionInterpreterTest, checkSuccessfulCompoundConditionalTransition)
+{
+  ScAgentContext & context = *m_ctx;
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "successfulCompoundConditionalTransition.scs");
+  initialize(context);
+
+  ScAddr testActionNode = context.SearchElementBySystemIdentifier("test_action_node");
+  EXPECT_TRUE(testActionNode.IsValid());
+  ScAction testAction = context.ConvertToAction(testActionNode);
+
+  EXPECT_TRUE(testAction.InitiateAndWait(WAIT_TIME));
+  EXPECT_TRUE(testAction.IsFinishedSuccessfully());
+
+  ScAction action = getFirstAction(context);
+  EXPECT_TRUE(action.IsFinished());
+
+  ScAddr const & gotoAction = utils::IteratorUtils::getAnyByOutRelation(&context, action, TestKeynodes::nrel_goto);
+  EXPECT_TRUE(gotoAction.IsValid());
+  action = context.ConvertToAction(gotoAction);
+  EXPECT_TRUE(action.IsFinished());
+
+  shutdown(context);
+}
+
+TEST_F(NonAtomicActionInterpreterTest, checkLazyInstantiation)
+{
+  ScAgentContext & context = *m_ctx;
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "lazyInstantiation.scs");
+  initialize(context);
+
+  ScAddr testActionNode = context.SearchElementBySystemIdentifier("test_action_node");
+  EXPECT_TRUE(testActionNode.IsValid());
+  ScAction testAction = context.ConvertToAction(testActionNode);
+
+  EXPECT_TRUE(testAction.InitiateAndWait(WAIT_TIME));
+  EXPECT_TRUE(testAction.IsFinishedSuccessfully());
+
+  ScAction action = getFirstAction(context);
+  EXPECT_TRUE(action.IsFinishedSuccessfully());
+
+  ScAddr const & decompositionTuple = utils::IteratorUtils::getAnyByInRelation(&context, action, ScKeynodes::rrel_1);
+  ScAddr const & thenAction = utils::IteratorUtils::getAnyByOutRelation(&context, action, TestKeynodes::nrel_then);
+  EXPECT_TRUE(thenAction.IsValid());
+  EXPECT_TRUE(context.ConvertToAction(thenAction).IsFinished());
+  EXPECT_FALSE(utils::IteratorUtils::getAnyByOutRelation(&context, action, Keynodes::nrel_else).IsValid());
+
+  size_t subActionsCount = 0;
+  ScIterator3Ptr subActionsIterator3 =
+      context.CreateIterator3(decompositionTuple, ScType::ConstPermPosArc, ScType::ConstNode);
+  while (subActionsIterator3->Next())
+    subActionsCount++;
+  EXPECT_EQ(subActionsCount, 2u);
+
+  subActionsIterator3.reset();
+  shutdown(context);
+}
+
+TEST_F(NonAtomicActionInterpreterTest, checkFinishedInstanceCollection)
+{
+  ScAgentContext & context = *m_ctx;
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "collectedInstance.scs");
+  initialize(context);
+
+  ScAddr testActionNode = context.SearchElementBySystemIdentifier("test_action_node");
+  EXPECT_TRUE(testActionNode.IsValid());
+  ScAction testAction = context.ConvertToAction(testActionNode);
+
+  EXPECT_TRUE(testAction.InitiateAndWait(WAIT_TIME));
+  EXPECT_TRUE(testAction.IsFinishedSuccessfully());
+
+  bool isCollected = false;
+  auto const start = std::chrono::steady_clock::now();
+  while (!isCollected && std::chrono::steady_clock::now() - start < std::chrono::milliseconds(WAIT_TIME))
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    try
+    {
+      getFirstAction(context);
+    }
+    catch (utils::ExceptionItemNotFound const &)
+    {
+      isCollected = true;
+    }
+  }
+  EXPECT_TRUE(isCollected);
+
+  ScAddr const & summaryLink =
+      utils::IteratorUtils::getAnyByOutRelation(&context, testAction, Keynodes::nrel_execution_summary);
+  ASSERT_TRUE(summaryLink.IsValid());
+  std::string summary;
+  EXPECT_TRUE(context.GetLinkContent(summaryLink, summary));
+  EXPECT_EQ(summary, "sub-actions: 2, successful: 1, unsuccessful: 1");
+
+  shutdown(context);
+}
+
+TEST_F(NonAtomicActionInterpreterTest, checkInstanceCollectionWaitsForRunningSubActions)
+{
+  ScAgentContext & context = *m_ctx;
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "deferredInstanceCollection.scs");
+  initialize(context);
+
+  ScAddr testActionNode = context.SearchElementBySystemIdentifier("test_action_node");
+  EXPECT_TRUE(testActionNode.IsValid());
+  ScAction testAction = context.ConvertToAction(testActionNode);
+
+  EXPECT_TRUE(testAction.InitiateAndWait(WAIT_TIME));
+  EXPECT_TRUE(testAction.IsFinishedUnsuccessfully());
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+  ScAction action = getFirstAction(context);
+  EXPECT_FALSE(action.IsFinished());
+  action.FinishUnsuccessfully();
+
+  bool isCollected = false;
+  auto const start = std::chrono::steady_clock::now();
+  while (!isCollected && std::chrono::steady_clock::now() - start < std::chrono::milliseconds(WAIT_TIME))
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    try
+    {
+      getFirstAction(context);
+    }
+    catch (utils::ExceptionItemNotFound const &)
+    {
+      isCollected = true;
+    }
+  }
+  EXPECT_TRUE(isCollected);
+
+  shutdown(context);
+}
+
+TEST_F(NonAtomicActionInterpreterTest, checkBatchInterpretation)
+{
+  ScAgentContext & context = *m_ctx;
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "batchInterpretation.scs");
+  initialize(context);
+
+  ScAddr testActionNode = context.SearchElementBySystemIdentifier("test_action_node");
+  EXPECT_TRUE(testActionNode.IsValid());
+  ScAction testAction = context.ConvertToAction(testActionNode);
+
+  EXPECT_TRUE(testAction.InitiateAndWait(WAIT_TIME));
+  EXPECT_TRUE(testAction.IsFinishedSuccessfully());
+
+  for (auto const & argumentIdentifier : {"first_batch_argument", "second_batch_argument"})
+  {
+    ScAddr const & argument = context.SearchElementBySystemIdentifier(argumentIdentifier);
+    ScTemplate scTemplate;
+    scTemplate.Triple(
+        context.SearchElementBySystemIdentifier("test_nonatomic_action"),
+        ScType::VarPermPosArc,
+        ScType::VarNode >> "_nonAtomicAction");
+    scTemplate.Quintuple(
+        "_nonAtomicAction", ScType::VarPermPosArc, argument, ScType::VarPermPosArc, ScKeynodes::rrel_1);
+    ScTemplateSearchResult results;
+    context.SearchByTemplate(scTemplate, results);
+    EXPECT_EQ(results.Size(), 1u);
+
+    ScAction action = context.ConvertToAction(results[0]["_nonAtomicAction"]);
+    EXPECT_TRUE(action.IsFinishedSuccessfully());
+
+    size_t finishedActionsCount = 0;
+    ScIterator5Ptr actionsIterator5 = context.CreateIterator5(
+        ScType::ConstNode, ScType::ConstPermPosArc, argument, ScType::ConstPermPosArc, ScKeynodes::rrel_1);
+    while (actionsIterator5->Next())
+    {
+      if (context.ConvertToAction(actionsIterator5->Get(0)).IsFinished())
+        finishedActionsCount++;
+    }
+    EXPECT_EQ(finishedActionsCount, 3u);
+  }
+
+  shutdown(context);
+}
+
+TEST_F(NonAtomicActionInterpreterTest, checkResumeFromCheckpoint)
+{
+  ScAgentContext & context = *m_ctx;
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "interruptedInterpretation.scs");
+  initialize(context);
+
+  ScAddr testActionNode = context.SearchElementBySystemIdentifier("test_action_node");
+  EXPECT_TRUE(testActionNode.IsValid());
+  ScAction testAction = context.ConvertToAction(testActionNode);
+
+  InterpretationCheckpoint::resumeInterrupted(&context);
+
+  auto const start = std::chrono::steady_clock::now();
+  while (!testAction.IsFinished() && std::chrono::steady_clock::now() - start < std::chrono::milliseconds(WAIT_TIME))
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_TRUE(testAction.IsFinishedSuccessfully());
+
+  ScAddr const & firstAction = context.SearchElementBySystemIdentifier("interrupted_first_action");
+  EXPECT_FALSE(context.CheckConnector(ScKeynodes::action_initiated, firstAction, ScType::ConstPermPosArc));
+  ScAddr const & secondAction = context.SearchElementBySystemIdentifier("interrupted_second_action");
+  EXPECT_TRUE(context.ConvertToAction(secondAction).IsFinished());
+  ScAddr const & otherAction = context.SearchElementBySystemIdentifier("interrupted_other_action");
+  EXPECT_FALSE(context.CheckConnector(ScKeynodes::action_initiated, otherAction, ScType::ConstPermPosArc));
+  EXPECT_FALSE(utils::IteratorUtils::getAnyByOutRelation(&context, testAction, Keynodes::nrel_interpretation_checkpoint)
+                   .IsValid());
+
+  shutdown(context);
+}
+
+TEST_F(NonAtomicActionInterpreterTest, checkCheckpointPersistsReplacementsAndPath)
+{
+  ScAgentContext & context = *m_ctx;
+  ScAction action = context.ConvertToAction(context.GenerateNode(ScType::ConstNode));
+  context.GenerateConnector(ScType::ConstPermPosArc, Keynodes::action_with_checkpoints, action);
+  ScAddr const & nonAtomicActionAddr = context.GenerateNode(ScType::ConstNode);
+  ScAddr const & variable = context.GenerateNode(ScType::VarNode);
+  ScAddr const & value = context.GenerateNode(ScType::ConstNode);
+
+  ScAddr const & checkpoint =
+      InterpretationCheckpoint::generate(&context, action, nonAtomicActionAddr, {{variable, value}});
+  ASSERT_TRUE(checkpoint.IsValid());
+  auto const & replacements = InterpretationCheckpoint::getReplacements(&context, checkpoint);
+  ASSERT_EQ(replacements.size(), 1u);
+  EXPECT_EQ(replacements.at(variable), value);
+
+  ScAddr const & path = InterpretationCheckpoint::getPath(&context, checkpoint);
+  ASSERT_TRUE(path.IsValid());
+  ScAddr const & firstTransition = context.GenerateConnector(ScType::ConstCommonArc, nonAtomicActionAddr, value);
+  ScAddr const & secondTransition = context.GenerateConnector(ScType::ConstCommonArc, value, nonAtomicActionAddr);
+  ScAddr pathEnd = InterpretationCheckpoint::appendToPath(&context, path, ScAddr::Empty, firstTransition);
+  pathEnd = InterpretationCheckpoint::appendToPath(&context, path, pathEnd, secondTransition);
+  EXPECT_EQ(InterpretationCheckpoint::getPathEnd(&context, path), pathEnd);
+  EXPECT_EQ(context.GetConnectorIncidentElements(pathEnd).second, secondTransition);
+
+  InterpretationCheckpoint::erase(&context, action);
+  EXPECT_FALSE(InterpretationCheckpoint::find(&context, action).IsValid());
+  EXPECT_FALSE(context.IsElement(path));
+}
+
+TEST_F(NonAtomicActionInterpreterTest, checkLazilyInstantiatedActionWithCheckpointsIsRejected)
+{
+  ScAgentContext & context = *m_ctx;
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "lazyInstantiationWithCheckpoints.scs");
+  initialize(context);
+
+  ScAddr testActionNode = context.SearchElementBySystemIdentifier("test_action_node");
+  EXPECT_TRUE(testActionNode.IsValid());
+  ScAction testAction = context.ConvertToAction(testActionNode);
+
+  EXPECT_TRUE(testAction.InitiateAndWait(WAIT_TIME));
+  EXPECT_TRUE(testAction.IsFinishedUnsuccessfully());
+  EXPECT_FALSE(utils::IteratorUtils::getAnyByOutRelation(&context, testAction, Keynodes::nrel_interpretation_checkpoint)
+                   .IsValid());
+
+  shutdown(context);
+}
+
+TEST_F(NonAtomicActionInterpreterTest, checkInterpretationMetrics)
+{
+  ScAgentContext & context = *m_ctx;
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "sucsesfullyFinishedSubaction.scs");
+  initialize(context);
+  common::Tracer::Clear();
+  common::Tracer::SetEnabled(true);
+
+  ScAddr testActionNode = context.SearchElementBySystemIdentifier("test_action_node");
+  EXPECT_TRUE(testActionNode.IsValid());
+  ScAction testAction = context.ConvertToAction(testActionNode);
+
+  EXPECT_TRUE(testAction.InitiateAndWait(WAIT_TIME));
+  EXPECT_TRUE(testAction.IsFinishedSuccessfully());
+
+  std::stringstream metrics;
+  InterpretationMetrics::exportMetrics(metrics);
+  EXPECT_NE(
+      metrics.str().find("sub_action_wait_time{class=\"successfully_finished_test_action\"} count=1 "),
+      std::string::npos);
+  EXPECT_NE(metrics.str().find("sub_action_queueing_delay{class=\"finished_test_action\"}"), std::string::npos);
+  EXPECT_NE(metrics.str().find("transitions_taken{kind=\"after_successful_action\"} 1"), std::string::npos);
+
+  common::Tracer::SetEnabled(false);
+  std::stringstream trace;
+  common::Tracer::ExportChromeTrace(trace);
+  EXPECT_NE(trace.str().find("\"name\":\"sub_action\",\"cat\":\"interpreter\""), std::string::npos);
+
+  shutdown(context);
+}
+
+TEST_F(NonAtomicActionInterpreterTest, checkScopedTracing)
+{
+  ScAgentContext & context = *m_ctx;
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "sucsesfullyFinishedSubaction.scs");
+  initialize(context);
+  common::Tracer::Clear();
+  common::Tracer::SetEnabled(true);
+
+  ScAddr testActionNode = context.SearchElementBySystemIdentifier("test_action_node");
+  EXPECT_TRUE(testActionNode.IsValid());
+  ScAction testAction = context.ConvertToAction(testActionNode);
+
+  EXPECT_TRUE(testAction.InitiateAndWait(WAIT_TIME));
+  EXPECT_TRUE(testAction.IsFinishedSuccessfully());
+  common::Tracer::SetEnabled(false);
+
+  std::stringstream trace;
+  common::Tracer::ExportChromeTrace(trace);
+  std::string const & traceString = trace.str();
+  EXPECT_EQ(traceString.find("{\"traceEvents\":["), 0u);
+  // Span of the agent is finished after the action, so only its nested spans are surely recorded here.
+  size_t const flowSpan = traceString.find("\"name\":\"InterpretationFlow::start\",\"cat\":\"interpreter\"");
+  ASSERT_NE(flowSpan, std::string::npos);
+  size_t const flowSpanParent = traceString.find("\"parent\":", flowSpan) + 9;
+  EXPECT_NE(traceString.substr(flowSpanParent, 2), "0}");
+
+  shutdown(context);
+}
+
+TEST_F(NonAtomicActionInterpreterTest, checkAdmissionControl)
+{
+  ScAgentContext & context = *m_ctx;
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "scheduledInterpretation.scs");
+  initialize(context);
+  InterpretationScheduler::setConcurrencyCap(1);
+
+  ScAddr const & runningActionNode = context.SearchElementBySystemIdentifier("running_action_node");
+  ScAction lowPriorityAction =
+      context.ConvertToAction(context.SearchElementBySystemIdentifier("low_priority_action_node"));
+  ScAction highPriorityAction =
+      context.ConvertToAction(context.SearchElementBySystemIdentifier("high_priority_action_node"));
+
+  context.BeginEventsBlocking();
+  lowPriorityAction.Initiate();
+  highPriorityAction.Initiate();
+  context.EndEventsBlocking();
+
+  EXPECT_EQ(InterpretationScheduler::admit(&context, runningActionNode), Admission::Admitted);
+  EXPECT_EQ(InterpretationScheduler::admit(&context, lowPriorityAction), Admission::Queued);
+  EXPECT_EQ(InterpretationScheduler::admit(&context, highPriorityAction), Admission::Queued);
+  EXPECT_FALSE(highPriorityAction.IsFinished());
+
+  InterpretationScheduler::release(&context, runningActionNode);
+
+  auto const start = std::chrono::steady_clock::now();
+  while (!lowPriorityAction.IsFinished()
+         && std::chrono::steady_clock::now() - start < std::chrono::milliseconds(WAIT_TIME))
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_TRUE(highPriorityAction.IsFinishedSuccessfully());
+  EXPECT_TRUE(lowPriorityAction.IsFinishedSuccessfully());
+
+  size_t initiatedArcsCount = 0;
+  ScIterator3Ptr initiatedArcsIterator3 =
+      context.CreateIterator3(ScKeynodes::action_initiated, ScType::ConstPermPosArc, highPriorityAction);
+  while (initiatedArcsIterator3->Next())
+    initiatedArcsCount++;
+  EXPECT_LE(initiatedArcsCount, 1u);
+
+  std::stringstream metrics;
+  InterpretationMetrics::exportMetrics(metrics);
+  EXPECT_NE(metrics.str().find("interpretations_queued{priority=\"0\"} 1"), std::string::npos);
+  EXPECT_NE(metrics.str().find("interpretations_queued{priority=\"5\"} 1"), std::string::npos);
+  EXPECT_NE(metrics.str().find("interpretation_queueing_time{priority=\"5\"} count=1 "), std::string::npos);
+
+  InterpretationScheduler::setConcurrencyCap(0);
+  shutdown(context);
+}
+
+TEST_F(NonAtomicActionInterpreterTest, checkCancelledQueuedActionIsDropped)
+{
+  ScAgentContext & context = *m_ctx;
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "scheduledInterpretation.scs");
+  initialize(context);
+  InterpretationScheduler::setConcurrencyCap(1);
+
+  ScAddr const & runningActionNode = context.SearchElementBySystemIdentifier("running_action_node");
+  ScAction lowPriorityAction =
+      context.ConvertToAction(context.SearchElementBySystemIdentifier("low_priority_action_node"));
+  ScAction highPriorityAction =
+      context.ConvertToAction(context.SearchElementBySystemIdentifier("high_priority_action_node"));
+
+  context.BeginEventsBlocking();
+  lowPriorityAction.Initiate();
+  highPriorityAction.Initiate();
+  context.EndEventsBlocking();
+
+  EXPECT_EQ(InterpretationScheduler::admit(&context, runningActionNode), Admission::Admitted);
+  EXPECT_EQ(InterpretationScheduler::admit(&context, lowPriorityAction), Admission::Queued);
+  EXPECT_EQ(InterpretationScheduler::admit(&context, highPriorityAction), Admission::Queued);
+  context.GenerateConnector(ScType::ConstPermPosArc, Keynodes::action_cancelled, highPriorityAction);
+
+  InterpretationScheduler::release(&context, runningActionNode);
+
+  auto const start = std::chrono::steady_clock::now();
+  while (!lowPriorityAction.IsFinished()
+         && std::chrono::steady_clock::now() - start < std::chrono::milliseconds(WAIT_TIME))
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_TRUE(lowPriorityAction.IsFinishedSuccessfully());
+  EXPECT_FALSE(highPriorityAction.IsFinished());
+
+  InterpretationScheduler::setConcurrencyCap(0);
+  shutdown(context);
+}
+
+TEST_F(NonAtomicActionInterpreterTest, checkQueuedActionIsFinishedOnShutdown)
+{
+  ScAgentContext & context = *m_ctx;
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "scheduledInterpretation.scs");
+  initialize(context);
+  InterpretationScheduler::setConcurrencyCap(1);
+
+  ScAddr const & runningActionNode = context.SearchElementBySystemIdentifier("running_action_node");
+  ScAction lowPriorityAction =
+      context.ConvertToAction(context.SearchElementBySystemIdentifier("low_priority_action_node"));
+
+  context.BeginEventsBlocking();
+  lowPriorityAction.Initiate();
+  context.EndEventsBlocking();
+
+  EXPECT_EQ(InterpretationScheduler::admit(&context, runningActionNode), Admission::Admitted);
+  EXPECT_EQ(InterpretationScheduler::admit(&context, lowPriorityAction), Admission::Queued);
+
+  InterpretationScheduler::shutdown(&context);
+  EXPECT_TRUE(lowPriorityAction.IsFinishedUnsuccessfully());
+
+  InterpretationScheduler::setConcurrencyCap(0);
+  shutdown(context);
+}
+
+TEST_F(NonAtomicActionInterpreterTest, checkTransitionConditionPrefetch)
+{
+  ScAgentContext & context = *m_ctx;
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "successfulConditionalTransitionWithMatching.scs");
+  initialize(context);
+
+  ScAddr testActionNode = context.SearchElementBySystemIdentifier("test_action_node");
+  EXPECT_TRUE(testActionNode.IsValid());
+  ScAction testAction = context.ConvertToAction(testActionNode);
+
+  EXPECT_TRUE(testAction.InitiateAndWait(WAIT_TIME));
+  EXPECT_TRUE(testAction.IsFinishedSuccessfully());
+
+  ScAction action = getFirstAction(context);
+  ScAddr const & gotoAction = utils::IteratorUtils::getAnyByOutRelation(&context, action, TestKeynodes::nrel_goto);
+  EXPECT_TRUE(context.ConvertToAction(gotoAction).IsFinished());
+
+  std::stringstream metrics;
+  InterpretationMetrics::exportMetrics(metrics);
+  EXPECT_NE(metrics.str().find("prefetch_time count="), std::string::npos);
+  EXPECT_NE(metrics.str().find("condition_evaluation_time count=1 "), std::string::npos);
+  EXPECT_NE(metrics.str().find("sub_action_wait_time{class="), std::string::npos);
+
+  shutdown(context);
+}
+
+TEST_F(NonAtomicActionInterpreterTest, checkReusedTransitionConditionIsReevaluatedAfterChange)
+{
+  ScAgentContext & context = *m_ctx;
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "reusedChangedTransitionCondition.scs");
+  initialize(context);
+
+  ScAddr testActionNode = context.SearchElementBySystemIdentifier("test_action_node");
+  EXPECT_TRUE(testActionNode.IsValid());
+  ScAction testAction = context.ConvertToAction(testActionNode);
+
+  EXPECT_TRUE(testAction.InitiateAndWait(WAIT_TIME));
+  EXPECT_TRUE(testAction.IsFinishedSuccessfully());
+
+  ScAction action = getFirstAction(context);
+  ScAddr const & assignAction = utils::IteratorUtils::getAnyByOutRelation(&context, action, TestKeynodes::nrel_goto);
+  EXPECT_TRUE(context.ConvertToAction(assignAction).IsFinished());
+  ScAddr const & lastAction =
+      utils::IteratorUtils::getAnyByOutRelation(&context, assignAction, TestKeynodes::nrel_goto);
+  EXPECT_TRUE(context.ConvertToAction(lastAction).IsFinished());
+
+  std::stringstream metrics;
+  InterpretationMetrics::exportMetrics(metrics);
+  EXPECT_NE(metrics.str().find("condition_evaluation_time count=2 "), std::string::npos);
+
+  shutdown(context);
+}
+
+TEST_F(NonAtomicActionInterpreterTest, checkSubActionRetry)
+{
+  ScAgentContext & context = *m_ctx;
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "retriedSubaction.scs");
+  initialize(context);
+
+  ScAddr testActionNode = context.SearchElementBySystemIdentifier("test_action_node");
+  EXPECT_TRUE(testActionNode.IsValid());
+  ScAction testAction = context.ConvertToAction(testActionNode);
+
+  EXPECT_TRUE(testAction.InitiateAndWait(WAIT_TIME));
+  EXPECT_TRUE(testAction.IsFinishedSuccessfully());
+
+  ScAction action = getFirstAction(context);
+  EXPECT_TRUE(action.IsFinishedUnsuccessfully());
+  ScAddr const & elseAction = utils::IteratorUtils::getAnyByOutRelation(&context, action, Keynodes::nrel_else);
+  EXPECT_TRUE(context.ConvertToAction(elseAction).IsFinished());
+
+  size_t resultsCount = 0;
+  ScIterator5Ptr resultsIterator5 = context.CreateIterator5(
+      action, ScType::ConstCommonArc, ScType::Unknown, ScType::ConstPermPosArc, ScKeynodes::nrel_result);
+  while (resultsIterator5->Next())
+    resultsCount++;
+  EXPECT_LE(resultsCount, 1u);
+
+  std::stringstream metrics;
+  InterpretationMetrics::exportMetrics(metrics);
+  EXPECT_NE(metrics.str().find("retries_after_unsuccessful_finish 2"), std::string::npos);
+
+  shutdown(context);
+}
+
 }  // namespace nonAtomicActionInterpreterModuleTest
@@ -33,6 +33,7 @@ class ps_common_libRecipe(ConanFile):
 
     def build_requirements(self):
         self.test_requires("gtest/1.14.0")
+        self.test_requires("benchmark/1.9.1")
 
     def layout(self):
         cmake_layout(self)
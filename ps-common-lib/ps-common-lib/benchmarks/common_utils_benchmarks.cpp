@@ -0,0 +1,271 @@
+#include <benchmark/benchmark.h>
+
+#include <sc-memory/sc_memory.hpp>
+
+#include "ps-common-lib/keynodes.hpp"
+#include "ps-common-lib/utils/compiled_template_cache.hpp"
+#include "ps-common-lib/utils/flat_addr_map.hpp"
+#include "ps-common-lib/utils/logic_utils.hpp"
+#include "ps-common-lib/utils/relation_utils.hpp"
+#include "ps-common-lib/utils/template_params_utils.hpp"
+
+using namespace common;
+
+namespace commonBenchmarks
+{
+
+// Knowledge base generated for one benchmark. All generated nodes are erased with their connectors when the benchmark
+// is finished, so every benchmark starts with the same sc-memory.
+class GeneratedKnowledgeBase
+{
+public:
+  explicit GeneratedKnowledgeBase(ScMemoryContext & context)
+    : context(context)
+  {
+  }
+
+  ~GeneratedKnowledgeBase()
+  {
+    for (auto const & node : nodes)
+      context.EraseElement(node);
+  }
+
+  ScAddr GenerateNode(ScType const & type)
+  {
+    ScAddr const & node = context.GenerateNode(type);
+    nodes.push_back(node);
+    return node;
+  }
+
+  // Set with the given number of elements, its elements are returned in the order of generation.
+  ScAddr GenerateSet(size_t size, ScAddrVector & elements)
+  {
+    ScAddr const & set = GenerateNode(ScType::ConstNode);
+    for (size_t index = 0; index < size; index++)
+    {
+      elements.push_back(GenerateNode(ScType::ConstNode));
+      context.GenerateConnector(ScType::ConstPermPosArc, set, elements.back());
+    }
+    return set;
+  }
+
+  // Atomic logical formula with one triple, the set and the element of the set are variable.
+  ScAddr GenerateAtomicFormula(ScAddr const & set, ScAddr & element)
+  {
+    ScAddr const & formula = GenerateNode(ScType::ConstNodeStructure);
+    element = GenerateNode(ScType::VarNode);
+    ScAddr const & arc = context.GenerateConnector(ScType::VarPermPosArc, set, element);
+    for (auto const & formulaElement : {set, element, arc})
+      context.GenerateConnector(ScType::ConstPermPosArc, formula, formulaElement);
+    context.GenerateConnector(ScType::ConstPermPosArc, Keynodes::atomic_logical_formula, formula);
+    return formula;
+  }
+
+  ScAddr GenerateConjunction(ScAddrVector const & subFormulas)
+  {
+    ScAddr const & conjunction = GenerateNode(ScType::ConstNodeTuple);
+    context.GenerateConnector(ScType::ConstPermPosArc, Keynodes::conjunction, conjunction);
+    for (auto const & subFormula : subFormulas)
+      context.GenerateConnector(ScType::ConstPermPosArc, conjunction, subFormula);
+    return conjunction;
+  }
+
+private:
+  ScMemoryContext & context;
+  ScAddrVector nodes;
+};
+
+// Conjunction of atomic formulas, each formula checks that its replaced variable is an element of the set of the
+// given size. The formula is true, so all of its sub-formulas are checked.
+template <class TReplacements>
+void BM_CheckLogicalFormula(benchmark::State & state)
+{
+  ScMemoryContext context;
+  GeneratedKnowledgeBase knowledgeBase(context);
+  ScAddrVector setElements;
+  ScAddr const & set = knowledgeBase.GenerateSet(state.range(0), setElements);
+
+  TReplacements replacements;
+  ScAddrVector subFormulas;
+  for (size_t index = 0; index < static_cast<size_t>(state.range(1)); index++)
+  {
+    ScAddr element;
+    subFormulas.push_back(knowledgeBase.GenerateAtomicFormula(set, element));
+    replacements[element] = setElements[index % setElements.size()];
+  }
+  ScAddr const & formula = knowledgeBase.GenerateConjunction(subFormulas);
+  LogicUtils::PrepareLogicalFormula(&context, formula);
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(LogicUtils::CheckLogicalFormula(&context, formula, replacements));
+
+  state.SetItemsProcessed(state.iterations() * subFormulas.size());
+  LogicUtils::ClearFormulaPlans();
+  CompiledTemplateCache::Clear();
+}
+
+void applyFormulaSizes(benchmark::internal::Benchmark * benchmark)
+{
+  benchmark->ArgNames({"kb_size", "formulas"});
+  for (int64_t kbSize : {16, 1024, 65536})
+  {
+    for (int64_t formulasCount : {1, 8, 64})
+      benchmark->Args({kbSize, formulasCount});
+  }
+}
+
+BENCHMARK(BM_CheckLogicalFormula<std::map<ScAddr, ScAddr, ScAddrLessFunc>>)->Apply(applyFormulaSizes);
+
+BENCHMARK(BM_CheckLogicalFormula<FlatAddrMap>)->Apply(applyFormulaSizes);
+
+// Structure contains twice as many variables as there are replacements, so only the half of its variables is
+// replaced.
+template <class TReplacements>
+void BM_CreateTemplateParamsFromReplacements(benchmark::State & state)
+{
+  ScMemoryContext context;
+  GeneratedKnowledgeBase knowledgeBase(context);
+  ScAddr const & structure = knowledgeBase.GenerateNode(ScType::ConstNodeStructure);
+  TReplacements replacements;
+  for (size_t index = 0; index < static_cast<size_t>(state.range(0)) * 2; index++)
+  {
+    ScAddr const & variable = knowledgeBase.GenerateNode(ScType::VarNode);
+    context.GenerateConnector(ScType::ConstPermPosArc, structure, variable);
+    if (index % 2 == 0)
+      replacements[variable] = knowledgeBase.GenerateNode(ScType::ConstNode);
+  }
+  bool const isStructureUsed = state.range(1);
+
+  for (auto _ : state)
+  {
+    if (isStructureUsed)
+      benchmark::DoNotOptimize(
+          TemplateParamsUtils::CreateTemplateParamsFromReplacements(&context, replacements, structure));
+    else
+      benchmark::DoNotOptimize(TemplateParamsUtils::CreateTemplateParamsFromReplacements(replacements));
+  }
+
+  state.SetItemsProcessed(state.iterations() * replacements.size());
+  CompiledTemplateCache::Clear();
+}
+
+void applyReplacementsSizes(benchmark::internal::Benchmark * benchmark)
+{
+  benchmark->ArgNames({"replacements", "structure"});
+  for (int64_t replacementsCount : {4, 16, 64, 256})
+  {
+    benchmark->Args({replacementsCount, 0});
+    benchmark->Args({replacementsCount, 1});
+  }
+}
+
+BENCHMARK(BM_CreateTemplateParamsFromReplacements<std::map<ScAddr, ScAddr, ScAddrLessFunc>>)
+    ->Apply(applyReplacementsSizes);
+
+BENCHMARK(BM_CreateTemplateParamsFromReplacements<FlatAddrMap>)->Apply(applyReplacementsSizes);
+
+// Node has outgoing arcs to the given number of elements and all checked elements are among them, so every connector
+// is checked.
+void BM_CheckAllOutgoingConnectors(benchmark::State & state)
+{
+  ScMemoryContext context;
+  GeneratedKnowledgeBase knowledgeBase(context);
+  ScAddrVector elements;
+  ScAddr const & node = knowledgeBase.GenerateSet(state.range(0), elements);
+  elements.resize(std::min<size_t>(elements.size(), state.range(1)));
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(
+        RelationUtils::CheckAllOutgoingConnectors(&context, node, ScType::ConstPermPosArc, elements));
+
+  state.SetItemsProcessed(state.iterations() * elements.size());
+}
+
+void BM_CheckAllIncomingConnectors(benchmark::State & state)
+{
+  ScMemoryContext context;
+  GeneratedKnowledgeBase knowledgeBase(context);
+  ScAddr const & node = knowledgeBase.GenerateNode(ScType::ConstNode);
+  ScAddrVector elements;
+  for (size_t index = 0; index < static_cast<size_t>(state.range(0)); index++)
+  {
+    elements.push_back(knowledgeBase.GenerateNode(ScType::ConstNode));
+    context.GenerateConnector(ScType::ConstPermPosArc, elements.back(), node);
+  }
+  elements.resize(std::min<size_t>(elements.size(), state.range(1)));
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(
+        RelationUtils::CheckAllIncomingConnectors(&context, node, ScType::ConstPermPosArc, elements));
+
+  state.SetItemsProcessed(state.iterations() * elements.size());
+}
+
+// Connectors are generated again before each iteration, only their erasure is measured.
+void BM_EraseAllOutgoingConnectors(benchmark::State & state)
+{
+  ScMemoryContext context;
+  GeneratedKnowledgeBase knowledgeBase(context);
+  ScAddrVector elements;
+  ScAddr const & node = knowledgeBase.GenerateSet(state.range(0), elements);
+  elements.resize(std::min<size_t>(elements.size(), state.range(1)));
+
+  for (auto _ : state)
+  {
+    RelationUtils::EraseAllOutgoingConnectors(&context, node, ScType::ConstPermPosArc, elements);
+
+    state.PauseTiming();
+    for (auto const & element : elements)
+      context.GenerateConnector(ScType::ConstPermPosArc, node, element);
+    state.ResumeTiming();
+  }
+
+  state.SetItemsProcessed(state.iterations() * elements.size());
+}
+
+void applyRelationSizes(benchmark::internal::Benchmark * benchmark)
+{
+  benchmark->ArgNames({"degree", "checked"});
+  for (int64_t degree : {16, 256, 4096})
+  {
+    for (int64_t checkedCount : {4, 64, 1024})
+      benchmark->Args({degree, checkedCount});
+  }
+}
+
+BENCHMARK(BM_CheckAllOutgoingConnectors)->Apply(applyRelationSizes);
+
+BENCHMARK(BM_CheckAllIncomingConnectors)->Apply(applyRelationSizes);
+
+BENCHMARK(BM_EraseAllOutgoingConnectors)->Apply(applyRelationSizes);
+
+}  // namespace commonBenchmarks
+
+// Version of the library is added to the context of the report, so JSON reports of different releases can be told
+// apart when they are compared.
+int main(int argc, char ** argv)
+{
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+  benchmark::AddCustomContext("ps-common-lib", PS_COMMON_LIB_VERSION);
+
+  sc_memory_params params;
+  sc_memory_params_clear(&params);
+  params.clear = SC_TRUE;
+  params.storage = "ps-common-lib-benchmarks-db";
+  params.log_type = "Console";
+  params.log_file = "";
+  params.log_level = "Error";
+  params.user_mode = SC_FALSE;
+  params.dump_memory = SC_FALSE;
+  params.dump_memory_statistics = SC_FALSE;
+  ScMemory::Initialize(params);
+
+  benchmark::RunSpecifiedBenchmarks();
+
+  CompiledTemplateCache::Clear();
+  benchmark::Shutdown();
+  ScMemory::Shutdown(false);
+  return 0;
+}
@@ -8,6 +8,14 @@ class Keynodes : public ScKeynodes
 {
 public:
   static inline ScKeynode const atomic_logical_formula{"atomic_logical_formula", ScType::ConstNodeClass};
+
+  static inline ScKeynode const conjunction{"conjunction", ScType::ConstNodeClass};
+
+  static inline ScKeynode const disjunction{"disjunction", ScType::ConstNodeClass};
+
+  static inline ScKeynode const negation{"negation", ScType::ConstNodeClass};
+
+  static inline ScKeynode const nrel_implication{"nrel_implication", ScType::ConstNodeNonRole};
 };
 
 }  // namespace common
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <functional>
+
+#include <sc-memory/sc_memory.hpp>
+
+#include "ps-common-lib/utils/flat_addr_map.hpp"
+
+namespace common
+{
+
+class CompiledTemplate
+{
+public:
+  CompiledTemplate(ScMemoryContext * context, ScAddr const & structure);
+
+  void Build(ScTemplate & scTemplate, std::map<ScAddr, ScAddr, ScAddrLessFunc> const & replacements) const;
+
+  void Build(
+      ScTemplate & scTemplate,
+      std::map<ScAddr, ScAddr, ScAddrLessFunc> const & replacements,
+      std::function<bool(ScAddr const & connector)> const & filter) const;
+
+  void Build(ScTemplate & scTemplate, FlatAddrMap const & replacements) const;
+
+  void Build(
+      ScTemplate & scTemplate,
+      FlatAddrMap const & replacements,
+      std::function<bool(ScAddr const & connector)> const & filter) const;
+
+  // Triples of several structures can be added to one template. Variables declared by the previous structures are
+  // referenced by their aliases, so common variables of the structures are bound to the same elements.
+  void Build(
+      ScTemplate & scTemplate,
+      std::map<ScAddr, ScAddr, ScAddrLessFunc> const & replacements,
+      ScAddrUnorderedSet & declaredVariables) const;
+
+  void Build(ScTemplate & scTemplate, FlatAddrMap const & replacements, ScAddrUnorderedSet & declaredVariables) const;
+
+  ScAddr const & GetStructure() const;
+
+  size_t GetTriplesCount() const;
+
+  ScAddrUnorderedSet const & GetVariables() const;
+
+  static std::string GetVariableAlias(ScAddr const & variable);
+
+private:
+  struct Item
+  {
+    ScAddr addr;
+    ScType type;
+    std::string alias;
+  };
+
+  struct Triple
+  {
+    Item source;
+    Item connector;
+    Item target;
+  };
+
+  ScAddr structure;
+  std::vector<Triple> triples;
+  ScAddrUnorderedSet variables;
+
+  static Item CreateItem(ScMemoryContext * context, ScAddr const & addr);
+
+  template <class TReplacements>
+  void BuildTriples(
+      ScTemplate & scTemplate,
+      TReplacements const & replacements,
+      std::function<bool(ScAddr const & connector)> const & filter,
+      ScAddrUnorderedSet & declaredVariables) const;
+
+  template <class TReplacements>
+  static ScTemplateItem GetTemplateItem(
+      Item const & item,
+      TReplacements const & replacements,
+      ScAddrUnorderedSet & declaredVariables);
+};
+
+}  // namespace common
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "ps-common-lib/utils/compiled_template.hpp"
+#include "ps-common-lib/utils/event_invalidated_cache.hpp"
+
+namespace common
+{
+
+class CompiledTemplateCache
+{
+public:
+  static std::shared_ptr<CompiledTemplate const> Get(ScMemoryContext * context, ScAddr const & structure);
+
+  static void Invalidate(ScAddr const & structure);
+
+  static void Clear();
+
+private:
+  static size_t const CAPACITY;
+
+  static EventInvalidatedCache<CompiledTemplate const> & GetCache();
+
+  static std::list<std::shared_ptr<ScEventSubscription>> Subscribe(
+      ScAgentContext * context,
+      ScAddr const & structure,
+      std::shared_ptr<std::atomic_bool> const & isStale);
+};
+
+}  // namespace common
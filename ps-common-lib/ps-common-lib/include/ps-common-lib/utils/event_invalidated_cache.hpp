@@ -0,0 +1,144 @@
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include <sc-memory/sc_agent_context.hpp>
+
+namespace common
+{
+
+// Process-wide LRU cache of values built from the knowledge base. Every entry is marked stale by the sc-event
+// subscriptions created by its loader, stale entries are rebuilt on the next access. Subscriptions are created by the
+// context owned by the cache, so they don't depend on the lifetime of the contexts that request the values.
+template <class TValue>
+class EventInvalidatedCache
+{
+public:
+  using Subscriptions = std::list<std::shared_ptr<ScEventSubscription>>;
+
+  explicit EventInvalidatedCache(size_t capacity)
+    : capacity(capacity)
+  {
+  }
+
+  // Loader is called without the lock as `load(eventsContext, isStale, subscriptions)`. It builds the value and
+  // subscribes it by the events context on the changes that should set the stale flag. Events context is held by the
+  // loader and by the entry, so it outlives their subscriptions even if the cache is cleared meanwhile. Value loaded
+  // while the cache is cleared is returned, but it isn't cached.
+  template <class TLoader>
+  std::shared_ptr<TValue> Get(ScAddr const & key, TLoader const & load)
+  {
+    std::shared_ptr<ScAgentContext> eventsContext;
+    size_t loadGeneration;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto const & it = entries.find(key);
+      if (it != entries.cend())
+      {
+        if (!*it->second.isStale)
+        {
+          usageOrder.splice(usageOrder.begin(), usageOrder, it->second.usage);
+          return it->second.value;
+        }
+
+        usageOrder.erase(it->second.usage);
+        entries.erase(it);
+      }
+
+      if (!subscriptionsContext)
+        subscriptionsContext = std::make_shared<ScAgentContext>();
+      eventsContext = subscriptionsContext;
+      loadGeneration = generation;
+    }
+
+    auto isStale = std::make_shared<std::atomic_bool>(false);
+    Subscriptions subscriptions;
+    std::shared_ptr<TValue> value = load(eventsContext.get(), isStale, subscriptions);
+
+    std::unordered_map<ScAddr, Entry, ScAddrHashFunc> evictedEntries;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (loadGeneration != generation)
+      return value;
+
+    auto const & it = entries.find(key);
+    if (it != entries.cend())
+    {
+      usageOrder.erase(it->second.usage);
+      evictedEntries.emplace(key, std::move(it->second));
+      entries.erase(it);
+    }
+
+    usageOrder.push_front(key);
+    entries[key] = {value, isStale, eventsContext, std::move(subscriptions), usageOrder.begin()};
+
+    while (entries.size() > capacity)
+    {
+      auto const & evicted = entries.find(usageOrder.back());
+      evictedEntries.emplace(evicted->first, std::move(evicted->second));
+      entries.erase(evicted);
+      usageOrder.pop_back();
+    }
+
+    return value;
+  }
+
+  void Invalidate(ScAddr const & key)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto const & it = entries.find(key);
+    if (it != entries.cend())
+      *it->second.isStale = true;
+  }
+
+  void Erase(ScAddr const & key)
+  {
+    std::unique_ptr<Entry> erasedEntry;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto const & it = entries.find(key);
+    if (it == entries.cend())
+      return;
+
+    usageOrder.erase(it->second.usage);
+    erasedEntry = std::make_unique<Entry>(std::move(it->second));
+    entries.erase(it);
+  }
+
+  // Subscriptions are destroyed without the lock, because their delegates may be running. Events context is destroyed
+  // by the last of the cleared entries and the running loaders.
+  void Clear()
+  {
+    std::unordered_map<ScAddr, Entry, ScAddrHashFunc> clearedEntries;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      clearedEntries.swap(entries);
+      usageOrder.clear();
+      subscriptionsContext.reset();
+      generation++;
+    }
+    clearedEntries.clear();
+  }
+
+private:
+  struct Entry
+  {
+    std::shared_ptr<TValue> value;
+    std::shared_ptr<std::atomic_bool> isStale;
+    // Context is declared before the subscriptions, so it is destroyed after them.
+    std::shared_ptr<ScAgentContext> eventsContext;
+    Subscriptions subscriptions;
+    std::list<ScAddr>::iterator usage;
+  };
+
+  size_t const capacity;
+  std::mutex mutex;
+  std::unordered_map<ScAddr, Entry, ScAddrHashFunc> entries;
+  std::list<ScAddr> usageOrder;
+  std::shared_ptr<ScAgentContext> subscriptionsContext;
+  size_t generation = 0;
+};
+
+}  // namespace common
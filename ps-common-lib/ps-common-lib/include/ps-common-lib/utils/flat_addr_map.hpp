@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <initializer_list>
+
+#include <sc-memory/sc_memory.hpp>
+
+namespace common
+{
+
+// Map of sc-addresses kept as a vector sorted by ScAddrLessFunc. Up to INLINE_CAPACITY pairs are stored inside the
+// object, so typical replacements are built, copied and searched without heap allocations. Interface follows
+// std::map, so the map can be used where replacements are iterated or searched.
+class FlatAddrMap
+{
+public:
+  using value_type = std::pair<ScAddr, ScAddr>;
+  using iterator = value_type *;
+  using const_iterator = value_type const *;
+
+  static constexpr size_t INLINE_CAPACITY = 16;
+
+  FlatAddrMap() = default;
+
+  FlatAddrMap(std::initializer_list<value_type> items);
+
+  explicit FlatAddrMap(std::map<ScAddr, ScAddr, ScAddrLessFunc> const & items);
+
+  FlatAddrMap(FlatAddrMap const & other) = default;
+
+  FlatAddrMap(FlatAddrMap && other) noexcept;
+
+  FlatAddrMap & operator=(FlatAddrMap const & other) = default;
+
+  FlatAddrMap & operator=(FlatAddrMap && other) noexcept;
+
+  iterator begin();
+
+  iterator end();
+
+  const_iterator begin() const;
+
+  const_iterator end() const;
+
+  const_iterator cbegin() const;
+
+  const_iterator cend() const;
+
+  size_t size() const;
+
+  bool empty() const;
+
+  iterator find(ScAddr const & key);
+
+  const_iterator find(ScAddr const & key) const;
+
+  size_t count(ScAddr const & key) const;
+
+  ScAddr & operator[](ScAddr const & key);
+
+  std::pair<iterator, bool> insert(value_type const & item);
+
+  std::pair<iterator, bool> emplace(ScAddr const & key, ScAddr const & value);
+
+  size_t erase(ScAddr const & key);
+
+  void clear();
+
+  std::map<ScAddr, ScAddr, ScAddrLessFunc> ToMap() const;
+
+private:
+  std::array<value_type, INLINE_CAPACITY> inlineItems;
+  std::vector<value_type> heapItems;
+  size_t itemsCount = 0;
+
+  value_type * GetItems();
+
+  value_type const * GetItems() const;
+
+  const_iterator LowerBound(ScAddr const & key) const;
+};
+
+}  // namespace common
@@ -2,6 +2,9 @@
 
 #include <sc-memory/sc_memory.hpp>
 
+#include "ps-common-lib/utils/event_invalidated_cache.hpp"
+#include "ps-common-lib/utils/flat_addr_map.hpp"
+
 namespace common
 {
 
@@ -12,6 +15,87 @@ public:
       ScMemoryContext * context,
       ScAddr const & logicFormula,
       std::map<ScAddr, ScAddr, ScAddrLessFunc> const & replacements);
+
+  static bool CheckLogicalFormula(
+      ScMemoryContext * context,
+      ScAddr const & logicFormula,
+      FlatAddrMap const & replacements);
+
+  static void PrepareLogicalFormula(ScMemoryContext * context, ScAddr const & logicFormula);
+
+  static ScAddrUnorderedSet GetVariables(ScMemoryContext * context, ScAddr const & logicFormula);
+
+  static void ClearFormulaPlans();
+
+private:
+  enum class FormulaKind
+  {
+    Atomic,
+    Conjunction,
+    Disjunction,
+    Negation,
+    Implication
+  };
+
+  // Plan of a formula is cached until the formula or any of its sub-formulas is changed.
+  struct FormulaPlan
+  {
+    FormulaKind kind;
+    size_t cost;
+    // Groups of sub-formulas in order of their cost. Atomic conjuncts with common variables are grouped, because they
+    // are checked by one template. Groups of an implication are its premise and its conclusion.
+    std::vector<ScAddrVector> groups;
+    bool isPremiseFirst;
+    // Variables of an implication that are common to its premise and its conclusion.
+    ScAddrVector commonVariables;
+    // Formulas of the whole tree, changes of any of them make the plan stale.
+    ScAddrVector formulas;
+  };
+
+  static size_t const FORMULA_PLANS_CAPACITY;
+
+  template <class TReplacements>
+  static bool CheckAnyLogicalFormula(
+      ScMemoryContext * context,
+      ScAddr const & logicFormula,
+      TReplacements const & replacements);
+
+  template <class TReplacements>
+  static bool CheckGroup(ScMemoryContext * context, ScAddrVector const & group, TReplacements const & replacements);
+
+  template <class TReplacements>
+  static bool CheckCompoundLogicalFormula(
+      ScMemoryContext * context,
+      FormulaPlan const & plan,
+      TReplacements const & replacements,
+      bool resultToStop);
+
+  template <class TReplacements>
+  static bool CheckImplication(
+      ScMemoryContext * context,
+      FormulaPlan const & plan,
+      TReplacements const & replacements);
+
+  static bool IsAtomicLogicalFormula(ScMemoryContext * context, ScAddr const & logicFormula);
+
+  static bool IsImplication(ScMemoryContext * context, ScAddr const & logicFormula);
+
+  static EventInvalidatedCache<FormulaPlan const> & GetFormulaPlans();
+
+  static std::shared_ptr<FormulaPlan const> GetFormulaPlan(ScMemoryContext * context, ScAddr const & logicFormula);
+
+  static std::shared_ptr<FormulaPlan const> BuildFormulaPlan(ScMemoryContext * context, ScAddr const & logicFormula);
+
+  static FormulaKind GetFormulaKind(ScMemoryContext * context, ScAddr const & logicFormula);
+
+  static ScAddrVector GetCommonVariables(ScMemoryContext * context, ScAddr const & premise, ScAddr const & conclusion);
+
+  static std::vector<ScAddrVector> GroupConjuncts(ScMemoryContext * context, ScAddrVector const & conjuncts);
+
+  static std::list<std::shared_ptr<ScEventSubscription>> SubscribeFormulaPlan(
+      ScAgentContext * context,
+      ScAddrVector const & formulas,
+      std::shared_ptr<std::atomic_bool> const & isStale);
 };
 
 }  // namespace common
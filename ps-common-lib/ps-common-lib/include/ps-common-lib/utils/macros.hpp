@@ -1,22 +1,9 @@
 #pragma once
 
-#if PERF_MEASURE_BUILD
+#include "ps-common-lib/utils/tracer.hpp"
 
-#  include <chrono>
-#  include <sc-memory/utils/sc_log.hpp>
+#define TRACE_SPAN_CONCAT_IMPL(prefix, line) prefix##line
+#define TRACE_SPAN_CONCAT(prefix, line) TRACE_SPAN_CONCAT_IMPL(prefix, line)
 
-#  define START_TIMER() auto perf_start_time = std::chrono::high_resolution_clock::now()
-
-#  define STOP_TIMER(name) \
-    auto perf_stop_time = std::chrono::high_resolution_clock::now(); \
-    SC_LOG_DEBUG( \
-        name << ": " \
-             << std::chrono::duration_cast<std::chrono::milliseconds>(perf_stop_time - perf_start_time).count() \
-             << "ms")
-
-#else
-
-#  define START_TIMER()
-#  define STOP_TIMER(name)
-
-#endif
+// Span lasts until the end of the enclosing scope, spans of nested scopes are its children.
+#define TRACE_SPAN(...) common::Tracer::Span const TRACE_SPAN_CONCAT(traceSpan, __LINE__)(__VA_ARGS__)
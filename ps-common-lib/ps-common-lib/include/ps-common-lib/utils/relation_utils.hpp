@@ -8,12 +8,33 @@ namespace common
 class RelationUtils
 {
 public:
+  // Vectors shorter than this are checked element by element, the scan of incident connectors doesn't pay off for them.
+  static constexpr size_t BULK_CHECK_MIN_SIZE = 8;
+
+  // Incident connectors of the node are scanned once if there are no more of them than this number per checked element.
+  static constexpr size_t BULK_CHECK_DEGREE_RATIO = 4;
+
+  // Connectors are erased in batches of this size, sc-events of each batch are emitted after the batch is erased.
+  static constexpr size_t ERASE_BATCH_SIZE = 256;
+
   static void EraseAllConnectors(
       ScMemoryContext * context,
       ScAddr const & source,
       ScAddr const & target,
       ScType const & connectorType);
 
+  static void EraseAllIncomingConnectors(
+      ScMemoryContext * context,
+      ScAddr const & node,
+      ScType const & connectorType,
+      ScAddrVector const & addrVector);
+
+  static void EraseAllOutgoingConnectors(
+      ScMemoryContext * context,
+      ScAddr const & node,
+      ScType const & connectorType,
+      ScAddrVector const & addrVector);
+
   static bool CheckRelationBetween(
       ScMemoryContext * context,
       ScAddr const & source,
@@ -31,6 +52,44 @@ public:
       ScAddr const & node,
       ScType const & connectorType,
       ScAddrVector const & addrVector);
+
+  static ScAddrVector GetMissingIncomingConnectors(
+      ScMemoryContext * context,
+      ScAddr const & node,
+      ScType const & connectorType,
+      ScAddrVector const & addrVector);
+
+  static ScAddrVector GetMissingOutgoingConnectors(
+      ScMemoryContext * context,
+      ScAddr const & node,
+      ScType const & connectorType,
+      ScAddrVector const & addrVector);
+
+private:
+  static bool IsScanCheaper(size_t nodeDegree, size_t checksCount);
+
+  static ScAddrUnorderedSet GetIncidentElements(
+      ScMemoryContext * context,
+      ScAddr const & node,
+      ScType const & connectorType,
+      bool isIncoming);
+
+  static ScAddrVector GetMissingConnectors(
+      ScMemoryContext * context,
+      ScAddr const & node,
+      ScType const & connectorType,
+      ScAddrVector const & addrVector,
+      bool isIncoming,
+      bool stopOnFirst);
+
+  static void EraseIncidentConnectors(
+      ScMemoryContext * context,
+      ScAddr const & node,
+      ScType const & connectorType,
+      ScAddrVector const & addrVector,
+      bool isIncoming);
+
+  static void EraseConnectors(ScMemoryContext * context, ScAddrVector const & connectors);
 };
 
 }  // namespace common
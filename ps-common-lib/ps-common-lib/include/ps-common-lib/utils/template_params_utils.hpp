@@ -2,6 +2,9 @@
 
 #include <sc-memory/sc_memory.hpp>
 
+#include "ps-common-lib/utils/event_invalidated_cache.hpp"
+#include "ps-common-lib/utils/flat_addr_map.hpp"
+
 namespace common
 {
 class TemplateParamsUtils
@@ -14,5 +17,37 @@ public:
       ScMemoryContext * context,
       std::map<ScAddr, ScAddr, ScAddrLessFunc> const & replacements,
       ScAddr const & structure);
+
+  static ScTemplateParams CreateTemplateParamsFromReplacements(FlatAddrMap const & replacements);
+
+  static ScTemplateParams CreateTemplateParamsFromReplacements(
+      ScMemoryContext * context,
+      FlatAddrMap const & replacements,
+      ScAddr const & structure);
+
+  static void ClearStructureVariables();
+
+private:
+  static size_t const STRUCTURE_VARIABLES_CAPACITY;
+
+  template <class TReplacements>
+  static ScTemplateParams CreateTemplateParams(TReplacements const & replacements);
+
+  template <class TReplacements>
+  static ScTemplateParams CreateTemplateParamsForStructure(
+      ScMemoryContext * context,
+      TReplacements const & replacements,
+      ScAddr const & structure);
+
+  static EventInvalidatedCache<ScAddrUnorderedSet const> & GetStructureVariablesCache();
+
+  static std::shared_ptr<ScAddrUnorderedSet const> GetStructureVariables(
+      ScMemoryContext * context,
+      ScAddr const & structure);
+
+  static std::list<std::shared_ptr<ScEventSubscription>> SubscribeStructure(
+      ScAgentContext * context,
+      ScAddr const & structure,
+      std::shared_ptr<std::atomic_bool> const & isStale);
 };
 }  // namespace common
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <sc-memory/sc_memory.hpp>
+
+#include "ps-common-lib/utils/flat_addr_map.hpp"
+
+namespace common
+{
+
+class TemplateSearchUtils
+{
+public:
+  static bool HasAnyResult(ScMemoryContext * context, ScTemplate const & scTemplate);
+
+  static bool HasAnyResult(
+      ScMemoryContext * context,
+      ScAddr const & templateStructure,
+      std::map<ScAddr, ScAddr, ScAddrLessFunc> const & replacements);
+
+  static bool HasAnyResult(
+      ScMemoryContext * context,
+      ScAddr const & templateStructure,
+      FlatAddrMap const & replacements);
+
+private:
+  template <class TReplacements>
+  static bool HasAnyResultByStructure(
+      ScMemoryContext * context,
+      ScAddr const & templateStructure,
+      TReplacements const & replacements);
+};
+
+}  // namespace common
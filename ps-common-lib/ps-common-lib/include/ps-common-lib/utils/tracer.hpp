@@ -0,0 +1,145 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace common
+{
+
+// Process-wide tracer of nested spans. Spans are recorded only while the tracer is enabled, a disabled span costs one
+// atomic load. Every thread writes its spans to its own ring buffer without locks, so only the latest spans of each
+// thread are kept. Ring buffer is released when its thread exits, only the latest spans of finished threads are kept.
+class Tracer
+{
+public:
+  // Span is recorded when it is destroyed. Name and category should be string literals, they are stored as pointers.
+  class Span
+  {
+  public:
+    explicit Span(char const * name, char const * category = "common");
+
+    ~Span();
+
+    Span(Span const & other) = delete;
+
+    Span & operator=(Span const & other) = delete;
+
+  private:
+    char const * name;
+    char const * category;
+    uint64_t startTime;
+    uint64_t id;
+    uint64_t parentId;
+    bool isRecorded;
+  };
+
+  static size_t const RING_BUFFER_CAPACITY;
+
+  // Span of an interval that is measured outside of a scope, e.g. the waiting for an action. It has no parent span.
+  static void RecordInterval(
+      char const * name,
+      char const * category,
+      std::chrono::steady_clock::time_point const & startTime,
+      std::chrono::steady_clock::time_point const & endTime);
+
+  static void SetEnabled(bool isEnabled);
+
+  static bool IsEnabled();
+
+  static void ExportChromeTrace(std::ostream & stream);
+
+  // Tracer is shared by all modules of the process, so it is exported to the trace file once, when the last module
+  // that initialized it is shut down.
+  static void Initialize();
+
+  static void Shutdown();
+
+  static void ExportToFile();
+
+  static void Clear();
+
+private:
+  struct Event
+  {
+    char const * name;
+    char const * category;
+    uint64_t startTime;
+    uint64_t duration;
+    uint64_t id;
+    uint64_t parentId;
+  };
+
+  // Slot sequence is the number of the written event plus one, it is reset while the event is written. Fields are
+  // atomic, so readers don't race with the owning thread, and readers discard events whose sequence changes while
+  // they are read.
+  struct Slot
+  {
+    std::atomic<uint64_t> sequence{0};
+    std::atomic<char const *> name{nullptr};
+    std::atomic<char const *> category{nullptr};
+    std::atomic<uint64_t> startTime{0};
+    std::atomic<uint64_t> duration{0};
+    std::atomic<uint64_t> id{0};
+    std::atomic<uint64_t> parentId{0};
+  };
+
+  struct RingBuffer
+  {
+    size_t threadId;
+    std::atomic<uint64_t> eventsCount{0};
+    std::unique_ptr<Slot[]> slots;
+  };
+
+  // Owner is a thread-local object, so the ring buffer of the thread is released when the thread exits.
+  struct RingBufferOwner
+  {
+    std::shared_ptr<RingBuffer> ringBuffer;
+
+    ~RingBufferOwner();
+  };
+
+  struct FinishedThreadEvent
+  {
+    size_t threadId;
+    Event event;
+  };
+
+  static inline std::atomic_bool isTracingEnabled{false};
+  static inline std::mutex mutex;
+  static inline std::list<std::shared_ptr<RingBuffer>> ringBuffers;
+  static inline std::deque<FinishedThreadEvent> finishedThreadsEvents;
+  static inline size_t threadsCount = 0;
+  static inline size_t usersCount = 0;
+
+  static uint64_t GetTime();
+
+  static uint64_t ToTime(std::chrono::steady_clock::time_point const & timePoint);
+
+  static uint64_t GenerateSpanId();
+
+  static RingBuffer & GetThreadRingBuffer();
+
+  static uint64_t & GetCurrentSpanId();
+
+  static void Record(Event const & event);
+
+  static bool Read(Slot const & slot, uint64_t eventIndex, Event & event);
+
+  static void ReadAll(RingBuffer const & ringBuffer, std::vector<Event> & events);
+
+  static void Release(std::shared_ptr<RingBuffer> const & ringBuffer);
+
+  static void WriteChromeTraceEvent(std::ostream & stream, size_t threadId, Event const & event, bool & isFirst);
+
+  static std::string Escape(char const * string);
+};
+
+}  // namespace common
@@ -0,0 +1,195 @@
+#include "ps-common-lib/utils/compiled_template.hpp"
+
+#include "ps-common-lib/utils/macros.hpp"
+
+using namespace common;
+
+// Connectors of the structure are ordered so that every connector is added to the template before the triples
+// that contain it as a source or a target.
+CompiledTemplate::CompiledTemplate(ScMemoryContext * context, ScAddr const & structure)
+  : structure(structure)
+{
+  TRACE_SPAN("CompiledTemplate::CompiledTemplate");
+
+  ScAddrUnorderedSet structureConnectors;
+  ScAddrList pendingConnectors;
+  ScIterator3Ptr elementsIterator3 = context->CreateIterator3(structure, ScType::ConstPermPosArc, ScType::Unknown);
+  while (elementsIterator3->Next())
+  {
+    ScAddr const & element = elementsIterator3->Get(2);
+    ScType const type = context->GetElementType(element);
+    if (type.IsVar())
+      variables.insert(element);
+
+    if (type.IsConnector())
+    {
+      structureConnectors.insert(element);
+      pendingConnectors.push_back(element);
+    }
+  }
+
+  ScAddrUnorderedSet addedConnectors;
+  auto const & isAdded = [&structureConnectors, &addedConnectors](ScAddr const & element)
+  {
+    return !structureConnectors.count(element) || addedConnectors.count(element);
+  };
+
+  while (!pendingConnectors.empty())
+  {
+    size_t const pendingConnectorsCount = pendingConnectors.size();
+    for (auto it = pendingConnectors.begin(); it != pendingConnectors.end();)
+    {
+      auto const [source, target] = context->GetConnectorIncidentElements(*it);
+      if (isAdded(source) && isAdded(target))
+      {
+        triples.push_back({CreateItem(context, source), CreateItem(context, *it), CreateItem(context, target)});
+        addedConnectors.insert(*it);
+        it = pendingConnectors.erase(it);
+      }
+      else
+        ++it;
+    }
+
+    if (pendingConnectors.size() == pendingConnectorsCount)
+      SC_THROW_EXCEPTION(
+          utils::ExceptionInvalidParams, "CompiledTemplate: connectors of the structure form a cycle.");
+  }
+}
+
+void CompiledTemplate::Build(
+    ScTemplate & scTemplate,
+    std::map<ScAddr, ScAddr, ScAddrLessFunc> const & replacements) const
+{
+  Build(
+      scTemplate,
+      replacements,
+      [](ScAddr const &)
+      {
+        return true;
+      });
+}
+
+void CompiledTemplate::Build(
+    ScTemplate & scTemplate,
+    std::map<ScAddr, ScAddr, ScAddrLessFunc> const & replacements,
+    std::function<bool(ScAddr const & connector)> const & filter) const
+{
+  ScAddrUnorderedSet declaredVariables;
+  BuildTriples(scTemplate, replacements, filter, declaredVariables);
+}
+
+void CompiledTemplate::Build(ScTemplate & scTemplate, FlatAddrMap const & replacements) const
+{
+  Build(
+      scTemplate,
+      replacements,
+      [](ScAddr const &)
+      {
+        return true;
+      });
+}
+
+void CompiledTemplate::Build(
+    ScTemplate & scTemplate,
+    FlatAddrMap const & replacements,
+    std::function<bool(ScAddr const & connector)> const & filter) const
+{
+  ScAddrUnorderedSet declaredVariables;
+  BuildTriples(scTemplate, replacements, filter, declaredVariables);
+}
+
+void CompiledTemplate::Build(
+    ScTemplate & scTemplate,
+    std::map<ScAddr, ScAddr, ScAddrLessFunc> const & replacements,
+    ScAddrUnorderedSet & declaredVariables) const
+{
+  BuildTriples(
+      scTemplate,
+      replacements,
+      [](ScAddr const &)
+      {
+        return true;
+      },
+      declaredVariables);
+}
+
+void CompiledTemplate::Build(
+    ScTemplate & scTemplate,
+    FlatAddrMap const & replacements,
+    ScAddrUnorderedSet & declaredVariables) const
+{
+  BuildTriples(
+      scTemplate,
+      replacements,
+      [](ScAddr const &)
+      {
+        return true;
+      },
+      declaredVariables);
+}
+
+// Filtered triples keep the topological order, so a subset of the structure is built correctly as long as the filter
+// selects every connector that is a source or a target of the selected ones.
+template <class TReplacements>
+void CompiledTemplate::BuildTriples(
+    ScTemplate & scTemplate,
+    TReplacements const & replacements,
+    std::function<bool(ScAddr const & connector)> const & filter,
+    ScAddrUnorderedSet & declaredVariables) const
+{
+  for (auto const & triple : triples)
+  {
+    if (!filter(triple.connector.addr))
+      continue;
+
+    ScTemplateItem const source = GetTemplateItem(triple.source, replacements, declaredVariables);
+    ScTemplateItem const connector = GetTemplateItem(triple.connector, replacements, declaredVariables);
+    ScTemplateItem const target = GetTemplateItem(triple.target, replacements, declaredVariables);
+    scTemplate.Triple(source, connector, target);
+  }
+}
+
+ScAddr const & CompiledTemplate::GetStructure() const
+{
+  return structure;
+}
+
+size_t CompiledTemplate::GetTriplesCount() const
+{
+  return triples.size();
+}
+
+ScAddrUnorderedSet const & CompiledTemplate::GetVariables() const
+{
+  return variables;
+}
+
+std::string CompiledTemplate::GetVariableAlias(ScAddr const & variable)
+{
+  return std::to_string(variable.Hash());
+}
+
+CompiledTemplate::Item CompiledTemplate::CreateItem(ScMemoryContext * context, ScAddr const & addr)
+{
+  ScType const type = context->GetElementType(addr);
+  return {addr, type, type.IsVar() ? GetVariableAlias(addr) : ""};
+}
+
+template <class TReplacements>
+ScTemplateItem CompiledTemplate::GetTemplateItem(
+    Item const & item,
+    TReplacements const & replacements,
+    ScAddrUnorderedSet & declaredVariables)
+{
+  if (!item.type.IsVar())
+    return item.addr;
+
+  auto const & it = replacements.find(item.addr);
+  if (it != replacements.cend())
+    return it->second;
+
+  if (declaredVariables.insert(item.addr).second)
+    return item.type >> item.alias;
+
+  return item.alias;
+}
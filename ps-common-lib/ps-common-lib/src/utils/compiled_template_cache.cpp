@@ -0,0 +1,63 @@
+#include "ps-common-lib/utils/compiled_template_cache.hpp"
+
+#include "ps-common-lib/utils/macros.hpp"
+
+using namespace common;
+
+size_t const CompiledTemplateCache::CAPACITY = 1024;
+
+// Subscriptions are created before the structure is compiled, so changes made during compilation make the entry
+// stale instead of being lost.
+std::shared_ptr<CompiledTemplate const> CompiledTemplateCache::Get(
+    ScMemoryContext * context,
+    ScAddr const & structure)
+{
+  TRACE_SPAN("CompiledTemplateCache::Get");
+
+  return GetCache().Get(
+      structure,
+      [context, &structure](
+          ScAgentContext * eventsContext,
+          std::shared_ptr<std::atomic_bool> const & isStale,
+          std::list<std::shared_ptr<ScEventSubscription>> & subscriptions)
+      {
+        subscriptions = Subscribe(eventsContext, structure, isStale);
+        return std::make_shared<CompiledTemplate const>(context, structure);
+      });
+}
+
+void CompiledTemplateCache::Invalidate(ScAddr const & structure)
+{
+  GetCache().Invalidate(structure);
+}
+
+void CompiledTemplateCache::Clear()
+{
+  GetCache().Clear();
+}
+
+EventInvalidatedCache<CompiledTemplate const> & CompiledTemplateCache::GetCache()
+{
+  static EventInvalidatedCache<CompiledTemplate const> cache(CAPACITY);
+  return cache;
+}
+
+std::list<std::shared_ptr<ScEventSubscription>> CompiledTemplateCache::Subscribe(
+    ScAgentContext * context,
+    ScAddr const & structure,
+    std::shared_ptr<std::atomic_bool> const & isStale)
+{
+  using ElementAddedEvent = ScEventAfterGenerateOutgoingArc<ScType::ConstPermPosArc>;
+  using ElementRemovedEvent = ScEventBeforeEraseOutgoingArc<ScType::ConstPermPosArc>;
+
+  auto const & markStale = [isStale](auto const &)
+  {
+    *isStale = true;
+  };
+
+  std::list<std::shared_ptr<ScEventSubscription>> subscriptions;
+  subscriptions.push_back(context->CreateElementaryEventSubscription<ElementAddedEvent>(structure, markStale));
+  subscriptions.push_back(context->CreateElementaryEventSubscription<ElementRemovedEvent>(structure, markStale));
+  subscriptions.push_back(context->CreateElementaryEventSubscription<ScEventBeforeEraseElement>(structure, markStale));
+  return subscriptions;
+}
@@ -0,0 +1,184 @@
+#include "ps-common-lib/utils/flat_addr_map.hpp"
+
+#include <algorithm>
+
+using namespace common;
+
+FlatAddrMap::FlatAddrMap(std::initializer_list<value_type> items)
+{
+  for (auto const & item : items)
+    insert(item);
+}
+
+// Items of std::map are already sorted, so they are appended without searching.
+FlatAddrMap::FlatAddrMap(std::map<ScAddr, ScAddr, ScAddrLessFunc> const & items)
+{
+  if (items.size() > INLINE_CAPACITY)
+    heapItems.assign(items.cbegin(), items.cend());
+  else
+    std::copy(items.cbegin(), items.cend(), inlineItems.begin());
+  itemsCount = items.size();
+}
+
+// Moved map is left empty, its inline items can't be used without the heap items taken from it.
+FlatAddrMap::FlatAddrMap(FlatAddrMap && other) noexcept
+  : inlineItems(other.inlineItems)
+  , heapItems(std::move(other.heapItems))
+  , itemsCount(other.itemsCount)
+{
+  other.heapItems.clear();
+  other.itemsCount = 0;
+}
+
+FlatAddrMap & FlatAddrMap::operator=(FlatAddrMap && other) noexcept
+{
+  if (this == &other)
+    return *this;
+
+  inlineItems = other.inlineItems;
+  heapItems = std::move(other.heapItems);
+  itemsCount = other.itemsCount;
+  other.heapItems.clear();
+  other.itemsCount = 0;
+  return *this;
+}
+
+FlatAddrMap::iterator FlatAddrMap::begin()
+{
+  return GetItems();
+}
+
+FlatAddrMap::iterator FlatAddrMap::end()
+{
+  return GetItems() + itemsCount;
+}
+
+FlatAddrMap::const_iterator FlatAddrMap::begin() const
+{
+  return GetItems();
+}
+
+FlatAddrMap::const_iterator FlatAddrMap::end() const
+{
+  return GetItems() + itemsCount;
+}
+
+FlatAddrMap::const_iterator FlatAddrMap::cbegin() const
+{
+  return begin();
+}
+
+FlatAddrMap::const_iterator FlatAddrMap::cend() const
+{
+  return end();
+}
+
+size_t FlatAddrMap::size() const
+{
+  return itemsCount;
+}
+
+bool FlatAddrMap::empty() const
+{
+  return itemsCount == 0;
+}
+
+FlatAddrMap::iterator FlatAddrMap::find(ScAddr const & key)
+{
+  return begin() + (static_cast<FlatAddrMap const &>(*this).find(key) - cbegin());
+}
+
+FlatAddrMap::const_iterator FlatAddrMap::find(ScAddr const & key) const
+{
+  const_iterator const it = LowerBound(key);
+  return it != cend() && it->first == key ? it : cend();
+}
+
+size_t FlatAddrMap::count(ScAddr const & key) const
+{
+  return find(key) != cend();
+}
+
+ScAddr & FlatAddrMap::operator[](ScAddr const & key)
+{
+  return emplace(key, ScAddr::Empty).first->second;
+}
+
+std::pair<FlatAddrMap::iterator, bool> FlatAddrMap::insert(value_type const & item)
+{
+  return emplace(item.first, item.second);
+}
+
+// Items are moved to the heap once the inline storage is full and stay there until the map is cleared.
+std::pair<FlatAddrMap::iterator, bool> FlatAddrMap::emplace(ScAddr const & key, ScAddr const & value)
+{
+  size_t const index = LowerBound(key) - cbegin();
+  if (index < itemsCount && GetItems()[index].first == key)
+    return {begin() + index, false};
+
+  if (heapItems.empty() && itemsCount == INLINE_CAPACITY)
+  {
+    heapItems.reserve(INLINE_CAPACITY * 2);
+    heapItems.assign(inlineItems.cbegin(), inlineItems.cend());
+  }
+
+  if (heapItems.empty())
+  {
+    std::move_backward(
+        inlineItems.begin() + index, inlineItems.begin() + itemsCount, inlineItems.begin() + itemsCount + 1);
+    inlineItems[index] = {key, value};
+  }
+  else
+    heapItems.insert(heapItems.begin() + index, {key, value});
+
+  itemsCount++;
+  return {begin() + index, true};
+}
+
+size_t FlatAddrMap::erase(ScAddr const & key)
+{
+  iterator const it = find(key);
+  if (it == end())
+    return 0;
+
+  if (heapItems.empty())
+    std::move(it + 1, end(), it);
+  else
+    heapItems.erase(heapItems.begin() + (it - begin()));
+  itemsCount--;
+  return 1;
+}
+
+void FlatAddrMap::clear()
+{
+  heapItems.clear();
+  heapItems.shrink_to_fit();
+  itemsCount = 0;
+}
+
+std::map<ScAddr, ScAddr, ScAddrLessFunc> FlatAddrMap::ToMap() const
+{
+  return {cbegin(), cend()};
+}
+
+FlatAddrMap::value_type * FlatAddrMap::GetItems()
+{
+  return heapItems.empty() ? inlineItems.data() : heapItems.data();
+}
+
+FlatAddrMap::value_type const * FlatAddrMap::GetItems() const
+{
+  return heapItems.empty() ? inlineItems.data() : heapItems.data();
+}
+
+FlatAddrMap::const_iterator FlatAddrMap::LowerBound(ScAddr const & key) const
+{
+  return std::lower_bound(
+      cbegin(),
+      cend(),
+      key,
+      [](value_type const & item, ScAddr const & itemKey)
+      {
+        return ScAddrLessFunc()(item.first, itemKey);
+      });
+}
@@ -1,36 +1,409 @@
 #include "ps-common-lib/utils/logic_utils.hpp"
 
+#include <algorithm>
+
 #include <sc-agents-common/utils/CommonUtils.hpp>
 
 #include "ps-common-lib/keynodes.hpp"
-#include "ps-common-lib/utils/template_params_utils.hpp"
+#include "ps-common-lib/utils/compiled_template_cache.hpp"
+#include "ps-common-lib/utils/macros.hpp"
+#include "ps-common-lib/utils/template_search_utils.hpp"
 
 using namespace common;
 
+size_t const LogicUtils::FORMULA_PLANS_CAPACITY = 1024;
+
+// Sub-formulas of compound formulas are checked in order of their cost and the check stops as soon as the result is
+// known. Atomic conjuncts with common variables are checked together and the conclusion of an implication is checked
+// for every match of its premise, other sub-formulas are checked independently, so their common variables should be
+// bound by replacements.
 bool LogicUtils::CheckLogicalFormula(
     ScMemoryContext * context,
     ScAddr const & logicFormula,
     std::map<ScAddr, ScAddr, ScAddrLessFunc> const & replacements)
 {
+  return CheckAnyLogicalFormula(context, logicFormula, replacements);
+}
+
+// Flat replacements are searched without heap allocations, so frequently checked formulas, e.g. guards of
+// transitions, should be checked with them.
+bool LogicUtils::CheckLogicalFormula(
+    ScMemoryContext * context,
+    ScAddr const & logicFormula,
+    FlatAddrMap const & replacements)
+{
+  return CheckAnyLogicalFormula(context, logicFormula, replacements);
+}
+
+template <class TReplacements>
+bool LogicUtils::CheckAnyLogicalFormula(
+    ScMemoryContext * context,
+    ScAddr const & logicFormula,
+    TReplacements const & replacements)
+{
+  TRACE_SPAN("LogicUtils::CheckAnyLogicalFormula");
+
+  std::shared_ptr<FormulaPlan const> const plan = GetFormulaPlan(context, logicFormula);
   bool result = false;
 
-  if (utils::CommonUtils::checkType(context, logicFormula, ScType::ConstNodeStructure)
-      && context->CheckConnector(Keynodes::atomic_logical_formula, logicFormula, ScType::ConstPermPosArc))
+  if (plan->kind == FormulaKind::Atomic)
+    result = TemplateSearchUtils::HasAnyResult(context, logicFormula, replacements);
+  else if (plan->kind == FormulaKind::Conjunction)
+    result = CheckCompoundLogicalFormula(context, *plan, replacements, false);
+  else if (plan->kind == FormulaKind::Disjunction)
+    result = CheckCompoundLogicalFormula(context, *plan, replacements, true);
+  else if (plan->kind == FormulaKind::Negation)
+    result = !CheckGroup(context, plan->groups.front(), replacements);
+  else
+    result = CheckImplication(context, *plan, replacements);
+
+  return result;
+}
+
+// Templates of all atomic sub-formulas are compiled when the plan of the formula is built, so the formula can be
+// prepared in advance and the later check only searches by the compiled templates.
+void LogicUtils::PrepareLogicalFormula(ScMemoryContext * context, ScAddr const & logicFormula)
+{
+  TRACE_SPAN("LogicUtils::PrepareLogicalFormula");
+
+  GetFormulaPlan(context, logicFormula);
+}
+
+void LogicUtils::ClearFormulaPlans()
+{
+  GetFormulaPlans().Clear();
+}
+
+// Group of atomic formulas is checked by one template, so their common variables are bound to the same elements.
+template <class TReplacements>
+bool LogicUtils::CheckGroup(ScMemoryContext * context, ScAddrVector const & group, TReplacements const & replacements)
+{
+  if (group.size() == 1)
+    return CheckAnyLogicalFormula(context, group.front(), replacements);
+
+  ScTemplate scTemplate;
+  ScAddrUnorderedSet declaredVariables;
+  for (auto const & formula : group)
+    CompiledTemplateCache::Get(context, formula)->Build(scTemplate, replacements, declaredVariables);
+  return TemplateSearchUtils::HasAnyResult(context, scTemplate);
+}
+
+// Conjunction stops on the first false group and disjunction stops on the first true one.
+template <class TReplacements>
+bool LogicUtils::CheckCompoundLogicalFormula(
+    ScMemoryContext * context,
+    FormulaPlan const & plan,
+    TReplacements const & replacements,
+    bool resultToStop)
+{
+  for (auto const & group : plan.groups)
   {
-    ScTemplateParams formulaTemplateParams =
-        TemplateParamsUtils::CreateTemplateParamsFromReplacements(context, replacements, logicFormula);
+    if (CheckGroup(context, group, replacements) == resultToStop)
+      return resultToStop;
+  }
+
+  return !resultToStop;
+}
 
-    ScTemplate formulaTemplate;
-    context->BuildTemplate(formulaTemplate, logicFormula, formulaTemplateParams);
-    ScTemplateSearchResult formulaSearchResult;
-    context->SearchByTemplate(formulaTemplate, formulaSearchResult);
+// Implication is false only if its premise is true and its conclusion is false, so the premise is checked first
+// only if it is cheaper than the conclusion. Unbound variables common to the premise and the conclusion are bound by
+// every match of the premise, and the implication is false as soon as the conclusion fails for one of them.
+template <class TReplacements>
+bool LogicUtils::CheckImplication(
+    ScMemoryContext * context,
+    FormulaPlan const & plan,
+    TReplacements const & replacements)
+{
+  ScAddrVector const & premise = plan.groups.front();
+  ScAddrVector const & conclusion = plan.groups.back();
 
-    result = !formulaSearchResult.IsEmpty();
+  ScAddrVector unboundVariables;
+  for (auto const & variable : plan.commonVariables)
+  {
+    if (!replacements.count(variable))
+      unboundVariables.push_back(variable);
   }
-  else
+
+  if (unboundVariables.empty())
+  {
+    if (plan.isPremiseFirst)
+      return !CheckGroup(context, premise, replacements) || CheckGroup(context, conclusion, replacements);
+
+    return CheckGroup(context, conclusion, replacements) || !CheckGroup(context, premise, replacements);
+  }
+
+  if (!IsAtomicLogicalFormula(context, premise.front()))
     SC_THROW_EXCEPTION(
         utils::ExceptionNotImplemented,
-        "LogicUtils: the statement cannot be checked - only atomic logical formulas are currently supported.");
+        "LogicUtils: premise of implication that has unbound variables common with its conclusion should be an "
+        "atomic logical formula.");
 
-  return result;
+  ScTemplate premiseTemplate;
+  CompiledTemplateCache::Get(context, premise.front())->Build(premiseTemplate, replacements);
+
+  std::vector<ScAddrVector> premiseMatches;
+  context->SearchByTemplateInterruptibly(
+      premiseTemplate,
+      [&premiseMatches, &unboundVariables](ScTemplateSearchResultItem const & item) -> ScTemplateSearchRequest
+      {
+        ScAddrVector values;
+        for (auto const & variable : unboundVariables)
+          values.push_back(item[CompiledTemplate::GetVariableAlias(variable)]);
+        premiseMatches.push_back(std::move(values));
+        return ScTemplateSearchRequest::CONTINUE;
+      });
+
+  for (auto const & values : premiseMatches)
+  {
+    TReplacements conclusionReplacements = replacements;
+    for (size_t index = 0; index < unboundVariables.size(); index++)
+      conclusionReplacements[unboundVariables[index]] = values[index];
+
+    if (!CheckGroup(context, conclusion, conclusionReplacements))
+      return false;
+  }
+
+  return true;
+}
+
+bool LogicUtils::IsAtomicLogicalFormula(ScMemoryContext * context, ScAddr const & logicFormula)
+{
+  return utils::CommonUtils::checkType(context, logicFormula, ScType::ConstNodeStructure)
+         && context->CheckConnector(Keynodes::atomic_logical_formula, logicFormula, ScType::ConstPermPosArc);
+}
+
+bool LogicUtils::IsImplication(ScMemoryContext * context, ScAddr const & logicFormula)
+{
+  return context->GetElementType(logicFormula).IsCommonArc()
+         && context->CheckConnector(Keynodes::nrel_implication, logicFormula, ScType::ConstPermPosArc);
+}
+
+EventInvalidatedCache<LogicUtils::FormulaPlan const> & LogicUtils::GetFormulaPlans()
+{
+  static EventInvalidatedCache<FormulaPlan const> formulaPlans(FORMULA_PLANS_CAPACITY);
+  return formulaPlans;
+}
+
+// Formulas of the tree are known only after the plan is built, so the plan is subscribed after it is built.
+std::shared_ptr<LogicUtils::FormulaPlan const> LogicUtils::GetFormulaPlan(
+    ScMemoryContext * context,
+    ScAddr const & logicFormula)
+{
+  return GetFormulaPlans().Get(
+      logicFormula,
+      [context, &logicFormula](
+          ScAgentContext * eventsContext,
+          std::shared_ptr<std::atomic_bool> const & isStale,
+          std::list<std::shared_ptr<ScEventSubscription>> & subscriptions)
+      {
+        std::shared_ptr<FormulaPlan const> plan = BuildFormulaPlan(context, logicFormula);
+        subscriptions = SubscribeFormulaPlan(eventsContext, plan->formulas, isStale);
+        return plan;
+      });
+}
+
+// Cost of an atomic formula is estimated by the number of triples of its template, cost of a compound formula is the
+// sum of costs of its sub-formulas.
+std::shared_ptr<LogicUtils::FormulaPlan const> LogicUtils::BuildFormulaPlan(
+    ScMemoryContext * context,
+    ScAddr const & logicFormula)
+{
+  TRACE_SPAN("LogicUtils::BuildFormulaPlan");
+
+  auto plan = std::make_shared<FormulaPlan>();
+  plan->kind = GetFormulaKind(context, logicFormula);
+  plan->cost = 0;
+  plan->isPremiseFirst = true;
+  plan->formulas.push_back(logicFormula);
+  if (plan->kind == FormulaKind::Atomic)
+  {
+    plan->cost = CompiledTemplateCache::Get(context, logicFormula)->GetTriplesCount();
+    return plan;
+  }
+
+  ScAddrVector subFormulas;
+  if (plan->kind == FormulaKind::Implication)
+  {
+    auto const [premise, conclusion] = context->GetConnectorIncidentElements(logicFormula);
+    subFormulas = {premise, conclusion};
+  }
+  else
+  {
+    ScIterator3Ptr subFormulasIterator3 =
+        context->CreateIterator3(logicFormula, ScType::ConstPermPosArc, ScType::Unknown);
+    while (subFormulasIterator3->Next())
+      subFormulas.push_back(subFormulasIterator3->Get(2));
+  }
+
+  if (plan->kind == FormulaKind::Negation && subFormulas.size() != 1)
+    SC_THROW_EXCEPTION(utils::ExceptionInvalidParams, "LogicUtils: negation should contain exactly one formula.");
+
+  std::unordered_map<ScAddr, size_t, ScAddrHashFunc> costs;
+  for (auto const & subFormula : subFormulas)
+  {
+    std::shared_ptr<FormulaPlan const> const subFormulaPlan = GetFormulaPlan(context, subFormula);
+    costs[subFormula] = subFormulaPlan->cost;
+    plan->cost += subFormulaPlan->cost;
+    plan->formulas.insert(plan->formulas.end(), subFormulaPlan->formulas.cbegin(), subFormulaPlan->formulas.cend());
+  }
+
+  if (plan->kind == FormulaKind::Implication)
+  {
+    plan->groups = {{subFormulas.front()}, {subFormulas.back()}};
+    plan->isPremiseFirst = costs[subFormulas.front()] <= costs[subFormulas.back()];
+    plan->commonVariables = GetCommonVariables(context, subFormulas.front(), subFormulas.back());
+    return plan;
+  }
+
+  if (plan->kind == FormulaKind::Conjunction)
+    plan->groups = GroupConjuncts(context, subFormulas);
+  else
+  {
+    for (auto const & subFormula : subFormulas)
+      plan->groups.push_back({subFormula});
+  }
+
+  std::vector<std::pair<size_t, ScAddrVector>> groups;
+  for (auto & group : plan->groups)
+  {
+    size_t groupCost = 0;
+    for (auto const & subFormula : group)
+      groupCost += costs[subFormula];
+    groups.emplace_back(groupCost, std::move(group));
+  }
+
+  std::stable_sort(
+      groups.begin(),
+      groups.end(),
+      [](auto const & first, auto const & second)
+      {
+        return first.first < second.first;
+      });
+
+  plan->groups.clear();
+  for (auto & [cost, group] : groups)
+    plan->groups.push_back(std::move(group));
+  return plan;
+}
+
+LogicUtils::FormulaKind LogicUtils::GetFormulaKind(ScMemoryContext * context, ScAddr const & logicFormula)
+{
+  if (IsAtomicLogicalFormula(context, logicFormula))
+    return FormulaKind::Atomic;
+  else if (context->CheckConnector(Keynodes::conjunction, logicFormula, ScType::ConstPermPosArc))
+    return FormulaKind::Conjunction;
+  else if (context->CheckConnector(Keynodes::disjunction, logicFormula, ScType::ConstPermPosArc))
+    return FormulaKind::Disjunction;
+  else if (context->CheckConnector(Keynodes::negation, logicFormula, ScType::ConstPermPosArc))
+    return FormulaKind::Negation;
+  else if (IsImplication(context, logicFormula))
+    return FormulaKind::Implication;
+
+  SC_THROW_EXCEPTION(
+      utils::ExceptionNotImplemented,
+      "LogicUtils: the statement cannot be checked - only atomic logical formulas, conjunctions, disjunctions, "
+      "negations and implications are currently supported.");
+}
+
+// Variables of a compound formula are variables of all its atomic sub-formulas.
+ScAddrUnorderedSet LogicUtils::GetVariables(ScMemoryContext * context, ScAddr const & logicFormula)
+{
+  ScAddrUnorderedSet variables;
+  for (auto const & formula : GetFormulaPlan(context, logicFormula)->formulas)
+  {
+    if (IsAtomicLogicalFormula(context, formula))
+    {
+      ScAddrUnorderedSet const & formulaVariables = CompiledTemplateCache::Get(context, formula)->GetVariables();
+      variables.insert(formulaVariables.cbegin(), formulaVariables.cend());
+    }
+  }
+  return variables;
+}
+
+ScAddrVector LogicUtils::GetCommonVariables(
+    ScMemoryContext * context,
+    ScAddr const & premise,
+    ScAddr const & conclusion)
+{
+  ScAddrUnorderedSet const & premiseVariables = GetVariables(context, premise);
+  ScAddrVector commonVariables;
+  for (auto const & variable : GetVariables(context, conclusion))
+  {
+    if (premiseVariables.count(variable))
+      commonVariables.push_back(variable);
+  }
+  return commonVariables;
+}
+
+// Atomic conjuncts are grouped if they have common variables, even if the variables are bound by replacements, so
+// grouping doesn't depend on replacements. Variables of compound conjuncts are bound only by replacements.
+std::vector<ScAddrVector> LogicUtils::GroupConjuncts(ScMemoryContext * context, ScAddrVector const & conjuncts)
+{
+  std::vector<ScAddrVector> groups;
+  std::vector<ScAddrUnorderedSet> groupsVariables;
+  for (auto const & conjunct : conjuncts)
+  {
+    ScAddrVector group = {conjunct};
+    ScAddrUnorderedSet variables;
+    if (IsAtomicLogicalFormula(context, conjunct))
+      variables = CompiledTemplateCache::Get(context, conjunct)->GetVariables();
+
+    for (size_t groupIndex = 0; groupIndex < groups.size();)
+    {
+      bool const hasCommonVariables = std::any_of(
+          variables.cbegin(),
+          variables.cend(),
+          [&groupVariables = groupsVariables[groupIndex]](ScAddr const & variable)
+          {
+            return groupVariables.count(variable);
+          });
+      if (!hasCommonVariables)
+      {
+        groupIndex++;
+        continue;
+      }
+
+      group.insert(group.end(), groups[groupIndex].cbegin(), groups[groupIndex].cend());
+      variables.insert(groupsVariables[groupIndex].cbegin(), groupsVariables[groupIndex].cend());
+      groups.erase(groups.begin() + groupIndex);
+      groupsVariables.erase(groupsVariables.begin() + groupIndex);
+    }
+
+    groups.push_back(std::move(group));
+    groupsVariables.push_back(std::move(variables));
+  }
+  return groups;
+}
+
+// Plan depends on classes of the formulas, their sub-formulas and triples of atomic formulas, so all of them are
+// watched by arcs from and to the formulas.
+std::list<std::shared_ptr<ScEventSubscription>> LogicUtils::SubscribeFormulaPlan(
+    ScAgentContext * context,
+    ScAddrVector const & formulas,
+    std::shared_ptr<std::atomic_bool> const & isStale)
+{
+  using ElementAddedEvent = ScEventAfterGenerateOutgoingArc<ScType::ConstPermPosArc>;
+  using ElementRemovedEvent = ScEventBeforeEraseOutgoingArc<ScType::ConstPermPosArc>;
+  using ClassAddedEvent = ScEventAfterGenerateIncomingArc<ScType::ConstPermPosArc>;
+  using ClassRemovedEvent = ScEventBeforeEraseIncomingArc<ScType::ConstPermPosArc>;
+
+  auto const & markStale = [isStale](auto const &)
+  {
+    *isStale = true;
+  };
+
+  std::list<std::shared_ptr<ScEventSubscription>> subscriptions;
+  ScAddrUnorderedSet subscribedFormulas;
+  for (auto const & formula : formulas)
+  {
+    if (!subscribedFormulas.insert(formula).second)
+      continue;
+
+    subscriptions.push_back(context->CreateElementaryEventSubscription<ElementAddedEvent>(formula, markStale));
+    subscriptions.push_back(context->CreateElementaryEventSubscription<ElementRemovedEvent>(formula, markStale));
+    subscriptions.push_back(context->CreateElementaryEventSubscription<ClassAddedEvent>(formula, markStale));
+    subscriptions.push_back(context->CreateElementaryEventSubscription<ClassRemovedEvent>(formula, markStale));
+    subscriptions.push_back(context->CreateElementaryEventSubscription<ScEventBeforeEraseElement>(formula, markStale));
+  }
+  return subscriptions;
 }
@@ -1,20 +1,43 @@
 #include <algorithm>
+#include <functional>
 
+#include "ps-common-lib/utils/macros.hpp"
 #include "ps-common-lib/utils/relation_utils.hpp"
 
 using namespace common;
 
+// Connectors are collected before erasing, so the iterator doesn't go over the erased elements.
 void RelationUtils::EraseAllConnectors(
     ScMemoryContext * context,
     ScAddr const & source,
     ScAddr const & target,
     ScType const & connectorType)
 {
+  TRACE_SPAN("RelationUtils::EraseAllConnectors");
+
+  ScAddrVector connectors;
   ScIterator3Ptr iterator3 = context->CreateIterator3(source, connectorType, target);
   while (iterator3->Next())
-  {
-    context->EraseElement(iterator3->Get(1));
-  }
+    connectors.push_back(iterator3->Get(1));
+  EraseConnectors(context, connectors);
+}
+
+void RelationUtils::EraseAllIncomingConnectors(
+    ScMemoryContext * context,
+    ScAddr const & node,
+    ScType const & connectorType,
+    ScAddrVector const & addrVector)
+{
+  EraseIncidentConnectors(context, node, connectorType, addrVector, true);
+}
+
+void RelationUtils::EraseAllOutgoingConnectors(
+    ScMemoryContext * context,
+    ScAddr const & node,
+    ScType const & connectorType,
+    ScAddrVector const & addrVector)
+{
+  EraseIncidentConnectors(context, node, connectorType, addrVector, false);
 }
 
 bool RelationUtils::CheckRelationBetween(
@@ -33,13 +56,7 @@ bool RelationUtils::CheckAllIncomingConnectors(
     ScType const & connectorType,
     ScAddrVector const & addrVector)
 {
-  return std::all_of(
-      addrVector.cbegin(),
-      addrVector.cend(),
-      [context, &node, &connectorType](auto const & addr)
-      {
-        return context->CheckConnector(addr, node, connectorType);
-      });
+  return GetMissingConnectors(context, node, connectorType, addrVector, true, true).empty();
 }
 
 bool RelationUtils::CheckAllOutgoingConnectors(
@@ -48,11 +65,138 @@ bool RelationUtils::CheckAllOutgoingConnectors(
     ScType const & connectorType,
     ScAddrVector const & addrVector)
 {
-  return std::all_of(
-      addrVector.cbegin(),
-      addrVector.cend(),
-      [context, &node, &connectorType](auto const & addr)
-      {
-        return context->CheckConnector(node, addr, connectorType);
-      });
+  return GetMissingConnectors(context, node, connectorType, addrVector, false, true).empty();
+}
+
+ScAddrVector RelationUtils::GetMissingIncomingConnectors(
+    ScMemoryContext * context,
+    ScAddr const & node,
+    ScType const & connectorType,
+    ScAddrVector const & addrVector)
+{
+  return GetMissingConnectors(context, node, connectorType, addrVector, true, false);
+}
+
+ScAddrVector RelationUtils::GetMissingOutgoingConnectors(
+    ScMemoryContext * context,
+    ScAddr const & node,
+    ScType const & connectorType,
+    ScAddrVector const & addrVector)
+{
+  return GetMissingConnectors(context, node, connectorType, addrVector, false, false);
+}
+
+// Each check of a connector is a separate search in sc-memory, while one scan of incident connectors of the node
+// answers all of the checks. The scan is chosen if the node has not much more incident connectors than the number of
+// checks.
+bool RelationUtils::IsScanCheaper(size_t nodeDegree, size_t checksCount)
+{
+  return checksCount >= BULK_CHECK_MIN_SIZE && nodeDegree <= checksCount * BULK_CHECK_DEGREE_RATIO;
+}
+
+ScAddrUnorderedSet RelationUtils::GetIncidentElements(
+    ScMemoryContext * context,
+    ScAddr const & node,
+    ScType const & connectorType,
+    bool isIncoming)
+{
+  ScAddrUnorderedSet elements;
+  ScIterator3Ptr iterator3 = isIncoming ? context->CreateIterator3(ScType::Unknown, connectorType, node)
+                                        : context->CreateIterator3(node, connectorType, ScType::Unknown);
+  while (iterator3->Next())
+    elements.insert(iterator3->Get(isIncoming ? 0 : 2));
+  return elements;
+}
+
+ScAddrVector RelationUtils::GetMissingConnectors(
+    ScMemoryContext * context,
+    ScAddr const & node,
+    ScType const & connectorType,
+    ScAddrVector const & addrVector,
+    bool isIncoming,
+    bool stopOnFirst)
+{
+  TRACE_SPAN("RelationUtils::GetMissingConnectors");
+
+  size_t const nodeDegree = isIncoming ? context->GetElementEdgesAndIncomingArcsCount(node)
+                                       : context->GetElementEdgesAndOutgoingArcsCount(node);
+  std::function<bool(ScAddr const &)> hasConnector;
+  ScAddrUnorderedSet incidentElements;
+  if (IsScanCheaper(nodeDegree, addrVector.size()))
+  {
+    incidentElements = GetIncidentElements(context, node, connectorType, isIncoming);
+    hasConnector = [&incidentElements](ScAddr const & addr)
+    {
+      return incidentElements.count(addr);
+    };
+  }
+  else
+    hasConnector = [context, &node, &connectorType, isIncoming](ScAddr const & addr)
+    {
+      return isIncoming ? context->CheckConnector(addr, node, connectorType)
+                        : context->CheckConnector(node, addr, connectorType);
+    };
+
+  ScAddrVector missingElements;
+  for (auto const & addr : addrVector)
+  {
+    if (hasConnector(addr))
+      continue;
+    missingElements.push_back(addr);
+    if (stopOnFirst)
+      break;
+  }
+  return missingElements;
+}
+
+// Connectors are found in the same way as they are checked: incident connectors of the node are scanned once if the
+// scan is cheaper than the searches of connectors of each element. Found connectors are erased in batches.
+void RelationUtils::EraseIncidentConnectors(
+    ScMemoryContext * context,
+    ScAddr const & node,
+    ScType const & connectorType,
+    ScAddrVector const & addrVector,
+    bool isIncoming)
+{
+  TRACE_SPAN("RelationUtils::EraseIncidentConnectors");
+
+  size_t const nodeDegree = isIncoming ? context->GetElementEdgesAndIncomingArcsCount(node)
+                                       : context->GetElementEdgesAndOutgoingArcsCount(node);
+  ScAddrUnorderedSet const elements(addrVector.cbegin(), addrVector.cend());
+  ScAddrVector connectors;
+  if (IsScanCheaper(nodeDegree, elements.size()))
+  {
+    ScIterator3Ptr iterator3 = isIncoming ? context->CreateIterator3(ScType::Unknown, connectorType, node)
+                                          : context->CreateIterator3(node, connectorType, ScType::Unknown);
+    while (iterator3->Next())
+    {
+      if (elements.count(iterator3->Get(isIncoming ? 0 : 2)))
+        connectors.push_back(iterator3->Get(1));
+    }
+  }
+  else
+  {
+    for (auto const & element : elements)
+    {
+      ScIterator3Ptr iterator3 = isIncoming ? context->CreateIterator3(element, connectorType, node)
+                                            : context->CreateIterator3(node, connectorType, element);
+      while (iterator3->Next())
+        connectors.push_back(iterator3->Get(1));
+    }
+  }
+  EraseConnectors(context, connectors);
+}
+
+// sc-events of erased connectors are pending until the whole batch is erased, so subscribers are not called between
+// erasures of connectors that are erased together.
+void RelationUtils::EraseConnectors(ScMemoryContext * context, ScAddrVector const & connectors)
+{
+  for (size_t batchBegin = 0; batchBegin < connectors.size(); batchBegin += ERASE_BATCH_SIZE)
+  {
+    size_t const batchEnd = std::min(connectors.size(), batchBegin + ERASE_BATCH_SIZE);
+    context->BeginEventsPending();
+    for (size_t index = batchBegin; index < batchEnd; index++)
+      context->EraseElement(connectors[index]);
+    context->EndEventsPending();
+  }
 }
@@ -1,10 +1,48 @@
 #include "ps-common-lib/utils/template_params_utils.hpp"
 
+#include "ps-common-lib/utils/macros.hpp"
+
 using namespace common;
 
+size_t const TemplateParamsUtils::STRUCTURE_VARIABLES_CAPACITY = 1024;
+
 ScTemplateParams TemplateParamsUtils::CreateTemplateParamsFromReplacements(
     std::map<ScAddr, ScAddr, ScAddrLessFunc> const & replacements)
 {
+  return CreateTemplateParams(replacements);
+}
+
+ScTemplateParams TemplateParamsUtils::CreateTemplateParamsFromReplacements(
+    ScMemoryContext * context,
+    std::map<ScAddr, ScAddr, ScAddrLessFunc> const & replacements,
+    ScAddr const & structure)
+{
+  return CreateTemplateParamsForStructure(context, replacements, structure);
+}
+
+ScTemplateParams TemplateParamsUtils::CreateTemplateParamsFromReplacements(FlatAddrMap const & replacements)
+{
+  return CreateTemplateParams(replacements);
+}
+
+ScTemplateParams TemplateParamsUtils::CreateTemplateParamsFromReplacements(
+    ScMemoryContext * context,
+    FlatAddrMap const & replacements,
+    ScAddr const & structure)
+{
+  return CreateTemplateParamsForStructure(context, replacements, structure);
+}
+
+void TemplateParamsUtils::ClearStructureVariables()
+{
+  GetStructureVariablesCache().Clear();
+}
+
+template <class TReplacements>
+ScTemplateParams TemplateParamsUtils::CreateTemplateParams(TReplacements const & replacements)
+{
+  TRACE_SPAN("TemplateParamsUtils::CreateTemplateParams");
+
   ScTemplateParams templateParams;
   for (auto const & [varAddr, value] : replacements)
     templateParams.Add(varAddr, value);
@@ -12,17 +50,89 @@ ScTemplateParams TemplateParamsUtils::CreateTemplateParamsFromReplacements(
   return templateParams;
 }
 
-ScTemplateParams TemplateParamsUtils::CreateTemplateParamsFromReplacements(
+// Variables of the structure are cached and invalidated by sc-events, so params are built by the intersection of the
+// replacements with the variables without access to the knowledge base. The smaller of the two sets is iterated.
+template <class TReplacements>
+ScTemplateParams TemplateParamsUtils::CreateTemplateParamsForStructure(
     ScMemoryContext * context,
-    std::map<ScAddr, ScAddr, ScAddrLessFunc> const & replacements,
+    TReplacements const & replacements,
     ScAddr const & structure)
 {
+  TRACE_SPAN("TemplateParamsUtils::CreateTemplateParamsForStructure");
+
   ScTemplateParams templateParams;
-  for (auto const & [varAddr, value] : replacements)
+  if (replacements.empty())
+    return templateParams;
+
+  std::shared_ptr<ScAddrUnorderedSet const> const & structureVariables = GetStructureVariables(context, structure);
+  ScAddrUnorderedSet const & variables = *structureVariables;
+  if (replacements.size() <= variables.size())
   {
-    if (context->CheckConnector(structure, varAddr, ScType::ConstPermPosArc))
-      templateParams.Add(varAddr, value);
+    for (auto const & [varAddr, value] : replacements)
+    {
+      if (variables.count(varAddr))
+        templateParams.Add(varAddr, value);
+    }
+  }
+  else
+  {
+    for (auto const & varAddr : variables)
+    {
+      auto const & it = replacements.find(varAddr);
+      if (it != replacements.cend())
+        templateParams.Add(varAddr, it->second);
+    }
   }
 
   return templateParams;
 }
+
+EventInvalidatedCache<ScAddrUnorderedSet const> & TemplateParamsUtils::GetStructureVariablesCache()
+{
+  static EventInvalidatedCache<ScAddrUnorderedSet const> cache(STRUCTURE_VARIABLES_CAPACITY);
+  return cache;
+}
+
+// Only variables of the structure are collected instead of compiling it as a template, so params are built for any
+// structure, e.g. for the one whose connectors form a cycle. Subscriptions are created before the variables are
+// collected, so changes made meanwhile make the entry stale instead of being lost.
+std::shared_ptr<ScAddrUnorderedSet const> TemplateParamsUtils::GetStructureVariables(
+    ScMemoryContext * context,
+    ScAddr const & structure)
+{
+  return GetStructureVariablesCache().Get(
+      structure,
+      [context, &structure](
+          ScAgentContext * eventsContext,
+          std::shared_ptr<std::atomic_bool> const & isStale,
+          std::list<std::shared_ptr<ScEventSubscription>> & subscriptions)
+      {
+        subscriptions = SubscribeStructure(eventsContext, structure, isStale);
+
+        auto variables = std::make_shared<ScAddrUnorderedSet>();
+        ScIterator3Ptr elementsIterator3 = context->CreateIterator3(structure, ScType::ConstPermPosArc, ScType::Var);
+        while (elementsIterator3->Next())
+          variables->insert(elementsIterator3->Get(2));
+        return std::shared_ptr<ScAddrUnorderedSet const>(std::move(variables));
+      });
+}
+
+std::list<std::shared_ptr<ScEventSubscription>> TemplateParamsUtils::SubscribeStructure(
+    ScAgentContext * context,
+    ScAddr const & structure,
+    std::shared_ptr<std::atomic_bool> const & isStale)
+{
+  using ElementAddedEvent = ScEventAfterGenerateOutgoingArc<ScType::ConstPermPosArc>;
+  using ElementRemovedEvent = ScEventBeforeEraseOutgoingArc<ScType::ConstPermPosArc>;
+
+  auto const & markStale = [isStale](auto const &)
+  {
+    *isStale = true;
+  };
+
+  std::list<std::shared_ptr<ScEventSubscription>> subscriptions;
+  subscriptions.push_back(context->CreateElementaryEventSubscription<ElementAddedEvent>(structure, markStale));
+  subscriptions.push_back(context->CreateElementaryEventSubscription<ElementRemovedEvent>(structure, markStale));
+  subscriptions.push_back(context->CreateElementaryEventSubscription<ScEventBeforeEraseElement>(structure, markStale));
+  return subscriptions;
+}
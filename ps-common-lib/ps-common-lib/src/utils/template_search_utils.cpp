@@ -0,0 +1,51 @@
+#include "ps-common-lib/utils/template_search_utils.hpp"
+
+#include "ps-common-lib/utils/compiled_template_cache.hpp"
+#include "ps-common-lib/utils/macros.hpp"
+
+using namespace common;
+
+bool TemplateSearchUtils::HasAnyResult(ScMemoryContext * context, ScTemplate const & scTemplate)
+{
+  TRACE_SPAN("TemplateSearchUtils::HasAnyResult");
+
+  bool hasResult = false;
+  context->SearchByTemplateInterruptibly(
+      scTemplate,
+      [&hasResult](ScTemplateSearchResultItem const &) -> ScTemplateSearchRequest
+      {
+        hasResult = true;
+        return ScTemplateSearchRequest::STOP;
+      });
+  return hasResult;
+}
+
+bool TemplateSearchUtils::HasAnyResult(
+    ScMemoryContext * context,
+    ScAddr const & templateStructure,
+    std::map<ScAddr, ScAddr, ScAddrLessFunc> const & replacements)
+{
+  return HasAnyResultByStructure(context, templateStructure, replacements);
+}
+
+bool TemplateSearchUtils::HasAnyResult(
+    ScMemoryContext * context,
+    ScAddr const & templateStructure,
+    FlatAddrMap const & replacements)
+{
+  return HasAnyResultByStructure(context, templateStructure, replacements);
+}
+
+template <class TReplacements>
+bool TemplateSearchUtils::HasAnyResultByStructure(
+    ScMemoryContext * context,
+    ScAddr const & templateStructure,
+    TReplacements const & replacements)
+{
+  std::shared_ptr<CompiledTemplate const> const compiledTemplate =
+      CompiledTemplateCache::Get(context, templateStructure);
+
+  ScTemplate scTemplate;
+  compiledTemplate->Build(scTemplate, replacements);
+  return HasAnyResult(context, scTemplate);
+}
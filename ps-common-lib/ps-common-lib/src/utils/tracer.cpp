@@ -0,0 +1,262 @@
+#include "ps-common-lib/utils/tracer.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace common;
+
+namespace
+{
+char const * const TRACE_FILE_PATH_VARIABLE = "PS_COMMON_LIB_TRACE_FILE";
+}  // namespace
+
+size_t const Tracer::RING_BUFFER_CAPACITY = 16384;
+
+// Span of the disabled tracer is not recorded even if the tracer is enabled before the span is finished, so nested
+// spans always have their parents in the trace.
+Tracer::Span::Span(char const * name, char const * category)
+  : name(name)
+  , category(category)
+  , startTime(0)
+  , id(0)
+  , parentId(0)
+  , isRecorded(IsEnabled())
+{
+  if (!isRecorded)
+    return;
+
+  uint64_t & currentSpanId = GetCurrentSpanId();
+  id = GenerateSpanId();
+  parentId = currentSpanId;
+  currentSpanId = id;
+  startTime = GetTime();
+}
+
+Tracer::Span::~Span()
+{
+  if (!isRecorded)
+    return;
+
+  uint64_t const endTime = GetTime();
+  GetCurrentSpanId() = parentId;
+  Record({name, category, startTime, endTime - startTime, id, parentId});
+}
+
+void Tracer::RecordInterval(
+    char const * name,
+    char const * category,
+    std::chrono::steady_clock::time_point const & startTime,
+    std::chrono::steady_clock::time_point const & endTime)
+{
+  if (!IsEnabled())
+    return;
+
+  Record({name, category, ToTime(startTime), ToTime(endTime) - ToTime(startTime), GenerateSpanId(), 0});
+}
+
+void Tracer::SetEnabled(bool isEnabled)
+{
+  isTracingEnabled.store(isEnabled, std::memory_order_relaxed);
+}
+
+bool Tracer::IsEnabled()
+{
+  return isTracingEnabled.load(std::memory_order_relaxed);
+}
+
+// Spans are exported as complete events of Chrome trace format. Spans of running threads are exported first, then the
+// kept spans of finished threads.
+void Tracer::ExportChromeTrace(std::ostream & stream)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  stream << "{\"traceEvents\":[";
+  bool isFirst = true;
+  std::vector<Event> events;
+  for (auto const & ringBuffer : ringBuffers)
+  {
+    events.clear();
+    ReadAll(*ringBuffer, events);
+    for (auto const & event : events)
+      WriteChromeTraceEvent(stream, ringBuffer->threadId, event, isFirst);
+  }
+  for (auto const & [threadId, event] : finishedThreadsEvents)
+    WriteChromeTraceEvent(stream, threadId, event, isFirst);
+  stream << "\n]}\n";
+}
+
+// Tracing is enabled only if the trace file is requested.
+void Tracer::Initialize()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    usersCount++;
+  }
+  SetEnabled(std::getenv(TRACE_FILE_PATH_VARIABLE) != nullptr);
+}
+
+// Spans recorded by the modules that are still running are kept until the last of them is shut down.
+void Tracer::Shutdown()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (usersCount == 0 || --usersCount > 0)
+      return;
+  }
+  ExportToFile();
+}
+
+void Tracer::ExportToFile()
+{
+  if (char const * const traceFilePath = std::getenv(TRACE_FILE_PATH_VARIABLE))
+  {
+    std::ofstream traceFile(traceFilePath);
+    ExportChromeTrace(traceFile);
+  }
+}
+
+// Events are dropped by resetting the counters of the ring buffers, so spans should not be recorded concurrently.
+void Tracer::Clear()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  for (auto const & ringBuffer : ringBuffers)
+  {
+    for (size_t slotIndex = 0; slotIndex < RING_BUFFER_CAPACITY; slotIndex++)
+      ringBuffer->slots[slotIndex].sequence.store(0, std::memory_order_relaxed);
+    ringBuffer->eventsCount.store(0, std::memory_order_release);
+  }
+  finishedThreadsEvents.clear();
+}
+
+uint64_t Tracer::GetTime()
+{
+  return ToTime(std::chrono::steady_clock::now());
+}
+
+uint64_t Tracer::ToTime(std::chrono::steady_clock::time_point const & timePoint)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(timePoint.time_since_epoch()).count();
+}
+
+// Identifiers of spans are unique across threads, the identifier of the thread is kept in their high bits.
+uint64_t Tracer::GenerateSpanId()
+{
+  thread_local uint64_t spansCount = 0;
+  return (uint64_t(GetThreadRingBuffer().threadId) << 40) | ++spansCount;
+}
+
+// Ring buffer is registered once per thread and released when the thread exits.
+Tracer::RingBuffer & Tracer::GetThreadRingBuffer()
+{
+  auto const & registerRingBuffer = []
+  {
+    auto newRingBuffer = std::make_shared<RingBuffer>();
+    newRingBuffer->slots = std::make_unique<Slot[]>(RING_BUFFER_CAPACITY);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    newRingBuffer->threadId = ++threadsCount;
+    ringBuffers.push_back(newRingBuffer);
+    return newRingBuffer;
+  };
+  thread_local RingBufferOwner const owner{registerRingBuffer()};
+  return *owner.ringBuffer;
+}
+
+Tracer::RingBufferOwner::~RingBufferOwner()
+{
+  Release(ringBuffer);
+}
+
+uint64_t & Tracer::GetCurrentSpanId()
+{
+  thread_local uint64_t currentSpanId = 0;
+  return currentSpanId;
+}
+
+// Only the owning thread writes to the ring buffer, the oldest event is overwritten when the buffer is full. The
+// release fence keeps the reset of the sequence before the writes of the fields.
+void Tracer::Record(Event const & event)
+{
+  RingBuffer & ringBuffer = GetThreadRingBuffer();
+  uint64_t const eventIndex = ringBuffer.eventsCount.load(std::memory_order_relaxed);
+  Slot & slot = ringBuffer.slots[eventIndex % RING_BUFFER_CAPACITY];
+  slot.sequence.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.name.store(event.name, std::memory_order_relaxed);
+  slot.category.store(event.category, std::memory_order_relaxed);
+  slot.startTime.store(event.startTime, std::memory_order_relaxed);
+  slot.duration.store(event.duration, std::memory_order_relaxed);
+  slot.id.store(event.id, std::memory_order_relaxed);
+  slot.parentId.store(event.parentId, std::memory_order_relaxed);
+  slot.sequence.store(eventIndex + 1, std::memory_order_release);
+  ringBuffer.eventsCount.store(eventIndex + 1, std::memory_order_release);
+}
+
+// Fields are read between two loads of the sequence, and the acquire fence keeps the reads of the fields before the
+// second load. So the event is discarded if the owning thread started to overwrite it meanwhile.
+bool Tracer::Read(Slot const & slot, uint64_t eventIndex, Event & event)
+{
+  if (slot.sequence.load(std::memory_order_acquire) != eventIndex + 1)
+    return false;
+
+  event.name = slot.name.load(std::memory_order_relaxed);
+  event.category = slot.category.load(std::memory_order_relaxed);
+  event.startTime = slot.startTime.load(std::memory_order_relaxed);
+  event.duration = slot.duration.load(std::memory_order_relaxed);
+  event.id = slot.id.load(std::memory_order_relaxed);
+  event.parentId = slot.parentId.load(std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return slot.sequence.load(std::memory_order_relaxed) == eventIndex + 1;
+}
+
+void Tracer::ReadAll(RingBuffer const & ringBuffer, std::vector<Event> & events)
+{
+  uint64_t const eventsCount = ringBuffer.eventsCount.load(std::memory_order_acquire);
+  uint64_t const firstEvent = eventsCount > RING_BUFFER_CAPACITY ? eventsCount - RING_BUFFER_CAPACITY : 0;
+  for (uint64_t eventIndex = firstEvent; eventIndex < eventsCount; eventIndex++)
+  {
+    Event event;
+    if (Read(ringBuffer.slots[eventIndex % RING_BUFFER_CAPACITY], eventIndex, event))
+      events.push_back(event);
+  }
+}
+
+// Events of the finished thread are moved out of its ring buffer, so the buffer is freed. Only the latest
+// RING_BUFFER_CAPACITY events of all finished threads are kept.
+void Tracer::Release(std::shared_ptr<RingBuffer> const & ringBuffer)
+{
+  std::vector<Event> events;
+  std::lock_guard<std::mutex> lock(mutex);
+  ReadAll(*ringBuffer, events);
+  for (auto const & event : events)
+    finishedThreadsEvents.push_back({ringBuffer->threadId, event});
+  while (finishedThreadsEvents.size() > RING_BUFFER_CAPACITY)
+    finishedThreadsEvents.pop_front();
+  ringBuffers.remove(ringBuffer);
+}
+
+// Timestamps are in microseconds with nanosecond precision. Viewers nest spans of one thread by time, identifiers of
+// spans and their parents are kept in arguments.
+void Tracer::WriteChromeTraceEvent(std::ostream & stream, size_t threadId, Event const & event, bool & isFirst)
+{
+  stream << (isFirst ? "" : ",") << "\n{\"name\":\"" << Escape(event.name) << "\",\"cat\":\"" << Escape(event.category)
+         << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << threadId << ",\"ts\":" << event.startTime / 1000 << "."
+         << std::to_string(1000 + event.startTime % 1000).substr(1) << ",\"dur\":" << event.duration / 1000 << "."
+         << std::to_string(1000 + event.duration % 1000).substr(1) << ",\"args\":{\"id\":" << event.id
+         << ",\"parent\":" << event.parentId << "}}";
+  isFirst = false;
+}
+
+std::string Tracer::Escape(char const * string)
+{
+  std::string escapedString;
+  for (; *string; string++)
+  {
+    if (*string == '"' || *string == '\\')
+      escapedString += '\\';
+    escapedString += *string;
+  }
+  return escapedString;
+}
@@ -0,0 +1,177 @@
+#include <sc-memory/test/sc_test.hpp>
+
+#include "ps-common-lib/keynodes.hpp"
+#include "ps-common-lib/utils/compiled_template_cache.hpp"
+#include "ps-common-lib/utils/flat_addr_map.hpp"
+#include "ps-common-lib/utils/logic_utils.hpp"
+#include "ps-common-lib/utils/template_params_utils.hpp"
+
+using namespace common;
+
+namespace commonTest
+{
+using FlatAddrMapTest = ScMemoryTest;
+
+std::map<ScAddr, ScAddr, ScAddrLessFunc> generateReplacements(ScAgentContext & context, size_t replacementsCount)
+{
+  std::map<ScAddr, ScAddr, ScAddrLessFunc> replacements;
+  for (size_t index = 0; index < replacementsCount; index++)
+    replacements[context.GenerateNode(ScType::VarNode)] = context.GenerateNode(ScType::ConstNode);
+  return replacements;
+}
+
+// Pairs are inserted in reverse order of their keys, so every insertion shifts the stored pairs.
+FlatAddrMap insertReversed(std::map<ScAddr, ScAddr, ScAddrLessFunc> const & replacements)
+{
+  FlatAddrMap flatReplacements;
+  for (auto it = replacements.crbegin(); it != replacements.crend(); ++it)
+    EXPECT_TRUE(flatReplacements.insert(*it).second);
+  return flatReplacements;
+}
+
+void expectEqual(FlatAddrMap const & flatReplacements, std::map<ScAddr, ScAddr, ScAddrLessFunc> const & replacements)
+{
+  EXPECT_EQ(flatReplacements.size(), replacements.size());
+  EXPECT_EQ(flatReplacements.empty(), replacements.empty());
+  EXPECT_EQ(flatReplacements.ToMap(), replacements);
+  for (auto const & [variable, value] : replacements)
+  {
+    EXPECT_EQ(flatReplacements.count(variable), 1u);
+    auto const & it = flatReplacements.find(variable);
+    EXPECT_NE(it, flatReplacements.cend());
+    if (it != flatReplacements.cend())
+    {
+      EXPECT_EQ(it->second, value);
+    }
+  }
+}
+
+TEST_F(FlatAddrMapTest, insertAndFindAcrossSpill)
+{
+  ScAgentContext & context = *m_ctx;
+  std::map<ScAddr, ScAddr, ScAddrLessFunc> replacements;
+  FlatAddrMap flatReplacements;
+  for (auto const & [variable, value] : generateReplacements(context, FlatAddrMap::INLINE_CAPACITY * 2 + 1))
+  {
+    flatReplacements[variable] = value;
+    replacements[variable] = value;
+    expectEqual(flatReplacements, replacements);
+  }
+
+  ScAddr const & missingVariable = context.GenerateNode(ScType::VarNode);
+  EXPECT_EQ(flatReplacements.count(missingVariable), 0u);
+  EXPECT_EQ(flatReplacements.find(missingVariable), flatReplacements.cend());
+
+  auto const & [it, isInserted] = flatReplacements.emplace(replacements.cbegin()->first, missingVariable);
+  EXPECT_FALSE(isInserted);
+  EXPECT_EQ(it->second, replacements.cbegin()->second);
+
+  expectEqual(insertReversed(replacements), replacements);
+  expectEqual(FlatAddrMap(replacements), replacements);
+}
+
+TEST_F(FlatAddrMapTest, eraseAcrossSpill)
+{
+  ScAgentContext & context = *m_ctx;
+  for (size_t replacementsCount : {FlatAddrMap::INLINE_CAPACITY, FlatAddrMap::INLINE_CAPACITY * 2})
+  {
+    std::map<ScAddr, ScAddr, ScAddrLessFunc> replacements = generateReplacements(context, replacementsCount);
+    FlatAddrMap flatReplacements(replacements);
+
+    EXPECT_EQ(flatReplacements.erase(context.GenerateNode(ScType::VarNode)), 0u);
+    for (size_t index = 0; !replacements.empty(); index++)
+    {
+      auto it = replacements.begin();
+      std::advance(it, index % replacements.size());
+      ScAddr const variable = it->first;
+      replacements.erase(it);
+      EXPECT_EQ(flatReplacements.erase(variable), 1u);
+      EXPECT_EQ(flatReplacements.erase(variable), 0u);
+      expectEqual(flatReplacements, replacements);
+    }
+
+    auto const & newReplacements = generateReplacements(context, FlatAddrMap::INLINE_CAPACITY + 1);
+    for (auto const & item : newReplacements)
+      flatReplacements.insert(item);
+    expectEqual(flatReplacements, newReplacements);
+
+    flatReplacements.clear();
+    expectEqual(flatReplacements, {});
+  }
+}
+
+TEST_F(FlatAddrMapTest, copyAndMove)
+{
+  ScAgentContext & context = *m_ctx;
+  for (size_t replacementsCount : {FlatAddrMap::INLINE_CAPACITY, FlatAddrMap::INLINE_CAPACITY + 1})
+  {
+    auto const & replacements = generateReplacements(context, replacementsCount);
+    FlatAddrMap flatReplacements(replacements);
+
+    FlatAddrMap copiedReplacements(flatReplacements);
+    expectEqual(copiedReplacements, replacements);
+    copiedReplacements.erase(replacements.cbegin()->first);
+    expectEqual(flatReplacements, replacements);
+
+    FlatAddrMap assignedReplacements;
+    assignedReplacements = flatReplacements;
+    expectEqual(assignedReplacements, replacements);
+
+    FlatAddrMap movedReplacements(std::move(copiedReplacements));
+    EXPECT_TRUE(copiedReplacements.empty());
+    EXPECT_EQ(movedReplacements.size(), replacements.size() - 1);
+    EXPECT_EQ(movedReplacements.count(replacements.cbegin()->first), 0u);
+
+    FlatAddrMap moveAssignedReplacements;
+    moveAssignedReplacements = std::move(assignedReplacements);
+    EXPECT_TRUE(assignedReplacements.empty());
+    expectEqual(moveAssignedReplacements, replacements);
+
+    assignedReplacements[replacements.cbegin()->first] = replacements.cbegin()->second;
+    EXPECT_EQ(assignedReplacements.size(), 1u);
+  }
+}
+
+TEST_F(FlatAddrMapTest, createTemplateParamsFromFlatReplacements)
+{
+  ScAgentContext & context = *m_ctx;
+  for (size_t replacementsCount : {FlatAddrMap::INLINE_CAPACITY, FlatAddrMap::INLINE_CAPACITY + 1})
+  {
+    auto const & replacements = generateReplacements(context, replacementsCount);
+    ScTemplateParams const & templateParams =
+        TemplateParamsUtils::CreateTemplateParamsFromReplacements(FlatAddrMap(replacements));
+    for (auto const & [variable, value] : replacements)
+    {
+      ScAddr result;
+      EXPECT_TRUE(templateParams.Get(variable, result));
+      EXPECT_EQ(result, value);
+    }
+  }
+}
+
+TEST_F(FlatAddrMapTest, checkLogicalFormulaWithFlatReplacements)
+{
+  ScAgentContext & context = *m_ctx;
+  ScAddr const & set = context.GenerateNode(ScType::ConstNode);
+  ScAddr const & element = context.GenerateNode(ScType::ConstNode);
+  context.GenerateConnector(ScType::ConstPermPosArc, set, element);
+
+  auto replacements = generateReplacements(context, FlatAddrMap::INLINE_CAPACITY);
+  ScAddr const & variable = context.GenerateNode(ScType::VarNode);
+  ScAddr const & formula = context.GenerateNode(ScType::ConstNodeStructure);
+  ScAddr const & arc = context.GenerateConnector(ScType::VarPermPosArc, set, variable);
+  for (auto const & formulaElement : {set, variable, arc})
+    context.GenerateConnector(ScType::ConstPermPosArc, formula, formulaElement);
+  context.GenerateConnector(ScType::ConstPermPosArc, Keynodes::atomic_logical_formula, formula);
+
+  replacements[variable] = element;
+  EXPECT_TRUE(LogicUtils::CheckLogicalFormula(&context, formula, FlatAddrMap(replacements)));
+
+  replacements[variable] = context.GenerateNode(ScType::ConstNode);
+  EXPECT_FALSE(LogicUtils::CheckLogicalFormula(&context, formula, FlatAddrMap(replacements)));
+
+  LogicUtils::ClearFormulaPlans();
+  CompiledTemplateCache::Clear();
+}
+
+}  // namespace commonTest
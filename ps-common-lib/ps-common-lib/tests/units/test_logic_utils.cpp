@@ -0,0 +1,269 @@
+#include <chrono>
+#include <thread>
+
+#include <sc-memory/test/sc_test.hpp>
+
+#include "ps-common-lib/keynodes.hpp"
+#include "ps-common-lib/utils/compiled_template_cache.hpp"
+#include "ps-common-lib/utils/logic_utils.hpp"
+
+using namespace common;
+
+namespace commonTest
+{
+int const WAIT_TIME = 5000;
+
+using LogicUtilsTest = ScMemoryTest;
+
+void clearCaches()
+{
+  LogicUtils::ClearFormulaPlans();
+  CompiledTemplateCache::Clear();
+}
+
+// Atomic logical formula with one triple: the given variable is an element of the given set.
+ScAddr generateMembershipFormula(ScAgentContext & context, ScAddr const & set, ScAddr const & element)
+{
+  ScAddr const & formula = context.GenerateNode(ScType::ConstNodeStructure);
+  ScAddr const & arc = context.GenerateConnector(ScType::VarPermPosArc, set, element);
+  for (auto const & formulaElement : {set, element, arc})
+    context.GenerateConnector(ScType::ConstPermPosArc, formula, formulaElement);
+  context.GenerateConnector(ScType::ConstPermPosArc, Keynodes::atomic_logical_formula, formula);
+  return formula;
+}
+
+ScAddr generateImplication(ScAgentContext & context, ScAddr const & premise, ScAddr const & conclusion)
+{
+  ScAddr const & implication = context.GenerateConnector(ScType::ConstCommonArc, premise, conclusion);
+  context.GenerateConnector(ScType::ConstPermPosArc, Keynodes::nrel_implication, implication);
+  return implication;
+}
+
+ScAddr generateCompoundFormula(ScAgentContext & context, ScAddr const & formulaClass, ScAddrVector const & subFormulas)
+{
+  ScAddr const & formula = context.GenerateNode(ScType::ConstNodeTuple);
+  context.GenerateConnector(ScType::ConstPermPosArc, formulaClass, formula);
+  for (auto const & subFormula : subFormulas)
+    context.GenerateConnector(ScType::ConstPermPosArc, formula, subFormula);
+  return formula;
+}
+
+// Plans of formulas are invalidated by sc-events, so the expected result is awaited.
+bool waitForResult(ScAgentContext & context, ScAddr const & formula, bool expectedResult)
+{
+  std::map<ScAddr, ScAddr, ScAddrLessFunc> const replacements;
+  auto const start = std::chrono::steady_clock::now();
+  while (LogicUtils::CheckLogicalFormula(&context, formula, replacements) != expectedResult)
+  {
+    if (std::chrono::steady_clock::now() - start > std::chrono::milliseconds(WAIT_TIME))
+      return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return true;
+}
+
+TEST_F(LogicUtilsTest, checkConjunctionWithCommonVariable)
+{
+  ScAgentContext & context = *m_ctx;
+  ScAddr const & firstSet = context.GenerateNode(ScType::ConstNode);
+  ScAddr const & secondSet = context.GenerateNode(ScType::ConstNode);
+  ScAddr const & firstElement = context.GenerateNode(ScType::ConstNode);
+  context.GenerateConnector(ScType::ConstPermPosArc, firstSet, firstElement);
+  context.GenerateConnector(ScType::ConstPermPosArc, secondSet, context.GenerateNode(ScType::ConstNode));
+
+  ScAddr const & element = context.GenerateNode(ScType::VarNode);
+  ScAddr const & conjunction = generateCompoundFormula(
+      context,
+      Keynodes::conjunction,
+      {generateMembershipFormula(context, firstSet, element), generateMembershipFormula(context, secondSet, element)});
+
+  std::map<ScAddr, ScAddr, ScAddrLessFunc> replacements;
+  EXPECT_FALSE(LogicUtils::CheckLogicalFormula(&context, conjunction, replacements));
+
+  replacements[element] = firstElement;
+  EXPECT_FALSE(LogicUtils::CheckLogicalFormula(&context, conjunction, replacements));
+
+  context.GenerateConnector(ScType::ConstPermPosArc, secondSet, firstElement);
+  EXPECT_TRUE(LogicUtils::CheckLogicalFormula(&context, conjunction, replacements));
+  EXPECT_TRUE(LogicUtils::CheckLogicalFormula(&context, conjunction, std::map<ScAddr, ScAddr, ScAddrLessFunc>()));
+
+  clearCaches();
+}
+
+TEST_F(LogicUtilsTest, checkConjunctionWithoutCommonVariables)
+{
+  ScAgentContext & context = *m_ctx;
+  ScAddr const & firstSet = context.GenerateNode(ScType::ConstNode);
+  ScAddr const & secondSet = context.GenerateNode(ScType::ConstNode);
+  context.GenerateConnector(ScType::ConstPermPosArc, firstSet, context.GenerateNode(ScType::ConstNode));
+  context.GenerateConnector(ScType::ConstPermPosArc, secondSet, context.GenerateNode(ScType::ConstNode));
+
+  ScAddr const & conjunction = generateCompoundFormula(
+      context,
+      Keynodes::conjunction,
+      {generateMembershipFormula(context, firstSet, context.GenerateNode(ScType::VarNode)),
+       generateMembershipFormula(context, secondSet, context.GenerateNode(ScType::VarNode))});
+
+  EXPECT_TRUE(LogicUtils::CheckLogicalFormula(&context, conjunction, std::map<ScAddr, ScAddr, ScAddrLessFunc>()));
+
+  clearCaches();
+}
+
+TEST_F(LogicUtilsTest, checkDisjunction)
+{
+  ScAgentContext & context = *m_ctx;
+  ScAddr const & set = context.GenerateNode(ScType::ConstNode);
+  ScAddr const & emptySet = context.GenerateNode(ScType::ConstNode);
+  context.GenerateConnector(ScType::ConstPermPosArc, set, context.GenerateNode(ScType::ConstNode));
+
+  ScAddr const & trueDisjunction = generateCompoundFormula(
+      context,
+      Keynodes::disjunction,
+      {generateMembershipFormula(context, emptySet, context.GenerateNode(ScType::VarNode)),
+       generateMembershipFormula(context, set, context.GenerateNode(ScType::VarNode))});
+  ScAddr const & falseDisjunction = generateCompoundFormula(
+      context,
+      Keynodes::disjunction,
+      {generateMembershipFormula(context, emptySet, context.GenerateNode(ScType::VarNode)),
+       generateMembershipFormula(context, emptySet, context.GenerateNode(ScType::VarNode))});
+
+  std::map<ScAddr, ScAddr, ScAddrLessFunc> const replacements;
+  EXPECT_TRUE(LogicUtils::CheckLogicalFormula(&context, trueDisjunction, replacements));
+  EXPECT_FALSE(LogicUtils::CheckLogicalFormula(&context, falseDisjunction, replacements));
+
+  clearCaches();
+}
+
+TEST_F(LogicUtilsTest, checkNegation)
+{
+  ScAgentContext & context = *m_ctx;
+  ScAddr const & set = context.GenerateNode(ScType::ConstNode);
+  ScAddr const & emptySet = context.GenerateNode(ScType::ConstNode);
+  context.GenerateConnector(ScType::ConstPermPosArc, set, context.GenerateNode(ScType::ConstNode));
+
+  ScAddr const & trueNegation = generateCompoundFormula(
+      context, Keynodes::negation, {generateMembershipFormula(context, emptySet, context.GenerateNode(ScType::VarNode))});
+  ScAddr const & falseNegation = generateCompoundFormula(
+      context, Keynodes::negation, {generateMembershipFormula(context, set, context.GenerateNode(ScType::VarNode))});
+
+  std::map<ScAddr, ScAddr, ScAddrLessFunc> const replacements;
+  EXPECT_TRUE(LogicUtils::CheckLogicalFormula(&context, trueNegation, replacements));
+  EXPECT_FALSE(LogicUtils::CheckLogicalFormula(&context, falseNegation, replacements));
+
+  clearCaches();
+}
+
+TEST_F(LogicUtilsTest, checkImplicationWithoutCommonVariables)
+{
+  ScAgentContext & context = *m_ctx;
+  ScAddr const & set = context.GenerateNode(ScType::ConstNode);
+  ScAddr const & emptySet = context.GenerateNode(ScType::ConstNode);
+  context.GenerateConnector(ScType::ConstPermPosArc, set, context.GenerateNode(ScType::ConstNode));
+
+  ScAddr const & falsePremiseImplication = generateImplication(
+      context,
+      generateMembershipFormula(context, emptySet, context.GenerateNode(ScType::VarNode)),
+      generateMembershipFormula(context, emptySet, context.GenerateNode(ScType::VarNode)));
+  ScAddr const & falseConclusionImplication = generateImplication(
+      context,
+      generateMembershipFormula(context, set, context.GenerateNode(ScType::VarNode)),
+      generateMembershipFormula(context, emptySet, context.GenerateNode(ScType::VarNode)));
+  ScAddr const & trueConclusionImplication = generateImplication(
+      context,
+      generateMembershipFormula(context, set, context.GenerateNode(ScType::VarNode)),
+      generateMembershipFormula(context, set, context.GenerateNode(ScType::VarNode)));
+
+  std::map<ScAddr, ScAddr, ScAddrLessFunc> const replacements;
+  EXPECT_TRUE(LogicUtils::CheckLogicalFormula(&context, falsePremiseImplication, replacements));
+  EXPECT_FALSE(LogicUtils::CheckLogicalFormula(&context, falseConclusionImplication, replacements));
+  EXPECT_TRUE(LogicUtils::CheckLogicalFormula(&context, trueConclusionImplication, replacements));
+
+  clearCaches();
+}
+
+TEST_F(LogicUtilsTest, checkImplicationWithCommonVariable)
+{
+  ScAgentContext & context = *m_ctx;
+  ScAddr const & premiseSet = context.GenerateNode(ScType::ConstNode);
+  ScAddr const & conclusionSet = context.GenerateNode(ScType::ConstNode);
+  ScAddr const & firstElement = context.GenerateNode(ScType::ConstNode);
+  ScAddr const & secondElement = context.GenerateNode(ScType::ConstNode);
+  context.GenerateConnector(ScType::ConstPermPosArc, premiseSet, firstElement);
+  context.GenerateConnector(ScType::ConstPermPosArc, premiseSet, secondElement);
+  context.GenerateConnector(ScType::ConstPermPosArc, conclusionSet, firstElement);
+
+  ScAddr const & element = context.GenerateNode(ScType::VarNode);
+  ScAddr const & implication = generateImplication(
+      context,
+      generateMembershipFormula(context, premiseSet, element),
+      generateMembershipFormula(context, conclusionSet, element));
+
+  std::map<ScAddr, ScAddr, ScAddrLessFunc> replacements;
+  EXPECT_FALSE(LogicUtils::CheckLogicalFormula(&context, implication, replacements));
+
+  replacements[element] = firstElement;
+  EXPECT_TRUE(LogicUtils::CheckLogicalFormula(&context, implication, replacements));
+
+  replacements[element] = secondElement;
+  EXPECT_FALSE(LogicUtils::CheckLogicalFormula(&context, implication, FlatAddrMap(replacements)));
+
+  context.GenerateConnector(ScType::ConstPermPosArc, conclusionSet, secondElement);
+  EXPECT_TRUE(LogicUtils::CheckLogicalFormula(&context, implication, std::map<ScAddr, ScAddr, ScAddrLessFunc>()));
+  EXPECT_TRUE(LogicUtils::CheckLogicalFormula(&context, implication, FlatAddrMap()));
+
+  clearCaches();
+}
+
+TEST_F(LogicUtilsTest, checkImplicationWithCompoundPremiseAndCommonVariable)
+{
+  ScAgentContext & context = *m_ctx;
+  ScAddr const & set = context.GenerateNode(ScType::ConstNode);
+  ScAddr const & firstElement = context.GenerateNode(ScType::ConstNode);
+  context.GenerateConnector(ScType::ConstPermPosArc, set, firstElement);
+
+  ScAddr const & element = context.GenerateNode(ScType::VarNode);
+  ScAddr const & implication = generateImplication(
+      context,
+      generateCompoundFormula(context, Keynodes::disjunction, {generateMembershipFormula(context, set, element)}),
+      generateMembershipFormula(context, set, element));
+
+  std::map<ScAddr, ScAddr, ScAddrLessFunc> replacements;
+  EXPECT_THROW(LogicUtils::CheckLogicalFormula(&context, implication, replacements), utils::ExceptionNotImplemented);
+
+  replacements[element] = firstElement;
+  EXPECT_TRUE(LogicUtils::CheckLogicalFormula(&context, implication, replacements));
+
+  clearCaches();
+}
+
+TEST_F(LogicUtilsTest, checkFormulaPlanInvalidation)
+{
+  ScAgentContext & context = *m_ctx;
+  ScAddr const & set = context.GenerateNode(ScType::ConstNode);
+  ScAddr const & emptySet = context.GenerateNode(ScType::ConstNode);
+  context.GenerateConnector(ScType::ConstPermPosArc, set, context.GenerateNode(ScType::ConstNode));
+
+  ScAddr const & conjunction = generateCompoundFormula(
+      context, Keynodes::conjunction, {generateMembershipFormula(context, set, context.GenerateNode(ScType::VarNode))});
+  LogicUtils::PrepareLogicalFormula(&context, conjunction);
+  EXPECT_TRUE(waitForResult(context, conjunction, true));
+
+  ScAddr const & falseFormula = generateMembershipFormula(context, emptySet, context.GenerateNode(ScType::VarNode));
+  ScAddr const & falseFormulaArc = context.GenerateConnector(ScType::ConstPermPosArc, conjunction, falseFormula);
+  EXPECT_TRUE(waitForResult(context, conjunction, false));
+
+  context.EraseElement(falseFormulaArc);
+  EXPECT_TRUE(waitForResult(context, conjunction, true));
+
+  context.GenerateConnector(ScType::ConstPermPosArc, Keynodes::negation, conjunction);
+  ScIterator3Ptr classesIterator3 =
+      context.CreateIterator3(Keynodes::conjunction, ScType::ConstPermPosArc, conjunction);
+  EXPECT_TRUE(classesIterator3->Next());
+  context.EraseElement(classesIterator3->Get(1));
+  EXPECT_TRUE(waitForResult(context, conjunction, false));
+
+  classesIterator3.reset();
+  clearCaches();
+}
+
+}  // namespace commonTest
@@ -0,0 +1,148 @@
+#include <sc-memory/test/sc_test.hpp>
+
+#include "ps-common-lib/utils/relation_utils.hpp"
+
+using namespace common;
+
+namespace commonTest
+{
+using RelationUtilsTest = ScMemoryTest;
+
+ScAddrVector generateNodes(ScAgentContext & context, size_t nodesCount)
+{
+  ScAddrVector nodes;
+  for (size_t index = 0; index < nodesCount; index++)
+    nodes.push_back(context.GenerateNode(ScType::ConstNode));
+  return nodes;
+}
+
+void generateOutgoingArcs(ScAgentContext & context, ScAddr const & node, ScAddrVector const & elements)
+{
+  for (auto const & element : elements)
+    context.GenerateConnector(ScType::ConstPermPosArc, node, element);
+}
+
+void generateIncomingArcs(ScAgentContext & context, ScAddr const & node, ScAddrVector const & elements)
+{
+  for (auto const & element : elements)
+    context.GenerateConnector(ScType::ConstPermPosArc, element, node);
+}
+
+// Counts of checked elements and incident connectors of the node select each of the check strategies: searches of
+// connectors of each element for short vectors and for nodes with many incident connectors, and the scan otherwise.
+struct CheckCase
+{
+  size_t checksCount;
+  size_t otherConnectorsCount;
+};
+
+std::vector<CheckCase> const CHECK_CASES = {
+    {RelationUtils::BULK_CHECK_MIN_SIZE - 1, 0},
+    {RelationUtils::BULK_CHECK_MIN_SIZE * 2, 0},
+    {RelationUtils::BULK_CHECK_MIN_SIZE * 2,
+     RelationUtils::BULK_CHECK_MIN_SIZE * 2 * RelationUtils::BULK_CHECK_DEGREE_RATIO}};
+
+TEST_F(RelationUtilsTest, checkAllConnectors)
+{
+  ScAgentContext & context = *m_ctx;
+  for (auto const & [checksCount, otherConnectorsCount] : CHECK_CASES)
+  {
+    ScAddr const & node = context.GenerateNode(ScType::ConstNode);
+    ScAddrVector const & elements = generateNodes(context, checksCount);
+    ScAddrVector const & otherElements = generateNodes(context, otherConnectorsCount);
+    generateOutgoingArcs(context, node, elements);
+    generateOutgoingArcs(context, node, otherElements);
+    generateIncomingArcs(context, node, elements);
+    generateIncomingArcs(context, node, otherElements);
+
+    EXPECT_TRUE(RelationUtils::CheckAllOutgoingConnectors(&context, node, ScType::ConstPermPosArc, elements));
+    EXPECT_TRUE(RelationUtils::CheckAllIncomingConnectors(&context, node, ScType::ConstPermPosArc, elements));
+    EXPECT_TRUE(RelationUtils::GetMissingOutgoingConnectors(&context, node, ScType::ConstPermPosArc, elements).empty());
+    EXPECT_TRUE(RelationUtils::GetMissingIncomingConnectors(&context, node, ScType::ConstPermPosArc, elements).empty());
+    EXPECT_FALSE(RelationUtils::CheckAllOutgoingConnectors(&context, node, ScType::ConstTempPosArc, elements));
+  }
+}
+
+TEST_F(RelationUtilsTest, getMissingConnectors)
+{
+  ScAgentContext & context = *m_ctx;
+  for (auto const & [checksCount, otherConnectorsCount] : CHECK_CASES)
+  {
+    ScAddr const & node = context.GenerateNode(ScType::ConstNode);
+    ScAddrVector elements = generateNodes(context, checksCount);
+    generateOutgoingArcs(context, node, elements);
+    generateIncomingArcs(context, node, elements);
+    generateOutgoingArcs(context, node, generateNodes(context, otherConnectorsCount));
+    generateIncomingArcs(context, node, generateNodes(context, otherConnectorsCount));
+
+    ScAddr const & firstMissingElement = context.GenerateNode(ScType::ConstNode);
+    ScAddr const & secondMissingElement = context.GenerateNode(ScType::ConstNode);
+    elements.insert(elements.begin() + 1, firstMissingElement);
+    elements.push_back(secondMissingElement);
+
+    EXPECT_FALSE(RelationUtils::CheckAllOutgoingConnectors(&context, node, ScType::ConstPermPosArc, elements));
+    EXPECT_FALSE(RelationUtils::CheckAllIncomingConnectors(&context, node, ScType::ConstPermPosArc, elements));
+    ScAddrVector const expectedMissingElements = {firstMissingElement, secondMissingElement};
+    EXPECT_EQ(
+        RelationUtils::GetMissingOutgoingConnectors(&context, node, ScType::ConstPermPosArc, elements),
+        expectedMissingElements);
+    EXPECT_EQ(
+        RelationUtils::GetMissingIncomingConnectors(&context, node, ScType::ConstPermPosArc, elements),
+        expectedMissingElements);
+  }
+}
+
+TEST_F(RelationUtilsTest, eraseConnectors)
+{
+  ScAgentContext & context = *m_ctx;
+  for (auto const & [checksCount, otherConnectorsCount] : CHECK_CASES)
+  {
+    ScAddr const & node = context.GenerateNode(ScType::ConstNode);
+    ScAddrVector const & elements = generateNodes(context, checksCount);
+    ScAddrVector const & otherElements = generateNodes(context, otherConnectorsCount);
+    generateOutgoingArcs(context, node, elements);
+    generateOutgoingArcs(context, node, otherElements);
+    generateIncomingArcs(context, node, elements);
+    generateIncomingArcs(context, node, otherElements);
+
+    RelationUtils::EraseAllOutgoingConnectors(&context, node, ScType::ConstPermPosArc, elements);
+    EXPECT_EQ(context.GetElementEdgesAndOutgoingArcsCount(node), otherConnectorsCount);
+    EXPECT_TRUE(RelationUtils::CheckAllOutgoingConnectors(&context, node, ScType::ConstPermPosArc, otherElements));
+
+    RelationUtils::EraseAllIncomingConnectors(&context, node, ScType::ConstPermPosArc, elements);
+    EXPECT_EQ(context.GetElementEdgesAndIncomingArcsCount(node), otherConnectorsCount);
+    EXPECT_TRUE(RelationUtils::CheckAllIncomingConnectors(&context, node, ScType::ConstPermPosArc, otherElements));
+  }
+}
+
+// Connectors are erased in several batches, the last of them is incomplete.
+TEST_F(RelationUtilsTest, eraseConnectorsInBatches)
+{
+  ScAgentContext & context = *m_ctx;
+  ScAddr const & node = context.GenerateNode(ScType::ConstNode);
+  ScAddrVector const & elements = generateNodes(context, RelationUtils::ERASE_BATCH_SIZE * 2 + 1);
+  generateOutgoingArcs(context, node, elements);
+  generateIncomingArcs(context, node, elements);
+
+  RelationUtils::EraseAllOutgoingConnectors(&context, node, ScType::ConstPermPosArc, elements);
+  EXPECT_EQ(context.GetElementEdgesAndOutgoingArcsCount(node), 0u);
+
+  RelationUtils::EraseAllIncomingConnectors(&context, node, ScType::ConstPermPosArc, elements);
+  EXPECT_EQ(context.GetElementEdgesAndIncomingArcsCount(node), 0u);
+}
+
+TEST_F(RelationUtilsTest, eraseAllConnectorsBetween)
+{
+  ScAgentContext & context = *m_ctx;
+  ScAddr const & source = context.GenerateNode(ScType::ConstNode);
+  ScAddr const & target = context.GenerateNode(ScType::ConstNode);
+  for (size_t index = 0; index < RelationUtils::ERASE_BATCH_SIZE + 1; index++)
+    context.GenerateConnector(ScType::ConstPermPosArc, source, target);
+  context.GenerateConnector(ScType::ConstTempPosArc, source, target);
+
+  RelationUtils::EraseAllConnectors(&context, source, target, ScType::ConstPermPosArc);
+  EXPECT_FALSE(context.CheckConnector(source, target, ScType::ConstPermPosArc));
+  EXPECT_TRUE(context.CheckConnector(source, target, ScType::ConstTempPosArc));
+}
+
+}  // namespace commonTest
@@ -0,0 +1,108 @@
+#include <chrono>
+#include <thread>
+
+#include <sc-memory/test/sc_test.hpp>
+
+#include "ps-common-lib/utils/template_params_utils.hpp"
+
+using namespace common;
+
+namespace commonTest
+{
+using TemplateParamsUtilsTest = ScMemoryTest;
+
+ScAddr generateStructure(ScAgentContext & context, ScAddrVector const & elements)
+{
+  ScAddr const & structure = context.GenerateNode(ScType::ConstNodeStructure);
+  for (auto const & element : elements)
+    context.GenerateConnector(ScType::ConstPermPosArc, structure, element);
+  return structure;
+}
+
+TEST_F(TemplateParamsUtilsTest, createTemplateParamsForStructure)
+{
+  ScAgentContext & context = *m_ctx;
+  ScAddr const & set = context.GenerateNode(ScType::ConstNode);
+  ScAddr const & variable = context.GenerateNode(ScType::VarNode);
+  ScAddr const & otherVariable = context.GenerateNode(ScType::VarNode);
+  ScAddr const & structure =
+      generateStructure(context, {set, variable, context.GenerateConnector(ScType::VarPermPosArc, set, variable)});
+
+  ScAddr const & value = context.GenerateNode(ScType::ConstNode);
+  std::map<ScAddr, ScAddr, ScAddrLessFunc> const replacements = {
+      {variable, value}, {otherVariable, context.GenerateNode(ScType::ConstNode)}};
+  FlatAddrMap flatReplacements;
+  for (auto const & [replacedVariable, replacement] : replacements)
+    flatReplacements[replacedVariable] = replacement;
+
+  for (ScTemplateParams const & templateParams :
+       {TemplateParamsUtils::CreateTemplateParamsFromReplacements(&context, replacements, structure),
+        TemplateParamsUtils::CreateTemplateParamsFromReplacements(&context, flatReplacements, structure)})
+  {
+    ScAddr result;
+    EXPECT_TRUE(templateParams.Get(variable, result));
+    EXPECT_EQ(result, value);
+    EXPECT_FALSE(templateParams.Get(otherVariable, result));
+  }
+
+  TemplateParamsUtils::ClearStructureVariables();
+}
+
+// Variables are collected without compiling the structure as a template, so its connectors may form cycles.
+TEST_F(TemplateParamsUtilsTest, createTemplateParamsForCyclicStructure)
+{
+  ScAgentContext & context = *m_ctx;
+  ScAddr const & firstVariable = context.GenerateNode(ScType::VarNode);
+  ScAddr const & secondVariable = context.GenerateNode(ScType::VarNode);
+  ScAddr const & forwardArc = context.GenerateConnector(ScType::VarPermPosArc, firstVariable, secondVariable);
+  ScAddr const & backwardArc = context.GenerateConnector(ScType::VarPermPosArc, secondVariable, firstVariable);
+  ScAddr const & structure = generateStructure(
+      context,
+      {firstVariable,
+       secondVariable,
+       forwardArc,
+       backwardArc,
+       context.GenerateConnector(ScType::VarPermPosArc, forwardArc, backwardArc)});
+
+  ScAddr const & firstValue = context.GenerateNode(ScType::ConstNode);
+  ScAddr const & secondValue = context.GenerateNode(ScType::ConstNode);
+  ScTemplateParams const & templateParams = TemplateParamsUtils::CreateTemplateParamsFromReplacements(
+      &context,
+      std::map<ScAddr, ScAddr, ScAddrLessFunc>{{firstVariable, firstValue}, {secondVariable, secondValue}},
+      structure);
+
+  ScAddr result;
+  EXPECT_TRUE(templateParams.Get(firstVariable, result));
+  EXPECT_EQ(result, firstValue);
+  EXPECT_TRUE(templateParams.Get(secondVariable, result));
+  EXPECT_EQ(result, secondValue);
+
+  TemplateParamsUtils::ClearStructureVariables();
+}
+
+// Variables of the structure are invalidated by sc-events, so the added variable is awaited.
+TEST_F(TemplateParamsUtilsTest, createTemplateParamsForChangedStructure)
+{
+  ScAgentContext & context = *m_ctx;
+  ScAddr const & variable = context.GenerateNode(ScType::VarNode);
+  ScAddr const & addedVariable = context.GenerateNode(ScType::VarNode);
+  ScAddr const & structure = generateStructure(context, {variable});
+
+  std::map<ScAddr, ScAddr, ScAddrLessFunc> const replacements = {
+      {variable, context.GenerateNode(ScType::ConstNode)}, {addedVariable, context.GenerateNode(ScType::ConstNode)}};
+  ScAddr result;
+  EXPECT_FALSE(TemplateParamsUtils::CreateTemplateParamsFromReplacements(&context, replacements, structure)
+                   .Get(addedVariable, result));
+
+  context.GenerateConnector(ScType::ConstPermPosArc, structure, addedVariable);
+  auto const start = std::chrono::steady_clock::now();
+  while (!TemplateParamsUtils::CreateTemplateParamsFromReplacements(&context, replacements, structure)
+              .Get(addedVariable, result)
+         && std::chrono::steady_clock::now() - start < std::chrono::milliseconds(5000))
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(result, replacements.at(addedVariable));
+
+  TemplateParamsUtils::ClearStructureVariables();
+}
+
+}  // namespace commonTest
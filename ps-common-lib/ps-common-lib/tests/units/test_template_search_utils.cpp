@@ -0,0 +1,84 @@
+#include <sc-memory/test/sc_test.hpp>
+
+#include "ps-common-lib/utils/compiled_template_cache.hpp"
+#include "ps-common-lib/utils/template_search_utils.hpp"
+
+using namespace common;
+
+namespace commonTest
+{
+using TemplateSearchUtilsTest = ScMemoryTest;
+
+// Template structure with one triple: the given variable is an element of the given set.
+ScAddr generateMembershipTemplate(ScAgentContext & context, ScAddr const & set, ScAddr const & element)
+{
+  ScAddr const & templateStructure = context.GenerateNode(ScType::ConstNodeStructure);
+  ScAddr const & arc = context.GenerateConnector(ScType::VarPermPosArc, set, element);
+  for (auto const & templateElement : {set, element, arc})
+    context.GenerateConnector(ScType::ConstPermPosArc, templateStructure, templateElement);
+  return templateStructure;
+}
+
+TEST_F(TemplateSearchUtilsTest, hasAnyResultOnFirstMatch)
+{
+  ScAgentContext & context = *m_ctx;
+  ScAddr const & set = context.GenerateNode(ScType::ConstNode);
+  for (size_t elementIndex = 0; elementIndex < 3; elementIndex++)
+    context.GenerateConnector(ScType::ConstPermPosArc, set, context.GenerateNode(ScType::ConstNode));
+
+  ScTemplate scTemplate;
+  scTemplate.Triple(set, ScType::VarPermPosArc, ScType::VarNode);
+  EXPECT_TRUE(TemplateSearchUtils::HasAnyResult(&context, scTemplate));
+
+  ScAddr const & templateStructure = generateMembershipTemplate(context, set, context.GenerateNode(ScType::VarNode));
+  EXPECT_TRUE(
+      TemplateSearchUtils::HasAnyResult(&context, templateStructure, std::map<ScAddr, ScAddr, ScAddrLessFunc>()));
+  EXPECT_TRUE(TemplateSearchUtils::HasAnyResult(&context, templateStructure, FlatAddrMap()));
+
+  CompiledTemplateCache::Clear();
+}
+
+TEST_F(TemplateSearchUtilsTest, hasNoResultWithoutMatches)
+{
+  ScAgentContext & context = *m_ctx;
+  ScAddr const & emptySet = context.GenerateNode(ScType::ConstNode);
+
+  ScTemplate scTemplate;
+  scTemplate.Triple(emptySet, ScType::VarPermPosArc, ScType::VarNode);
+  EXPECT_FALSE(TemplateSearchUtils::HasAnyResult(&context, scTemplate));
+
+  ScAddr const & templateStructure =
+      generateMembershipTemplate(context, emptySet, context.GenerateNode(ScType::VarNode));
+  EXPECT_FALSE(
+      TemplateSearchUtils::HasAnyResult(&context, templateStructure, std::map<ScAddr, ScAddr, ScAddrLessFunc>()));
+  EXPECT_FALSE(TemplateSearchUtils::HasAnyResult(&context, templateStructure, FlatAddrMap()));
+
+  CompiledTemplateCache::Clear();
+}
+
+TEST_F(TemplateSearchUtilsTest, hasAnyResultWithReplacements)
+{
+  ScAgentContext & context = *m_ctx;
+  ScAddr const & set = context.GenerateNode(ScType::ConstNode);
+  ScAddr const & element = context.GenerateNode(ScType::ConstNode);
+  ScAddr const & otherElement = context.GenerateNode(ScType::ConstNode);
+  context.GenerateConnector(ScType::ConstPermPosArc, set, element);
+
+  ScAddr const & elementVariable = context.GenerateNode(ScType::VarNode);
+  ScAddr const & templateStructure = generateMembershipTemplate(context, set, elementVariable);
+
+  std::map<ScAddr, ScAddr, ScAddrLessFunc> replacements = {{elementVariable, element}};
+  FlatAddrMap flatReplacements;
+  flatReplacements[elementVariable] = element;
+  EXPECT_TRUE(TemplateSearchUtils::HasAnyResult(&context, templateStructure, replacements));
+  EXPECT_TRUE(TemplateSearchUtils::HasAnyResult(&context, templateStructure, flatReplacements));
+
+  replacements[elementVariable] = otherElement;
+  flatReplacements[elementVariable] = otherElement;
+  EXPECT_FALSE(TemplateSearchUtils::HasAnyResult(&context, templateStructure, replacements));
+  EXPECT_FALSE(TemplateSearchUtils::HasAnyResult(&context, templateStructure, flatReplacements));
+
+  CompiledTemplateCache::Clear();
+}
+
+}  // namespace commonTest
@@ -0,0 +1,102 @@
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <sc-memory/test/sc_test.hpp>
+
+#include "ps-common-lib/utils/tracer.hpp"
+
+using namespace common;
+
+namespace commonTest
+{
+
+// Ring buffer of the thread is released when the thread exits, its latest spans are still exported.
+TEST(TracerTest, exportSpansOfFinishedThread)
+{
+  Tracer::Clear();
+  Tracer::SetEnabled(true);
+  std::thread thread(
+      []
+      {
+        Tracer::Span span("finished_thread_span", "test");
+        Tracer::Span nestedSpan("finished_thread_nested_span", "test");
+      });
+  thread.join();
+  {
+    Tracer::Span span("current_thread_span", "test");
+  }
+  Tracer::SetEnabled(false);
+
+  std::stringstream trace;
+  Tracer::ExportChromeTrace(trace);
+  std::string const & traceString = trace.str();
+  EXPECT_NE(traceString.find("\"name\":\"finished_thread_span\""), std::string::npos);
+  EXPECT_NE(traceString.find("\"name\":\"finished_thread_nested_span\""), std::string::npos);
+  EXPECT_NE(traceString.find("\"name\":\"current_thread_span\""), std::string::npos);
+
+  Tracer::Clear();
+}
+
+// Spans are exported while another thread keeps overwriting its ring buffer, exported spans are never torn.
+TEST(TracerTest, exportSpansWhileRecording)
+{
+  Tracer::Clear();
+  Tracer::SetEnabled(true);
+  std::atomic_bool isRecording{true};
+  std::thread thread(
+      [&isRecording]
+      {
+        while (isRecording)
+          Tracer::Span span("recorded_span", "test");
+      });
+
+  for (size_t exportIndex = 0; exportIndex < 10; exportIndex++)
+  {
+    std::stringstream trace;
+    Tracer::ExportChromeTrace(trace);
+    std::string const & traceString = trace.str();
+    for (size_t position = traceString.find("\"name\":"); position != std::string::npos;
+         position = traceString.find("\"name\":", position + 1))
+      EXPECT_EQ(traceString.compare(position, 22, "\"name\":\"recorded_span\""), 0);
+  }
+
+  isRecording = false;
+  thread.join();
+  Tracer::SetEnabled(false);
+  Tracer::Clear();
+}
+
+// Tracer initialized by several modules is exported only when the last of them is shut down.
+TEST(TracerTest, exportOnceByLastUser)
+{
+  std::string const traceFilePath = "tracer_test_trace.json";
+  std::remove(traceFilePath.c_str());
+  setenv("PS_COMMON_LIB_TRACE_FILE", traceFilePath.c_str(), 1);
+  Tracer::Clear();
+  Tracer::Initialize();
+  Tracer::Initialize();
+  EXPECT_TRUE(Tracer::IsEnabled());
+
+  Tracer::Shutdown();
+  EXPECT_FALSE(std::ifstream(traceFilePath).good());
+  {
+    Tracer::Span span("span_after_first_shutdown", "test");
+  }
+
+  Tracer::Shutdown();
+  std::ifstream traceFile(traceFilePath);
+  EXPECT_TRUE(traceFile.good());
+  std::stringstream trace;
+  trace << traceFile.rdbuf();
+  EXPECT_NE(trace.str().find("\"name\":\"span_after_first_shutdown\""), std::string::npos);
+
+  unsetenv("PS_COMMON_LIB_TRACE_FILE");
+  std::remove(traceFilePath.c_str());
+  Tracer::SetEnabled(false);
+  Tracer::Clear();
+}
+
+}  // namespace commonTest